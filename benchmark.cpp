@@ -0,0 +1,212 @@
+#include "benchmark.h"
+#include "bin.h"
+#include "geomtables.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const struct {
+    const char* name;
+    float zoom;
+} zoomLevels[] = {
+    {"near", 0.1f},
+    {"mid", 0.4f},
+    {"far", 1.0f},
+};
+
+std::vector<BenchmarkScenario> benchmarkScenarios(const std::vector<int>& sizes, int frames) {
+    std::vector<BenchmarkScenario> scenarios;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        for (size_t z = 0; z < sizeof(zoomLevels) / sizeof(zoomLevels[0]); z++) {
+            char name[64];
+            snprintf(name, sizeof(name), "orbit_%s_%d", zoomLevels[z].name, sizes[i]);
+            BenchmarkScenario scenario;
+            scenario.name = name;
+            scenario.bins = sizes[i];
+            scenario.zoom = zoomLevels[z].zoom;
+            scenario.frames = frames;
+            scenarios.push_back(scenario);
+        }
+    }
+    return scenarios;
+}
+
+bool parseBenchmarkSizes(const char* text, std::vector<int>* sizes) {
+    sizes->clear();
+    const char* p = text;
+    while (*p) {
+        char* end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value < 1) return false;
+        sizes->push_back((int)value);
+        p = end;
+        if (*p == ',') p++;
+        else if (*p) return false;
+    }
+    return !sizes->empty();
+}
+
+void benchmarkPose(const BenchmarkScenario& scenario, int frame, float maxDistance, CameraPose* pose) {
+    pose->yaw = 360.0f * frame / scenario.frames;
+    pose->pitch = BENCHMARK_PITCH;
+    pose->distance = maxDistance * scenario.zoom;
+    if (pose->distance < 15.0f) pose->distance = 15.0f; // Keep a single bin in frame
+    pose->output.clear();
+}
+
+// Nearest-rank percentile of sorted values
+static double sortedPercentile(const std::vector<double>& sorted, double fraction) {
+    size_t rank = (size_t)ceil(fraction * sorted.size());
+    if (rank > 0) rank--;
+    return sorted[rank];
+}
+
+BenchmarkResult summarizeBenchmark(const BenchmarkScenario& scenario, const std::vector<BenchmarkFrame>& frames) {
+    BenchmarkResult result;
+    result.scenario = scenario;
+    result.meanMs = result.p50Ms = result.p99Ms = result.maxMs = 0.0;
+    result.drawCalls = result.vertices = result.binsDrawn = 0.0;
+    if (frames.empty()) return result;
+
+    std::vector<double> times(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        times[i] = frames[i].ms;
+        result.meanMs += frames[i].ms;
+        result.drawCalls += frames[i].drawCalls;
+        result.vertices += frames[i].vertices;
+        result.binsDrawn += frames[i].binsDrawn;
+    }
+    std::sort(times.begin(), times.end());
+    double count = (double)frames.size();
+    result.meanMs /= count;
+    result.drawCalls /= count;
+    result.vertices /= count;
+    result.binsDrawn /= count;
+    result.p50Ms = sortedPercentile(times, 0.50);
+    result.p99Ms = sortedPercentile(times, 0.99);
+    result.maxMs = times.back();
+    return result;
+}
+
+void printBenchmarkResults(const std::vector<BenchmarkResult>& results) {
+    printf("%-22s %8s %9s %9s %9s %9s %10s %12s\n", "scenario", "bins", "mean ms", "p50 ms", "p99 ms", "max ms",
+           "draws", "vertices");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        printf("%-22s %8d %9.3f %9.3f %9.3f %9.3f %10.1f %12.0f\n", r.scenario.name.c_str(), r.scenario.bins,
+               r.meanMs, r.p50Ms, r.p99Ms, r.maxMs, r.drawCalls, r.vertices);
+    }
+}
+
+bool writeBenchmarkJson(const char* path, const std::vector<BenchmarkResult>& results, const char* renderer,
+                        const char* configuration, int width, int height) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Cannot write %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"renderer\": \"%s\",\n", renderer);
+    fprintf(file, "  \"configuration\": \"%s\",\n", configuration);
+    fprintf(file, "  \"resolution\": [%d, %d],\n", width, height);
+    fprintf(file, "  \"scenarios\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        fprintf(file,
+                "    {\"name\": \"%s\", \"bins\": %d, \"zoom\": %.2f, \"frames\": %d, "
+                "\"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f, "
+                "\"draw_calls\": %.1f, \"vertices\": %.0f, \"bins_drawn\": %.1f}%s\n",
+                r.scenario.name.c_str(), r.scenario.bins, r.scenario.zoom, r.scenario.frames, r.meanMs, r.p50Ms,
+                r.p99Ms, r.maxMs, r.drawCalls, r.vertices, r.binsDrawn, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    if (fclose(file) != 0) return false;
+    printf("Benchmark results written to %s\n", path);
+    return true;
+}
+
+// Vertex coordinates one full-detail bin's curved details produce, computed the way the draw functions used to
+static float binDetailsWithTrig(float* out) {
+    float* p = out;
+    for (int lid = 0; lid < BIN_COMPARTMENT_COUNT; lid++) {
+        // Surface quads, then the highlight loop
+        for (int i = 0; i < LID_SEGMENTS; i++) {
+            *p++ = sinf((float)i / LID_SEGMENTS * (float)TABLE_PI) * LID_CURVE;
+            *p++ = sinf((float)(i + 1) / LID_SEGMENTS * (float)TABLE_PI) * LID_CURVE;
+        }
+        for (int i = 0; i <= LID_SEGMENTS; i++) *p++ = sinf((float)i / LID_SEGMENTS * (float)TABLE_PI) * LID_CURVE;
+        for (int i = LID_SEGMENTS; i >= 0; i--) *p++ = sinf((float)i / LID_SEGMENTS * (float)TABLE_PI) * LID_CURVE;
+    }
+    for (int i = 0; i <= LEAF_SEGMENTS; i++) {
+        float angle = (float)TABLE_PI * i / LEAF_SEGMENTS;
+        *p++ = sinf(angle) * 0.4f;
+        *p++ = -cosf(angle) * 0.8f;
+    }
+    for (int i = 1; i <= LEAF_VEINS; i++) *p++ = sinf(i * (float)TABLE_PI / 10) * 0.35f;
+    for (int i = 0; i < RECYCLE_ARROWS; i++) {
+        // What geomRotatef() and geomTranslatef() did per arrow
+        float angle = i * 2.0f * (float)TABLE_PI / RECYCLE_ARROWS;
+        float c = cosf(angle), s = sinf(angle);
+        static const float local[RECYCLE_ARROW_VERTICES][2] = {
+            {0.0f, 0.3f}, {-0.15f, 0.0f}, {0.15f, 0.0f}, {-0.06f, 0.0f}, {0.06f, 0.0f}, {0.06f, -0.45f}, {-0.06f, -0.45f}};
+        for (int k = 0; k < RECYCLE_ARROW_VERTICES; k++) {
+            *p++ = c * local[k][0] - s * (local[k][1] + 0.2f);
+            *p++ = s * local[k][0] + c * (local[k][1] + 0.2f);
+        }
+    }
+    return (float)(p - out);
+}
+
+// The same coordinates read from the tables
+static float binDetailsFromTables(float* out) {
+    float* p = out;
+    const float* profile = lidProfile(LID_SEGMENTS);
+    for (int lid = 0; lid < BIN_COMPARTMENT_COUNT; lid++) {
+        for (int i = 0; i < LID_SEGMENTS; i++) {
+            *p++ = profile[i];
+            *p++ = profile[i + 1];
+        }
+        for (int i = 0; i <= LID_SEGMENTS; i++) *p++ = profile[i];
+        for (int i = LID_SEGMENTS; i >= 0; i--) *p++ = profile[i];
+    }
+    const float* outlineX = leafOutlineX(LEAF_SEGMENTS);
+    const float* outlineY = leafOutlineY(LEAF_SEGMENTS);
+    for (int i = 0; i <= LEAF_SEGMENTS; i++) {
+        *p++ = outlineX[i];
+        *p++ = outlineY[i];
+    }
+    for (int i = 0; i < LEAF_VEINS; i++) *p++ = LeafVeins<LEAF_VEINS>::width[i];
+    for (int i = 0; i < RECYCLE_ARROWS * RECYCLE_ARROW_VERTICES; i++) {
+        *p++ = RecycleArrows<RECYCLE_ARROWS>::x[i];
+        *p++ = RecycleArrows<RECYCLE_ARROWS>::y[i];
+    }
+    return (float)(p - out);
+}
+
+void benchmarkGeometryTables(int bins) {
+    std::vector<float> trig(1024), table(1024);
+    float count = binDetailsWithTrig(&trig[0]);
+    binDetailsFromTables(&table[0]);
+    float maxError = 0.0f;
+    for (int i = 0; i < (int)count; i++) maxError = std::max(maxError, fabsf(trig[i] - table[i]));
+
+    // Sum the outputs so the loops cannot be optimized away
+    volatile float sink = 0.0f;
+    double ns[2];
+    for (int variant = 0; variant < 2; variant++) {
+        std::vector<float>& out = variant == 0 ? trig : table;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int bin = 0; bin < bins; bin++) {
+            sink = sink + (variant == 0 ? binDetailsWithTrig(&out[0]) : binDetailsFromTables(&out[0])) + out[bin % 64];
+        }
+        ns[variant] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / bins;
+    }
+
+    printf("Geometry tables: %d bins, %d coordinates per bin, max difference %.2g\n", bins, (int)count, maxError);
+    printf("  Runtime trig: %8.1f ns per bin\n", ns[0]);
+    printf("  Tables:       %8.1f ns per bin\n", ns[1]);
+    printf("  Removed:      %8.1f ns per bin (%.1fx)\n", ns[0] - ns[1], ns[1] > 0.0 ? ns[0] / ns[1] : 0.0);
+}
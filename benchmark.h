@@ -0,0 +1,51 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "headless.h"
+#include <string>
+#include <vector>
+
+#define BENCHMARK_FRAMES        60 // Recorded frames per scenario (one full orbit)
+#define BENCHMARK_WARMUP_FRAMES 5
+#define BENCHMARK_PITCH         25.0f
+#define BENCHMARK_TABLE_BINS    200000 // Bins generated by the geometry table microbenchmark
+
+// One fleet size seen from one zoom level along a fixed orbit
+struct BenchmarkScenario {
+    std::string name;
+    int bins;
+    float zoom; // Fraction of the fleet's maximum camera distance
+    int frames;
+};
+
+struct BenchmarkFrame {
+    double ms;
+    unsigned drawCalls;
+    unsigned long vertices;
+    unsigned long binsDrawn;
+};
+
+struct BenchmarkResult {
+    BenchmarkScenario scenario;
+    double meanMs, p50Ms, p99Ms, maxMs;
+    double drawCalls, vertices, binsDrawn; // Means per frame
+};
+
+// Every size at the near, mid and far zoom levels
+std::vector<BenchmarkScenario> benchmarkScenarios(const std::vector<int>& sizes, int frames);
+// "1,10,100" -> sizes; false on malformed input
+bool parseBenchmarkSizes(const char* text, std::vector<int>* sizes);
+// Camera for frame of a scenario: a full turn at fixed pitch, distance from the zoom level
+void benchmarkPose(const BenchmarkScenario& scenario, int frame, float maxDistance, CameraPose* pose);
+
+BenchmarkResult summarizeBenchmark(const BenchmarkScenario& scenario, const std::vector<BenchmarkFrame>& frames);
+void printBenchmarkResults(const std::vector<BenchmarkResult>& results);
+// Stable key order and formatting so runs can be diffed
+bool writeBenchmarkJson(const char* path, const std::vector<BenchmarkResult>& results, const char* renderer,
+                        const char* configuration, int width, int height);
+
+// CPU cost per bin of the curved-detail vertex math (three lids, leaf, recycle
+// arrows) done with runtime trig versus the constexpr tables in geomtables.h
+void benchmarkGeometryTables(int bins);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef BIN_H
+#define BIN_H
+
+// Bin & Lid constants
+#define LID_THICKNESS 0.15f
+#define RIM_HEIGHT    0.2f
+#define LID_COLOR_SCALE 1.6f // Lids are drawn brighter than their compartment color
+#define LID_OPEN_ANGLE  70.0f  // Degrees a lid swings up while items fall through it
+#define LID_SWING_SPEED 280.0f // Degrees per second
+
+// Bin body, in world units with the bin standing on the origin
+#define BIN_TOTAL_WIDTH       12.0f
+#define BIN_DEPTH             6.0f
+#define BIN_HEIGHT            5.0f
+#define BIN_CENTER_Y          2.35f // Base platform lift plus body offset
+#define BIN_CORNER_RADIUS     0.5f  // Bottom corners; the floor sits this far above the body's lower edge
+#define BIN_DIVIDER_X         2.0f  // Dividers at -x and +x split the body into three compartments
+#define BIN_DIVIDER_THICKNESS 0.1f
+#define BIN_COMPARTMENT_WIDTH 3.9f  // Lid width over each compartment
+#define BIN_CORNER_SEGMENTS   12    // Rounded bottom corners at full detail
+#define BIN_FOOT_SEGMENTS     8     // Feet at full detail
+#define BIN_FLOOR_Y           (BIN_CENTER_Y - BIN_HEIGHT * 0.5f + BIN_CORNER_RADIUS) // Inside floor
+#define BIN_LID_Y             (BIN_CENTER_Y + BIN_HEIGHT * 0.5f - RIM_HEIGHT)        // Top of the closed lids
+#define BIN_FRONT_Z           (BIN_DEPTH * 0.5f * 1.05f)                             // Body front face
+#define BIN_COMPARTMENT_CENTER(c) (-BIN_TOTAL_WIDTH * 0.5f + 2.0f * BIN_DIVIDER_X * ((c) + 0.5f))
+
+// Fill gauges: a bar on the front face at the right of each compartment, rising
+// from the floor to the lid height as the compartment fills
+#define FILL_GAUGE_WIDTH 0.3f
+#define FILL_GAUGE_INSET 0.3f // From the compartment's right divider
+#define FILL_GAUGE_LEFT(c)  (BIN_COMPARTMENT_CENTER(c) + BIN_DIVIDER_X - FILL_GAUGE_INSET - FILL_GAUGE_WIDTH)
+#define FILL_GAUGE_RIGHT(c) (BIN_COMPARTMENT_CENTER(c) + BIN_DIVIDER_X - FILL_GAUGE_INSET)
+
+// Compartments, in left-to-right order along the bin
+enum BinCompartment {
+    BIN_RECYCLABLE,
+    BIN_ORGANIC,
+    BIN_HAZARDOUS,
+    BIN_COMPARTMENT_COUNT
+};
+
+// Independently drawable pieces of one bin, recorded into separate meshes
+enum BinPart {
+    BIN_PART_BODY,
+    BIN_PART_DIVIDERS,
+    BIN_PART_RECYCLABLE_LID,
+    BIN_PART_ORGANIC_LID,
+    BIN_PART_HAZARDOUS_LID,
+    BIN_PART_LABELS,
+    BIN_PART_COUNT
+};
+
+// Tessellation levels recorded for each part, finest first
+enum BinDetail {
+    BIN_DETAIL_HIGH,   // Full model
+    BIN_DETAIL_MEDIUM, // Fewer segments, no grooves or edge highlights
+    BIN_DETAIL_LOW,    // Box body with flat colored lids, no symbols
+    BIN_DETAIL_COUNT
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "camera.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static void normalize3(float v[3]) {
+    float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (length > 0.0f) {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+}
+
+static void cross3(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+void cameraViewMatrix(const Camera* camera, float out[16]) {
+    float f[3] = {camera->target[0] - camera->eye[0], camera->target[1] - camera->eye[1],
+                  camera->target[2] - camera->eye[2]};
+    normalize3(f);
+    float s[3];
+    cross3(f, camera->up, s);
+    normalize3(s);
+    float u[3];
+    cross3(s, f, u);
+
+    memset(out, 0, 16 * sizeof(float));
+    out[0] = s[0]; out[4] = s[1]; out[8] = s[2];
+    out[1] = u[0]; out[5] = u[1]; out[9] = u[2];
+    out[2] = -f[0]; out[6] = -f[1]; out[10] = -f[2];
+    out[12] = -(s[0] * camera->eye[0] + s[1] * camera->eye[1] + s[2] * camera->eye[2]);
+    out[13] = -(u[0] * camera->eye[0] + u[1] * camera->eye[1] + u[2] * camera->eye[2]);
+    out[14] = f[0] * camera->eye[0] + f[1] * camera->eye[1] + f[2] * camera->eye[2];
+    out[15] = 1.0f;
+}
+
+void cameraProjectionMatrix(const Camera* camera, float out[16]) {
+    float f = 1.0f / tanf(camera->fovY * (float)M_PI / 360.0f);
+    float depth = camera->zNear - camera->zFar;
+
+    memset(out, 0, 16 * sizeof(float));
+    out[0] = f / camera->aspect;
+    out[5] = f;
+    out[10] = (camera->zFar + camera->zNear) / depth;
+    out[11] = -1.0f;
+    out[14] = 2.0f * camera->zFar * camera->zNear / depth;
+}
+
+void multiplyMatrices(const float a[16], const float b[16], float out[16]) {
+    float result[16];
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            result[col * 4 + row] = a[0 * 4 + row] * b[col * 4 + 0] + a[1 * 4 + row] * b[col * 4 + 1] +
+                                    a[2 * 4 + row] * b[col * 4 + 2] + a[3 * 4 + row] * b[col * 4 + 3];
+        }
+    }
+    memcpy(out, result, sizeof(result));
+}
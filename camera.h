@@ -0,0 +1,21 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+// The parameters passed to gluLookAt and gluPerspective, kept so CPU-side
+// code (culling, picking) sees exactly the view OpenGL renders
+struct Camera {
+    float eye[3];
+    float target[3];
+    float up[3];
+    float fovY;   // Degrees
+    float aspect;
+    float zNear;
+    float zFar;
+};
+
+// Column-major matrices, same layout as glLoadMatrixf
+void cameraViewMatrix(const Camera* camera, float out[16]);       // gluLookAt
+void cameraProjectionMatrix(const Camera* camera, float out[16]); // gluPerspective
+void multiplyMatrices(const float a[16], const float b[16], float out[16]); // out = a * b
+
+#endif
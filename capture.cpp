@@ -0,0 +1,279 @@
+#include "capture.h"
+#include "gl_ext.h"
+#include "workers.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static FILE* output = NULL;
+static bool y4m = false;
+static int captureWidth, captureHeight;
+static size_t frameBytes; // Bottom-up RGBA as read back; drivers copy four-byte pixels without converting
+static CaptureStats stats;
+
+// Render thread side: the ring, and which slots hold a frame not yet mapped
+static GLuint pixelBuffers[CAPTURE_RING];
+static bool slotBusy[CAPTURE_RING];
+static unsigned long nextSlot = 0;
+static bool usePixelBuffers = false;
+
+// Writer side: frame buffers cycle free -> queued -> free
+static std::vector<std::vector<unsigned char> > frames;
+static std::vector<int> freeFrames, queuedFrames;
+static std::mutex queueMutex;
+static std::condition_variable queueReady;
+static std::thread writer;
+static bool stopping = false;
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Bottom-up RGBA to top-down 4:2:0 planes, averaging each 2x2 block for chroma (BT.601 full range)
+static bool writeY4mFrame(const unsigned char* rgba, std::vector<unsigned char>* planes) {
+    int w = captureWidth, h = captureHeight;
+    planes->resize(w * h * 3 / 2);
+    unsigned char* yPlane = &(*planes)[0];
+    unsigned char* uPlane = yPlane + w * h;
+    unsigned char* vPlane = uPlane + w * h / 4;
+    for (int y = 0; y < h; y += 2) {
+        const unsigned char* rows[2] = {rgba + (size_t)(h - 1 - y) * w * 4, rgba + (size_t)(h - 2 - y) * w * 4};
+        for (int x = 0; x < w; x += 2) {
+            int r = 0, g = 0, b = 0;
+            for (int dy = 0; dy < 2; dy++) {
+                for (int dx = 0; dx < 2; dx++) {
+                    const unsigned char* p = rows[dy] + (x + dx) * 4;
+                    yPlane[(y + dy) * w + x + dx] = (unsigned char)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                }
+            }
+            // Sums of four pixels, so shift by 2 more than the weights' 8
+            int u = ((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128;
+            int v = ((128 * r - 107 * g - 21 * b + 512) >> 10) + 128;
+            uPlane[(y / 2) * (w / 2) + x / 2] = (unsigned char)(u < 0 ? 0 : u > 255 ? 255 : u);
+            vPlane[(y / 2) * (w / 2) + x / 2] = (unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v);
+        }
+    }
+    return fwrite("FRAME\n", 1, 6, output) == 6 && fwrite(yPlane, 1, planes->size(), output) == planes->size();
+}
+
+// Bottom-up RGBA to top-down RGB
+static bool writeRgbFrame(const unsigned char* rgba, std::vector<unsigned char>* rgb) {
+    int w = captureWidth, h = captureHeight;
+    rgb->resize((size_t)w * h * 3);
+    unsigned char* out = &(*rgb)[0];
+    for (int y = h - 1; y >= 0; y--) {
+        const unsigned char* row = rgba + (size_t)y * w * 4;
+        for (int x = 0; x < w; x++) {
+            *out++ = row[x * 4];
+            *out++ = row[x * 4 + 1];
+            *out++ = row[x * 4 + 2];
+        }
+    }
+    return fwrite(&(*rgb)[0], 1, rgb->size(), output) == rgb->size();
+}
+
+static void writerLoop() {
+    std::vector<unsigned char> converted;
+    for (;;) {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [] { return stopping || !queuedFrames.empty(); });
+            if (queuedFrames.empty()) return; // Stopping with nothing left
+            index = queuedFrames.front();
+            queuedFrames.erase(queuedFrames.begin());
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const unsigned char* rgba = &frames[index][0];
+        size_t written;
+        bool ok;
+        if (y4m) {
+            ok = writeY4mFrame(rgba, &converted);
+            written = converted.size() + 6;
+        } else {
+            ok = writeRgbFrame(rgba, &converted);
+            written = converted.size();
+        }
+
+        std::lock_guard<std::mutex> lock(queueMutex);
+        freeFrames.push_back(index);
+        if (ok) {
+            stats.written++;
+            stats.bytes += written;
+        } else {
+            stats.writeErrors++;
+        }
+        stats.writeMs += millisecondsSince(start);
+    }
+}
+
+static void finishCapture(bool readBack);
+
+// Closing the window ends the process from inside the main loop, so a capture
+// still running then is finished here
+static void finishCaptureAtExit() {
+    finishCapture(false);
+}
+
+bool captureStart(const char* path, int width, int height, int fps) {
+    if (output) captureStop();
+    const char* extension = strrchr(path, '.');
+    y4m = extension && strcmp(extension, ".y4m") == 0;
+    if (y4m) {
+        width &= ~1;
+        height &= ~1;
+    }
+    if (width <= 0 || height <= 0) return false;
+    output = fopen(path, "wb");
+    if (!output) {
+        printf("Cannot write capture %s\n", path);
+        return false;
+    }
+    if (y4m) fprintf(output, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps > 0 ? fps : 30);
+
+    captureWidth = width;
+    captureHeight = height;
+    frameBytes = (size_t)width * height * 4;
+    memset(&stats, 0, sizeof(stats));
+
+    frames.assign(CAPTURE_QUEUE, std::vector<unsigned char>(frameBytes));
+    freeFrames.clear();
+    queuedFrames.clear();
+    for (int i = 0; i < CAPTURE_QUEUE; i++) freeFrames.push_back(i);
+    stopping = false;
+    writer = std::thread(writerLoop);
+    releaseAtExit(finishCaptureAtExit);
+
+    usePixelBuffers = glHasPixelBuffers;
+    if (usePixelBuffers) {
+        pglGenBuffers(CAPTURE_RING, pixelBuffers);
+        for (int i = 0; i < CAPTURE_RING; i++) {
+            pglBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[i]);
+            pglBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, NULL, GL_STREAM_READ);
+            slotBusy[i] = false;
+        }
+        pglBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    nextSlot = 0;
+    printf("Capturing %dx%d to %s (%s, %s readback)\n", width, height, path, y4m ? "Y4M" : "raw RGB",
+           usePixelBuffers ? "asynchronous" : "synchronous");
+    return true;
+}
+
+// Hand a bottom-up frame to the writer, or count it dropped if every buffer is queued
+static void queueFrame(const void* pixels) {
+    int index = -1;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (!freeFrames.empty()) {
+            index = freeFrames.back();
+            freeFrames.pop_back();
+        }
+    }
+    if (index < 0) {
+        stats.dropped++;
+        return;
+    }
+    memcpy(&frames[index][0], pixels, frameBytes);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queuedFrames.push_back(index);
+    }
+    queueReady.notify_one();
+}
+
+// Map the oldest slot's finished copy and pass it on
+static void retireSlot(int slot) {
+    pglBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[slot]);
+    const void* pixels = pglMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (pixels) {
+        queueFrame(pixels);
+        pglUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        stats.dropped++;
+    }
+    slotBusy[slot] = false;
+}
+
+void captureFrame() {
+    if (!output) return;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    stats.frames++;
+
+    if (usePixelBuffers) {
+        int slot = (int)(nextSlot++ % CAPTURE_RING);
+        // The slot about to be reused holds the frame from CAPTURE_RING frames ago
+        if (slotBusy[slot]) retireSlot(slot);
+        pglBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[slot]);
+        glReadPixels(0, 0, captureWidth, captureHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        pglBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slotBusy[slot] = true;
+    } else {
+        static std::vector<unsigned char> pixels;
+        pixels.resize(frameBytes);
+        glReadPixels(0, 0, captureWidth, captureHeight, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+        queueFrame(&pixels[0]);
+    }
+    stats.readMs += millisecondsSince(start);
+}
+
+// readBack is false at exit, when the window and its context may already be
+// gone; the frames still in the ring are then counted as dropped
+static void finishCapture(bool readBack) {
+    if (!output) return;
+    if (usePixelBuffers) {
+        // Oldest first, so the file stays in frame order
+        for (unsigned long i = 0; i < CAPTURE_RING; i++) {
+            int slot = (int)((nextSlot + i) % CAPTURE_RING);
+            if (!slotBusy[slot]) continue;
+            if (readBack) {
+                retireSlot(slot);
+            } else {
+                stats.dropped++;
+                slotBusy[slot] = false;
+            }
+        }
+        if (readBack) {
+            pglBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            pglDeleteBuffers(CAPTURE_RING, pixelBuffers);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_one();
+    writer.join();
+    bool closed = fclose(output) == 0; // Flushes the last buffered frames
+    output = NULL;
+    frames.clear();
+
+    printf("Capture: %lu frames, %lu written (%.1f MB), %lu dropped, %lu write errors\n", stats.frames,
+           stats.written, stats.bytes / (1024.0 * 1024.0), stats.dropped, stats.writeErrors);
+    if (!closed) printf("  Error finishing the capture file; its last frames may be missing\n");
+    unsigned long converted = stats.written + stats.writeErrors;
+    if (stats.frames > 0) {
+        printf("  Render thread %.3f ms per frame, writer %.3f ms per frame\n", stats.readMs / stats.frames,
+               converted > 0 ? stats.writeMs / converted : 0.0);
+    }
+}
+
+void captureStop() {
+    finishCapture(true);
+}
+
+bool captureActive() {
+    return output != NULL;
+}
+
+const CaptureStats* captureStats() {
+    return &stats;
+}
@@ -0,0 +1,34 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+// Video capture of the rendered frames. Each frame is read into one of a ring
+// of pixel buffer objects and mapped CAPTURE_RING frames later, when its slot
+// is reused and the copy has finished, so the render thread never waits on
+// glReadPixels. A writer thread flips and converts the frames and streams them
+// to disk. Frames that arrive while CAPTURE_QUEUE frames are still waiting for
+// the writer are dropped; frames whose write fails are counted separately.
+
+#define CAPTURE_RING  3 // Pixel buffer objects in flight
+#define CAPTURE_QUEUE 8 // Frames buffered for the writer thread
+
+struct CaptureStats {
+    unsigned long frames;      // Passed to captureFrame()
+    unsigned long written;
+    unsigned long dropped;     // Writer fell behind
+    unsigned long writeErrors; // Lost because the file write failed, e.g. on a full disk
+    double bytes;
+    double readMs;         // Render-thread time in captureFrame(), total
+    double writeMs;        // Writer-thread conversion and file time, total
+};
+
+// Starts capturing width x height frames to path: .y4m writes YUV4MPEG2 (4:2:0,
+// fps in the header, odd sizes rounded down), anything else raw top-down RGB
+bool captureStart(const char* path, int width, int height, int fps);
+// Call with the finished frame in the read buffer, before swapping
+void captureFrame();
+// Writes the frames still in flight, stops the writer and prints the stats
+void captureStop();
+bool captureActive();
+const CaptureStats* captureStats();
+
+#endif
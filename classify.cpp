@@ -0,0 +1,267 @@
+#include "classify.h"
+#include "lanes.h"
+#include "workers.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#define SENSOR_NOISE 0.25f // Standard deviation of every reading around its category mean
+
+// Mean reading of each feature for each category
+static const float categoryMeans[BIN_COMPARTMENT_COUNT][SENSOR_FEATURE_COUNT] = {
+    // weight reflectance moisture voc  density conductivity temperature opacity
+    {0.3f, 0.8f, 0.1f, 0.1f, 0.4f, 0.6f, 0.5f, 0.3f}, // Recyclable: light, shiny, dry
+    {0.5f, 0.2f, 0.8f, 0.4f, 0.6f, 0.3f, 0.6f, 0.8f}, // Organic: wet, dull
+    {0.6f, 0.4f, 0.3f, 0.9f, 0.8f, 0.8f, 0.7f, 0.6f}, // Hazardous: dense, conductive, high VOC
+};
+
+// Linear scores: with equal spread on every feature, the category whose mean
+// is nearest has the highest w.x + b
+static float weights[BIN_COMPARTMENT_COUNT][SENSOR_FEATURE_COUNT];
+static float biases[BIN_COMPARTMENT_COUNT];
+static bool modelReady = false;
+
+// Every thread takes chunks of a batch until none are left
+static WorkerPool pool;
+
+// The batch being worked on
+static const SensorBatch* job = NULL;
+static float* jobCategory = NULL;
+static int jobKernel = LANE_KERNEL_SCALAR;
+static std::atomic<size_t> nextChunk(0);
+static std::atomic<unsigned long> jobAssigned[BIN_COMPARTMENT_COUNT];
+static std::atomic<unsigned long> jobUncertain(0);
+static std::atomic<unsigned long> jobCorrect(0);
+
+static ClassifyStats stats;
+static float latencies[CLASSIFY_LATENCY_KEEP];
+
+static void buildModel() {
+    float inverseVariance = 1.0f / (SENSOR_NOISE * SENSOR_NOISE);
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        biases[c] = 0.0f;
+        for (int f = 0; f < SENSOR_FEATURE_COUNT; f++) {
+            weights[c][f] = categoryMeans[c][f] * inverseVariance;
+            biases[c] -= 0.5f * categoryMeans[c][f] * categoryMeans[c][f] * inverseVariance;
+        }
+    }
+    modelReady = true;
+}
+
+// Scores, picks the best category and counts uncertain items in [begin, end),
+// end - begin a multiple of L::width
+template <typename L>
+static unsigned long classifyRange(const SensorBatch* b, float* category, size_t begin, size_t end) {
+    typedef typename L::V V;
+    typedef typename L::M M;
+    V w[BIN_COMPARTMENT_COUNT][SENSOR_FEATURE_COUNT], bias[BIN_COMPARTMENT_COUNT];
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        bias[c] = L::set(biases[c]);
+        for (int f = 0; f < SENSOR_FEATURE_COUNT; f++) w[c][f] = L::set(weights[c][f]);
+    }
+    const V zero = L::set(0.0f);
+    const V one = L::set(1.0f);
+    const V margin = L::set(CLASSIFY_MARGIN);
+    const V hazardous = L::set((float)BIN_HAZARDOUS);
+    V uncertainCount = zero;
+
+    for (size_t i = begin; i < end; i += L::width) {
+        V score[BIN_COMPARTMENT_COUNT];
+        for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) score[c] = bias[c];
+        for (int f = 0; f < SENSOR_FEATURE_COUNT; f++) {
+            V x = L::load(&b->feature[f][i]);
+            for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) score[c] = L::add(score[c], L::mul(w[c][f], x));
+        }
+
+        // Running best and second best score
+        V best = score[0], second = score[0], pick = zero;
+        for (int c = 1; c < BIN_COMPARTMENT_COUNT; c++) {
+            M better = L::less(best, score[c]);
+            second = L::select(better, best, c == 1 ? score[c] : L::max(second, score[c]));
+            best = L::select(better, score[c], best);
+            pick = L::select(better, L::set((float)c), pick);
+        }
+
+        // Too close to call: hazardous is safe for anything
+        M uncertain = L::less(L::sub(best, second), margin);
+        pick = L::select(uncertain, hazardous, pick);
+        uncertainCount = L::add(uncertainCount, L::select(uncertain, one, zero));
+        L::store(&category[i], pick);
+    }
+
+    float lanes[8];
+    L::store(lanes, uncertainCount);
+    unsigned long total = 0;
+    for (int k = 0; k < L::width; k++) total += (unsigned long)lanes[k];
+    return total;
+}
+
+static unsigned long classifyChunk(const SensorBatch* b, float* category, size_t begin, size_t end, int kernel) {
+    size_t vectorEnd = begin;
+    unsigned long uncertain = 0;
+    switch (kernel) {
+#ifdef __AVX__
+        case LANE_KERNEL_AVX:
+            vectorEnd = begin + (end - begin) / AvxLanes::width * AvxLanes::width;
+            uncertain = classifyRange<AvxLanes>(b, category, begin, vectorEnd);
+            break;
+#endif
+        case LANE_KERNEL_SSE:
+            vectorEnd = begin + (end - begin) / SseLanes::width * SseLanes::width;
+            uncertain = classifyRange<SseLanes>(b, category, begin, vectorEnd);
+            break;
+    }
+    return uncertain + classifyRange<ScalarLanes>(b, category, vectorEnd, end);
+}
+
+// Take chunks of the current job until it is used up, then add this thread's tallies
+static void runChunks(int) {
+    unsigned long assigned[BIN_COMPARTMENT_COUNT] = {0};
+    unsigned long uncertain = 0, correct = 0;
+    size_t chunks = (job->count + CLASSIFY_CHUNK - 1) / CLASSIFY_CHUNK;
+    for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+        size_t begin = chunk * CLASSIFY_CHUNK;
+        size_t end = std::min(begin + CLASSIFY_CHUNK, job->count);
+        uncertain += classifyChunk(job, jobCategory, begin, end, jobKernel);
+        for (size_t i = begin; i < end; i++) {
+            assigned[(int)jobCategory[i]]++;
+            correct += jobCategory[i] == job->truth[i];
+        }
+    }
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) jobAssigned[c] += assigned[c];
+    jobUncertain += uncertain;
+    jobCorrect += correct;
+}
+
+void classifyInit(int threads) {
+    classifyRelease();
+    if (!modelReady) buildModel();
+    releaseAtExit(classifyRelease);
+    workersStart(&pool, threads);
+}
+
+void classifyRelease() {
+    workersStop(&pool);
+}
+
+int classifyThreads() {
+    return workersCount(&pool);
+}
+
+static unsigned nextRandom(unsigned* state) {
+    // xorshift32, as in the simulation
+    unsigned v = *state;
+    v ^= v << 13;
+    v ^= v >> 17;
+    v ^= v << 5;
+    *state = v;
+    return v;
+}
+
+static float randomUnit(unsigned* state) {
+    return (float)(nextRandom(state) >> 8) / (float)(1 << 24);
+}
+
+void sensorGenerate(SensorBatch* b, size_t n, unsigned* seed) {
+    for (int f = 0; f < SENSOR_FEATURE_COUNT; f++) b->feature[f].resize(n);
+    b->truth.resize(n);
+    b->count = n;
+    for (size_t i = 0; i < n; i++) {
+        int c = (int)(nextRandom(seed) % BIN_COMPARTMENT_COUNT);
+        b->truth[i] = (float)c;
+        for (int f = 0; f < SENSOR_FEATURE_COUNT; f++) {
+            // Sum of three uniforms: close enough to normal, and cheap
+            float noise = (randomUnit(seed) + randomUnit(seed) + randomUnit(seed) - 1.5f) * 2.0f * SENSOR_NOISE;
+            b->feature[f][i] = categoryMeans[c][f] + noise;
+        }
+    }
+}
+
+void classifyBatch(const SensorBatch* b, float* category, int kernel) {
+    if (b->count == 0) return;
+    if (!modelReady) buildModel();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    job = b;
+    jobCategory = category;
+    jobKernel = kernel;
+    nextChunk = 0;
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) jobAssigned[c] = 0;
+    jobUncertain = 0;
+    jobCorrect = 0;
+
+    // Batches of one chunk are not worth waking anyone for
+    workersRun(&pool, runChunks, b->count > CLASSIFY_CHUNK);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    latencies[stats.batches % CLASSIFY_LATENCY_KEEP] = (float)ms;
+    stats.batches++;
+    stats.items += b->count;
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) stats.assigned[c] += jobAssigned[c];
+    stats.uncertain += jobUncertain;
+    stats.correct += jobCorrect;
+    stats.lastMs = ms;
+}
+
+const ClassifyStats* classifyStats() {
+    size_t kept = stats.batches < CLASSIFY_LATENCY_KEEP ? stats.batches : CLASSIFY_LATENCY_KEEP;
+    stats.p50Ms = stats.p99Ms = stats.maxMs = 0.0;
+    if (kept == 0) return &stats;
+    std::vector<float> sorted(latencies, latencies + kept);
+    std::sort(sorted.begin(), sorted.end());
+    stats.p50Ms = sorted[kept / 2];
+    stats.p99Ms = sorted[(kept * 99) / 100];
+    stats.maxMs = sorted[kept - 1];
+    return &stats;
+}
+
+void classifyStatsReset() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void printClassifyStats(const ClassifyStats* s) {
+    printf("Classifier: %lu items in %lu batches, %lu / %lu / %lu by compartment, %lu uncertain, %.2f%% correct\n",
+           s->items, s->batches, s->assigned[BIN_RECYCLABLE], s->assigned[BIN_ORGANIC], s->assigned[BIN_HAZARDOUS],
+           s->uncertain, s->items > 0 ? 100.0 * s->correct / s->items : 0.0);
+    printf("  Batch latency: last %.3f ms, p50 %.3f, p99 %.3f, max %.3f (%d threads)\n", s->lastMs, s->p50Ms, s->p99Ms,
+           s->maxMs, classifyThreads());
+}
+
+void benchmarkClassifier(int n) {
+    int batches = (n + CLASSIFY_BENCH_BATCH - 1) / CLASSIFY_BENCH_BATCH;
+    printf("Classifier benchmark: %d items in batches of %d, %d features\n", n, CLASSIFY_BENCH_BATCH,
+           SENSOR_FEATURE_COUNT);
+
+    // Readings are generated up front so only classification is timed
+    std::vector<SensorBatch> input(batches);
+    unsigned seed = 2024u;
+    for (int i = 0; i < batches; i++) {
+        int count = std::min(CLASSIFY_BENCH_BATCH, n - i * CLASSIFY_BENCH_BATCH);
+        sensorGenerate(&input[i], (size_t)count, &seed);
+    }
+    std::vector<float> category(CLASSIFY_BENCH_BATCH);
+
+    int cores = (int)std::thread::hardware_concurrency();
+    int threadCounts[2] = {1, cores > 1 ? cores : 1};
+    for (int t = 0; t < (threadCounts[1] > 1 ? 2 : 1); t++) {
+        classifyInit(threadCounts[t]);
+        for (int kernel = LANE_KERNEL_SCALAR; kernel <= laneBestKernel(); kernel++) {
+            classifyBatch(&input[0], &category[0], kernel); // Warm caches and threads
+            classifyStatsReset();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (int i = 0; i < batches; i++) classifyBatch(&input[i], &category[0], kernel);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            const ClassifyStats* s = classifyStats();
+            printf("  %-6s %2d threads %8.2f M items/s, batch p50 %.3f ms, p99 %.3f ms, max %.3f ms, %.2f%% correct\n",
+                   laneKernelName(kernel), classifyThreads(), n / seconds / 1e6, s->p50Ms, s->p99Ms, s->maxMs,
+                   100.0 * s->correct / s->items);
+        }
+    }
+    classifyInit(0);
+    classifyStatsReset();
+}
@@ -0,0 +1,62 @@
+#ifndef CLASSIFY_H
+#define CLASSIFY_H
+
+#include "bin.h"
+#include <stddef.h>
+#include <vector>
+
+#define CLASSIFY_CHUNK        2048  // Items per unit of work handed to a thread
+#define CLASSIFY_MARGIN       0.5f  // Items whose two best scores are closer than this go to hazardous
+#define CLASSIFY_BENCH_BATCH  16384 // Items per batch in benchmarkClassifier()
+#define CLASSIFY_LATENCY_KEEP 1024  // Recent batch latencies kept for percentiles
+
+// Sensor readings for each item, normalized to roughly 0..1
+enum SensorFeature {
+    SENSOR_WEIGHT,
+    SENSOR_REFLECTANCE, // Near-infrared, high for clean plastic and metal
+    SENSOR_MOISTURE,
+    SENSOR_VOC,         // Volatile organic compounds
+    SENSOR_DENSITY,
+    SENSOR_CONDUCTIVITY,
+    SENSOR_TEMPERATURE,
+    SENSOR_OPACITY,
+    SENSOR_FEATURE_COUNT
+};
+
+// A batch of items in structure-of-arrays form, one vector per feature
+struct SensorBatch {
+    std::vector<float> feature[SENSOR_FEATURE_COUNT];
+    std::vector<float> truth; // BinCompartment the generator drew the item from
+    size_t count;
+};
+
+struct ClassifyStats {
+    unsigned long batches;
+    unsigned long items;
+    unsigned long assigned[BIN_COMPARTMENT_COUNT];
+    unsigned long uncertain; // Sent to hazardous for lack of margin
+    unsigned long correct;   // Matched the generator's category
+    double lastMs;
+    double p50Ms, p99Ms, maxMs; // Over the last CLASSIFY_LATENCY_KEEP batches
+};
+
+// Starts threads - 1 helper threads (0 = one per core, counting the caller)
+void classifyInit(int threads);
+void classifyRelease();
+int classifyThreads();
+
+// Synthetic readings for count items drawn evenly from the three categories
+void sensorGenerate(SensorBatch* batch, size_t count, unsigned* seed);
+
+// Writes each item's BinCompartment as a float to category, splitting batches
+// over CLASSIFY_CHUNK across the threads; one caller at a time
+void classifyBatch(const SensorBatch* batch, float* category, int kernel);
+
+const ClassifyStats* classifyStats();
+void classifyStatsReset();
+void printClassifyStats(const ClassifyStats* stats);
+
+// Throughput and batch latency for each kernel, single-threaded and on all threads
+void benchmarkClassifier(int count);
+
+#endif
@@ -0,0 +1,264 @@
+#include "culling.h"
+#include <algorithm>
+#include <math.h>
+
+#define BVH_LEAF_SIZE 8
+#define BVH_DECAY_FACTOR 4.0f // Leaf area growth that counts as degraded
+
+void frustumFromMatrix(const float m[16], Frustum* frustum) {
+    // Gribb-Hartmann: each plane is row 3 of the clip matrix plus or minus another row
+    for (int i = 0; i < 3; i++) {
+        for (int k = 0; k < 4; k++) {
+            float row3 = m[k * 4 + 3];
+            float rowI = m[k * 4 + i];
+            frustum->planes[i * 2][k] = row3 + rowI;
+            frustum->planes[i * 2 + 1][k] = row3 - rowI;
+        }
+    }
+    for (int p = 0; p < 6; p++) {
+        float* plane = frustum->planes[p];
+        float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (int k = 0; k < 4; k++) plane[k] /= length;
+        }
+    }
+}
+
+void frustumFromCamera(const Camera* camera, Frustum* frustum) {
+    float view[16], projection[16], viewProjection[16];
+    cameraViewMatrix(camera, view);
+    cameraProjectionMatrix(camera, projection);
+    multiplyMatrices(projection, view, viewProjection);
+    frustumFromMatrix(viewProjection, frustum);
+}
+
+CullResult frustumTestAabb(const Frustum* frustum, const Aabb* box) {
+    float center[3], extent[3];
+    for (int k = 0; k < 3; k++) {
+        center[k] = (box->min[k] + box->max[k]) * 0.5f;
+        extent[k] = (box->max[k] - box->min[k]) * 0.5f;
+    }
+
+    CullResult result = CULL_INSIDE;
+    for (int p = 0; p < 6; p++) {
+        const float* plane = frustum->planes[p];
+        float distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+        float radius = fabsf(plane[0]) * extent[0] + fabsf(plane[1]) * extent[1] + fabsf(plane[2]) * extent[2];
+        if (distance < -radius) return CULL_OUTSIDE;
+        if (distance < radius) result = CULL_INTERSECT;
+    }
+    return result;
+}
+
+void aabbMerge(Aabb* box, const Aabb* other) {
+    for (int k = 0; k < 3; k++) {
+        if (other->min[k] < box->min[k]) box->min[k] = other->min[k];
+        if (other->max[k] > box->max[k]) box->max[k] = other->max[k];
+    }
+}
+
+float aabbSurfaceArea(const Aabb* box) {
+    float x = box->max[0] - box->min[0];
+    float y = box->max[1] - box->min[1];
+    float z = box->max[2] - box->min[2];
+    return 2.0f * (x * y + y * z + z * x);
+}
+
+// Recursively split items[first .. first + count) at the centroid median of the longest axis
+static int buildNode(Bvh* bvh, int parent, int first, int count) {
+    int index = (int)bvh->nodes.size();
+    bvh->nodes.push_back(BvhNode());
+
+    Aabb bounds = bvh->itemBounds[bvh->items[first]];
+    Aabb centroids;
+    for (int k = 0; k < 3; k++) centroids.min[k] = centroids.max[k] = (bounds.min[k] + bounds.max[k]) * 0.5f;
+    for (int i = first; i < first + count; i++) {
+        const Aabb& box = bvh->itemBounds[bvh->items[i]];
+        aabbMerge(&bounds, &box);
+        for (int k = 0; k < 3; k++) {
+            float c = (box.min[k] + box.max[k]) * 0.5f;
+            if (c < centroids.min[k]) centroids.min[k] = c;
+            if (c > centroids.max[k]) centroids.max[k] = c;
+        }
+    }
+
+    BvhNode node;
+    node.bounds = bounds;
+    node.parent = parent;
+    node.builtArea = aabbSurfaceArea(&bounds);
+    node.left = node.right = -1;
+    node.first = first;
+    node.count = count;
+
+    if (count <= BVH_LEAF_SIZE) {
+        bvh->leafCount++;
+        for (int i = first; i < first + count; i++) bvh->itemLeaf[bvh->items[i]] = index;
+        bvh->nodes[index] = node;
+        return index;
+    }
+
+    int axis = 0;
+    for (int k = 1; k < 3; k++) {
+        if (centroids.max[k] - centroids.min[k] > centroids.max[axis] - centroids.min[axis]) axis = k;
+    }
+    int half = count / 2;
+    const std::vector<Aabb>& itemBounds = bvh->itemBounds;
+    std::nth_element(bvh->items.begin() + first, bvh->items.begin() + first + half, bvh->items.begin() + first + count,
+                     [&itemBounds, axis](unsigned a, unsigned b) {
+                         return itemBounds[a].min[axis] + itemBounds[a].max[axis] <
+                                itemBounds[b].min[axis] + itemBounds[b].max[axis];
+                     });
+
+    node.left = buildNode(bvh, index, first, half);
+    node.right = buildNode(bvh, index, first + half, count - half);
+    bvh->nodes[index] = node;
+    return index;
+}
+
+void bvhBuild(Bvh* bvh, const std::vector<Aabb>& bounds) {
+    bvh->nodes.clear();
+    bvh->itemBounds = bounds;
+    bvh->items.resize(bounds.size());
+    bvh->itemLeaf.assign(bounds.size(), -1);
+    bvh->leafCount = 0;
+    bvh->degradedLeaves = 0;
+    for (size_t i = 0; i < bounds.size(); i++) bvh->items[i] = (unsigned)i;
+
+    if (bounds.empty()) return;
+    bvh->nodes.reserve(2 * (bounds.size() / BVH_LEAF_SIZE + 1));
+    buildNode(bvh, -1, 0, (int)bounds.size());
+}
+
+void bvhUpdate(Bvh* bvh, unsigned item, const Aabb* bounds) {
+    bvh->itemBounds[item] = *bounds;
+    int index = bvh->itemLeaf[item];
+    if (index < 0) return;
+
+    // Recompute the leaf from its items, then merge children back up to the root
+    BvhNode& leaf = bvh->nodes[index];
+    bool wasDegraded = aabbSurfaceArea(&leaf.bounds) > leaf.builtArea * BVH_DECAY_FACTOR;
+    leaf.bounds = bvh->itemBounds[bvh->items[leaf.first]];
+    for (int i = leaf.first + 1; i < leaf.first + leaf.count; i++) {
+        aabbMerge(&leaf.bounds, &bvh->itemBounds[bvh->items[i]]);
+    }
+    bool isDegraded = aabbSurfaceArea(&leaf.bounds) > leaf.builtArea * BVH_DECAY_FACTOR;
+    bvh->degradedLeaves += (int)isDegraded - (int)wasDegraded;
+
+    for (int parent = leaf.parent; parent >= 0; parent = bvh->nodes[parent].parent) {
+        BvhNode& node = bvh->nodes[parent];
+        node.bounds = bvh->nodes[node.left].bounds;
+        aabbMerge(&node.bounds, &bvh->nodes[node.right].bounds);
+    }
+}
+
+bool bvhNeedsRebuild(const Bvh* bvh) {
+    return bvh->degradedLeaves * 10 > bvh->leafCount;
+}
+
+void bvhCull(const Bvh* bvh, const Frustum* frustum, std::vector<unsigned>* visible, CullStats* stats) {
+    if (bvh->nodes.empty()) return;
+
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        int index = stack[--top];
+        const BvhNode& node = bvh->nodes[index];
+
+        stats->nodesTested++;
+        CullResult result = frustumTestAabb(frustum, &node.bounds);
+        if (result == CULL_OUTSIDE) {
+            stats->binsCulled += node.count;
+        } else if (result == CULL_INSIDE) {
+            // Subtrees own contiguous item ranges, so a contained node is one copy
+            visible->insert(visible->end(), bvh->items.begin() + node.first, bvh->items.begin() + node.first + node.count);
+            stats->binsDrawn += node.count;
+        } else if (node.left < 0) {
+            // Partially visible leaf: test its bins individually
+            for (int i = node.first; i < node.first + node.count; i++) {
+                unsigned item = bvh->items[i];
+                if (frustumTestAabb(frustum, &bvh->itemBounds[item]) == CULL_OUTSIDE) {
+                    stats->binsCulled++;
+                } else {
+                    visible->push_back(item);
+                    stats->binsDrawn++;
+                }
+            }
+        } else {
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+        }
+    }
+}
+
+bool rayHitAabb(const float origin[3], const float inverseDirection[3], const Aabb* box, float maxDistance,
+                float* distance) {
+    float enter = 0.0f, leave = maxDistance;
+    for (int k = 0; k < 3; k++) {
+        float t0 = (box->min[k] - origin[k]) * inverseDirection[k];
+        float t1 = (box->max[k] - origin[k]) * inverseDirection[k];
+        if (t0 > t1) std::swap(t0, t1);
+        // NaN from 0 * inf (origin on a slab face, parallel ray) leaves the interval alone
+        if (t0 > enter) enter = t0;
+        if (t1 < leave) leave = t1;
+    }
+    *distance = enter;
+    return enter <= leave;
+}
+
+int bvhRaycast(const Bvh* bvh, const float origin[3], const float direction[3], float maxDistance,
+               float (*hitItem)(unsigned item, void* context), void* context, float* distance,
+               unsigned long* nodesTested) {
+    if (bvh->nodes.empty()) return -1;
+    float inverse[3];
+    for (int k = 0; k < 3; k++) inverse[k] = 1.0f / direction[k];
+
+    int nearest = -1;
+    float best = maxDistance;
+    float entry;
+    int stack[64];
+    float stackEntry[64]; // Where the ray enters each stacked node
+    int top = 0;
+    if (rayHitAabb(origin, inverse, &bvh->nodes[0].bounds, best, &entry)) {
+        stack[top] = 0;
+        stackEntry[top++] = entry;
+    }
+    while (top > 0) {
+        top--;
+        if (stackEntry[top] > best) continue; // Something closer was found since it was pushed
+        const BvhNode& node = bvh->nodes[stack[top]];
+        (*nodesTested)++;
+        if (node.left < 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                unsigned item = bvh->items[i];
+                if (!rayHitAabb(origin, inverse, &bvh->itemBounds[item], best, &entry)) continue;
+                float hit = hitItem(item, context);
+                if (hit >= 0.0f && hit < best) {
+                    best = hit;
+                    nearest = (int)item;
+                }
+            }
+            continue;
+        }
+
+        // Visit the nearer child first, so the farther one is usually pruned by then
+        float leftEntry, rightEntry;
+        bool left = rayHitAabb(origin, inverse, &bvh->nodes[node.left].bounds, best, &leftEntry);
+        bool right = rayHitAabb(origin, inverse, &bvh->nodes[node.right].bounds, best, &rightEntry);
+        if (left && right) {
+            bool leftFirst = leftEntry <= rightEntry;
+            stack[top] = leftFirst ? node.right : node.left;
+            stackEntry[top++] = leftFirst ? rightEntry : leftEntry;
+            stack[top] = leftFirst ? node.left : node.right;
+            stackEntry[top++] = leftFirst ? leftEntry : rightEntry;
+        } else if (left) {
+            stack[top] = node.left;
+            stackEntry[top++] = leftEntry;
+        } else if (right) {
+            stack[top] = node.right;
+            stackEntry[top++] = rightEntry;
+        }
+    }
+    *distance = best;
+    return nearest;
+}
@@ -0,0 +1,75 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include "camera.h"
+#include <vector>
+
+struct Aabb {
+    float min[3];
+    float max[3];
+};
+
+// Plane equations (a, b, c, d) with normals pointing into the frustum
+struct Frustum {
+    float planes[6][4];
+};
+
+enum CullResult {
+    CULL_OUTSIDE,
+    CULL_INTERSECT,
+    CULL_INSIDE
+};
+
+// Bounding-volume hierarchy node covering items[first .. first + count).
+// Children split that range in two, so every subtree is contiguous.
+struct BvhNode {
+    Aabb bounds;
+    int left, right; // Child nodes, -1 for leaves
+    int parent;
+    int first, count;
+    float builtArea; // Surface area when last built, to detect refit decay
+};
+
+struct Bvh {
+    std::vector<BvhNode> nodes;
+    std::vector<unsigned> items;     // Item indices grouped by leaf
+    std::vector<Aabb> itemBounds;
+    std::vector<int> itemLeaf;       // Leaf node holding each item
+    int leafCount;
+    int degradedLeaves;              // Leaves that grew well past their built size
+};
+
+// Per-frame culling counters
+struct CullStats {
+    unsigned long nodesTested;
+    unsigned long binsCulled;
+    unsigned long binsDrawn;
+};
+
+void frustumFromCamera(const Camera* camera, Frustum* frustum);
+void frustumFromMatrix(const float viewProjection[16], Frustum* frustum);
+CullResult frustumTestAabb(const Frustum* frustum, const Aabb* box);
+
+void aabbMerge(Aabb* box, const Aabb* other);
+float aabbSurfaceArea(const Aabb* box);
+
+void bvhBuild(Bvh* bvh, const std::vector<Aabb>& bounds);
+// Move one item and refit the path from its leaf to the root
+void bvhUpdate(Bvh* bvh, unsigned item, const Aabb* bounds);
+// True once enough refits have loosened the tree that a full build pays off
+bool bvhNeedsRebuild(const Bvh* bvh);
+// Append visible item indices; counters are added to stats
+void bvhCull(const Bvh* bvh, const Frustum* frustum, std::vector<unsigned>* visible, CullStats* stats);
+
+// Slab test. True if the ray enters box before maxDistance, with the entry
+// distance in *distance (0 when the origin is inside). inverseDirection is 1/direction.
+bool rayHitAabb(const float origin[3], const float inverseDirection[3], const Aabb* box, float maxDistance,
+                float* distance);
+// Nearest item along a ray. Items whose bounds the ray enters are passed to hitItem
+// for the exact test, which returns the hit distance or a negative number for a miss.
+// Returns the item, or -1 with nothing hit before maxDistance; nodesTested is added to.
+int bvhRaycast(const Bvh* bvh, const float origin[3], const float direction[3], float maxDistance,
+               float (*hitItem)(unsigned item, void* context), void* context, float* distance,
+               unsigned long* nodesTested);
+
+#endif
@@ -0,0 +1,798 @@
+#include "fleet.h"
+#include "gl_ext.h"
+#include "lod.h"
+#include "profiler.h"
+#include "shader.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define FILL_MERGE_GAP  32 // Clean fill records (under 1 KB) sent inside one upload rather than a second call
+#define GAUGE_MERGE_GAP 32 // Hidden bins drawn inside one gauge run rather than a second draw
+#define GAUGE_VERTICES  (BIN_COMPARTMENT_COUNT * 8) // Backing and level quad per compartment
+
+// Attribute locations, in the order bound by buildShaderProgram()
+enum {
+    ATTRIB_POSITION,
+    ATTRIB_NORMAL,
+    ATTRIB_PLACEMENT,
+    ATTRIB_TINT
+};
+
+// Gauge program attributes
+enum {
+    GAUGE_ATTRIB_POSITION,
+    GAUGE_ATTRIB_SLOT,
+    GAUGE_ATTRIB_PLACEMENT,
+    GAUGE_ATTRIB_FILL
+};
+
+// Per-instance record as laid out in the instance buffer
+struct FleetInstanceData {
+    GLfloat placement[4];                      // x, y, z, yaw in radians
+    GLfloat lidTint[BIN_COMPARTMENT_COUNT][3]; // Lid surface color, already brightened
+};
+
+// Per-bin fill record, kept in bin order so a change is a sub-range update
+struct FleetFillData {
+    GLfloat placement[4]; // Same as FleetInstanceData
+    GLfloat fill[BIN_COMPARTMENT_COUNT];
+};
+
+// Gauge vertex: slot.xyz picks the compartment, slot.w is 1 on the level quad
+struct GaugeVertex {
+    GLfloat position[3];
+    GLfloat slot[4];
+};
+
+static const char* fleetVertexSource =
+    "attribute vec3 position;\n"
+    "attribute vec3 normal;\n"
+    "attribute vec4 instancePlacement;\n"
+    "attribute vec3 instanceTint;\n"
+    "uniform vec4 materialAmbient;\n"
+    "uniform vec4 materialDiffuse;\n"
+    "uniform vec4 materialSpecular;\n"
+    "uniform vec4 materialEmission;\n"
+    "uniform float materialShininess;\n"
+    "varying vec4 color;\n"
+    "void main() {\n"
+    "    float s = sin(instancePlacement.w);\n"
+    "    float c = cos(instancePlacement.w);\n"
+    "    vec3 worldPosition = vec3(c * position.x + s * position.z, position.y, c * position.z - s * position.x);\n"
+    "    vec3 worldNormal = vec3(c * normal.x + s * normal.z, normal.y, c * normal.z - s * normal.x);\n"
+    "    vec4 eyePosition = gl_ModelViewMatrix * vec4(worldPosition + instancePlacement.xyz, 1.0);\n"
+    "    vec3 eyeNormal = normalize(gl_NormalMatrix * worldNormal);\n"
+    "    vec4 tint = vec4(instanceTint, 1.0);\n"
+    "    color = fixedFunctionLighting(eyePosition.xyz, eyeNormal, materialAmbient * tint, materialDiffuse * tint,\n"
+    "                                  materialSpecular, materialEmission, materialShininess);\n"
+    "    gl_Position = gl_ProjectionMatrix * eyePosition;\n"
+    "}\n";
+
+static const char* fleetFragmentSource =
+    "varying vec4 color;\n"
+    "void main() {\n"
+    "    gl_FragColor = color;\n"
+    "}\n";
+
+// Level quads stretch from the floor by the compartment's fill and shade from green to red
+static const char* gaugeVertexSource =
+    "attribute vec3 position;\n"
+    "attribute vec4 slot;\n"
+    "attribute vec4 instancePlacement;\n"
+    "attribute vec3 instanceFill;\n"
+    "uniform float gaugeFloor;\n"
+    "varying vec4 color;\n"
+    "void main() {\n"
+    "    float level = dot(instanceFill, slot.xyz);\n"
+    "    vec3 p = position;\n"
+    "    p.y = mix(p.y, gaugeFloor + (p.y - gaugeFloor) * level, slot.w);\n"
+    "    float s = sin(instancePlacement.w);\n"
+    "    float c = cos(instancePlacement.w);\n"
+    "    vec3 worldPosition = vec3(c * p.x + s * p.z, p.y, c * p.z - s * p.x) + instancePlacement.xyz;\n"
+    "    vec4 levelColor = vec4(min(1.0, 2.0 * level), min(1.0, 2.0 - 2.0 * level), 0.0, 1.0);\n"
+    "    color = mix(vec4(0.25, 0.25, 0.25, 1.0), levelColor, slot.w);\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * vec4(worldPosition, 1.0);\n"
+    "}\n";
+
+static const Mesh (*partMeshes)[BIN_PART_COUNT] = NULL;
+static std::vector<BinInstance> instances;
+static std::vector<FleetInstanceData> instanceData;
+static GLuint program = 0;
+static GLuint instanceBuffer = 0;
+static GLint uniformAmbient, uniformDiffuse, uniformSpecular, uniformEmission, uniformShininess;
+static FleetStats stats = {0, 0, {0, 0, 0}, 0, 0, 0, 0, 0, 0, 0};
+static unsigned long generation = 0;
+
+// Fill gauges
+static std::vector<FleetFillData> fillData;
+static std::vector<unsigned long long> fillDirty; // One bit per bin changed since the last upload
+static bool fillBufferStale = true;               // Whole buffer needs (re)allocating
+static std::vector<unsigned long long> gaugeVisible;
+static GLuint gaugeProgram = 0;
+static GLuint fillBuffer = 0, gaugeVertexBuffer = 0, gaugeIndexBuffer = 0;
+static GLint uniformGaugeFloor;
+
+// Frustum culling
+static Aabb localBounds;                 // One bin in its own space, from the part meshes
+static Bvh bvh;
+static std::vector<unsigned> visibleList;
+static std::vector<FleetInstanceData> visibleData;
+static CullStats cullStats = {0, 0, 0};
+
+// Level of detail
+static float boundingRadius;                    // Sphere around localBounds
+static std::vector<signed char> instanceDetail; // Level used last frame, -1 before the first
+static std::vector<unsigned> detailLists[BIN_DETAIL_COUNT];
+
+// Swinging lids: nodes only for bins with a lid open or moving
+struct FleetLidBin {
+    unsigned bin;
+    BinNodes nodes;
+    float angle[BIN_COMPARTMENT_COUNT];  // Degrees open
+    float target[BIN_COMPARTMENT_COUNT];
+    float hold[BIN_COMPARTMENT_COUNT];   // Seconds left fully open before shutting, negative to stay open
+};
+static SceneGraph lidGraph;
+static std::vector<FleetLidBin> lidBins;
+static std::vector<int> lidSlot;             // Per bin, index into lidBins or -1 while shut
+static unsigned long lidNodesUpdated = 0;
+static std::vector<unsigned> openLists[BIN_DETAIL_COUNT]; // Visible bins drawn with lids swung, per level
+
+// Which compartment color tints a part, or -1 for untinted parts
+static int partCompartment(int part) {
+    switch (part) {
+        case BIN_PART_RECYCLABLE_LID: return BIN_RECYCLABLE;
+        case BIN_PART_ORGANIC_LID: return BIN_ORGANIC;
+        case BIN_PART_HAZARDOUS_LID: return BIN_HAZARDOUS;
+        default: return -1;
+    }
+}
+
+// Backing and level quads for every compartment, in bin space
+static void buildGauge() {
+    GaugeVertex vertices[GAUGE_VERTICES];
+    GLuint indices[BIN_COMPARTMENT_COUNT * 12];
+    int v = 0, n = 0;
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        for (int quad = 0; quad < 2; quad++) {
+            // The level quad sits just in front of its backing
+            float z = BIN_FRONT_Z + 0.01f * (quad + 1);
+            float corners[4][2] = {{FILL_GAUGE_LEFT(c), BIN_FLOOR_Y}, {FILL_GAUGE_RIGHT(c), BIN_FLOOR_Y},
+                                   {FILL_GAUGE_RIGHT(c), BIN_LID_Y}, {FILL_GAUGE_LEFT(c), BIN_LID_Y}};
+            for (int k = 0; k < 4; k++) {
+                GaugeVertex& vertex = vertices[v + k];
+                vertex.position[0] = corners[k][0];
+                vertex.position[1] = corners[k][1];
+                vertex.position[2] = z;
+                for (int j = 0; j < 3; j++) vertex.slot[j] = j == c ? 1.0f : 0.0f;
+                vertex.slot[3] = (GLfloat)quad;
+            }
+            GLuint quadIndices[6] = {0, 1, 2, 0, 2, 3};
+            for (int k = 0; k < 6; k++) indices[n++] = v + quadIndices[k];
+            v += 4;
+        }
+    }
+    pglGenBuffers(1, &gaugeVertexBuffer);
+    pglGenBuffers(1, &gaugeIndexBuffer);
+    pglBindBuffer(GL_ARRAY_BUFFER, gaugeVertexBuffer);
+    pglBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gaugeIndexBuffer);
+    pglBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    pglBindBuffer(GL_ARRAY_BUFFER, 0);
+    pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+bool fleetInit(const Mesh parts[BIN_DETAIL_COUNT][BIN_PART_COUNT]) {
+    partMeshes = parts;
+    if (!glHasInstancing) return false;
+
+    const char* vertexSources[3] = {"#version 120\n", shaderLightingSource, fleetVertexSource};
+    const char* fragmentSources[2] = {"#version 120\n", fleetFragmentSource};
+    const char* attributes[5] = {"position", "normal", "instancePlacement", "instanceTint", NULL};
+    program = buildShaderProgram("Fleet", vertexSources, 3, fragmentSources, 2, attributes);
+    if (!program) return false;
+
+    uniformAmbient = pglGetUniformLocation(program, "materialAmbient");
+    uniformDiffuse = pglGetUniformLocation(program, "materialDiffuse");
+    uniformSpecular = pglGetUniformLocation(program, "materialSpecular");
+    uniformEmission = pglGetUniformLocation(program, "materialEmission");
+    uniformShininess = pglGetUniformLocation(program, "materialShininess");
+    pglGenBuffers(1, &instanceBuffer);
+
+    const char* gaugeSources[2] = {"#version 120\n", gaugeVertexSource};
+    const char* gaugeAttributes[5] = {"position", "slot", "instancePlacement", "instanceFill", NULL};
+    gaugeProgram = buildShaderProgram("Fill gauge", gaugeSources, 2, fragmentSources, 2, gaugeAttributes);
+    if (gaugeProgram) {
+        uniformGaugeFloor = pglGetUniformLocation(gaugeProgram, "gaugeFloor");
+        buildGauge();
+        pglGenBuffers(1, &fillBuffer);
+    }
+    return true;
+}
+
+// Bounds of the full-detail bin, shared by every instance before placement
+static void computeLocalBounds() {
+    bool first = true;
+    for (int part = 0; part < BIN_PART_COUNT; part++) {
+        const std::vector<MeshVertex>& vertices = partMeshes[BIN_DETAIL_HIGH][part].vertices;
+        for (size_t i = 0; i < vertices.size(); i++) {
+            for (int k = 0; k < 3; k++) {
+                float v = vertices[i].position[k];
+                if (first || v < localBounds.min[k]) localBounds.min[k] = v;
+                if (first || v > localBounds.max[k]) localBounds.max[k] = v;
+            }
+            first = false;
+        }
+    }
+
+    float squared = 0.0f;
+    for (int k = 0; k < 3; k++) {
+        float extent = (localBounds.max[k] - localBounds.min[k]) * 0.5f;
+        squared += extent * extent;
+    }
+    boundingRadius = sqrtf(squared);
+}
+
+// World-space box around a bin rotated by yaw about +Y and moved to its position
+static void instanceWorldBounds(const BinInstance& bin, Aabb* box) {
+    float radians = bin.yaw * (float)M_PI / 180.0f;
+    float c = cosf(radians);
+    float s = sinf(radians);
+    float center[3], extent[3];
+    for (int k = 0; k < 3; k++) {
+        center[k] = (localBounds.min[k] + localBounds.max[k]) * 0.5f;
+        extent[k] = (localBounds.max[k] - localBounds.min[k]) * 0.5f;
+    }
+    float worldCenter[3] = {c * center[0] + s * center[2] + bin.position[0], center[1] + bin.position[1],
+                            c * center[2] - s * center[0] + bin.position[2]};
+    float worldExtent[3] = {fabsf(c) * extent[0] + fabsf(s) * extent[2], extent[1],
+                            fabsf(s) * extent[0] + fabsf(c) * extent[2]};
+    for (int k = 0; k < 3; k++) {
+        box->min[k] = worldCenter[k] - worldExtent[k];
+        box->max[k] = worldCenter[k] + worldExtent[k];
+    }
+}
+
+static void packInstance(const BinInstance& bin, FleetInstanceData* data) {
+    data->placement[0] = bin.position[0];
+    data->placement[1] = bin.position[1];
+    data->placement[2] = bin.position[2];
+    data->placement[3] = bin.yaw * (GLfloat)M_PI / 180.0f;
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        for (int k = 0; k < 3; k++) {
+            GLfloat tint = bin.lidColors[c][k] * LID_COLOR_SCALE;
+            data->lidTint[c][k] = tint > 1.0f ? 1.0f : tint;
+        }
+    }
+}
+
+static void packFill(const BinInstance& bin, const FleetInstanceData& instance, FleetFillData* data) {
+    memcpy(data->placement, instance.placement, sizeof(data->placement));
+    memcpy(data->fill, bin.fill, sizeof(data->fill));
+}
+
+static void markFillDirty(unsigned index) {
+    fillDirty[index / 64] |= 1ull << (index % 64);
+}
+
+void fleetSetInstances(const std::vector<BinInstance>& newInstances) {
+    fleetSetInstances(newInstances.empty() ? NULL : &newInstances[0], newInstances.size());
+}
+
+void fleetSetInstances(const BinInstance* newInstances, size_t count) {
+    instances.assign(newInstances, newInstances + count);
+    computeLocalBounds();
+
+    std::vector<Aabb> bounds(instances.size());
+    instanceData.resize(instances.size());
+    fillData.resize(instances.size());
+    instanceDetail.assign(instances.size(), -1);
+    for (size_t i = 0; i < instances.size(); i++) {
+        packInstance(instances[i], &instanceData[i]);
+        packFill(instances[i], instanceData[i], &fillData[i]);
+        instanceWorldBounds(instances[i], &bounds[i]);
+    }
+    bvhBuild(&bvh, bounds);
+
+    fillDirty.assign((instances.size() + 63) / 64, 0);
+    gaugeVisible.assign(fillDirty.size(), 0);
+    fillBufferStale = true;
+    sceneClear(&lidGraph);
+    lidBins.clear();
+    lidSlot.assign(instances.size(), -1);
+    generation++;
+}
+
+// Exact test for one bin the hierarchy put in the ray's path
+struct FleetPickContext {
+    const PickRay* ray;
+    float nearest; // Nearest bin hit so far, and its lid
+    int lid;
+};
+
+static float pickInstance(unsigned index, void* context) {
+    FleetPickContext* pick = (FleetPickContext*)context;
+    const BinInstance& bin = instances[index];
+    int lid;
+    float distance = pickBin(pick->ray, bin.position, bin.yaw, &lid);
+    if (distance >= 0.0f && distance < pick->nearest) {
+        pick->nearest = distance;
+        pick->lid = lid;
+    }
+    return distance;
+}
+
+bool fleetPick(const PickRay* ray, PickResult* result, unsigned long* nodesTested) {
+    FleetPickContext context = {ray, INFINITY, -1};
+    float distance;
+    int bin = bvhRaycast(&bvh, ray->origin, ray->direction, INFINITY, pickInstance, &context, &distance, nodesTested);
+    result->bin = bin;
+    result->lid = bin >= 0 ? context.lid : -1;
+    result->distance = distance;
+    return bin >= 0;
+}
+
+const std::vector<BinInstance>& fleetInstances() {
+    return instances;
+}
+
+void fleetMoveInstance(unsigned index, const GLfloat position[3], GLfloat yaw) {
+    BinInstance& bin = instances[index];
+    bin.position[0] = position[0];
+    bin.position[1] = position[1];
+    bin.position[2] = position[2];
+    bin.yaw = yaw;
+    packInstance(bin, &instanceData[index]);
+    packFill(bin, instanceData[index], &fillData[index]);
+    markFillDirty(index);
+
+    if (lidSlot[index] >= 0) {
+        GLfloat placement[16];
+        binPlacementMatrix(bin.position, bin.yaw, placement);
+        sceneSetLocal(&lidGraph, lidBins[lidSlot[index]].nodes.root, placement);
+        sceneUpdate(&lidGraph);
+        lidNodesUpdated += lidGraph.nodesUpdated;
+    }
+
+    Aabb bounds;
+    instanceWorldBounds(bin, &bounds);
+    bvhUpdate(&bvh, index, &bounds);
+    if (bvhNeedsRebuild(&bvh)) {
+        std::vector<Aabb> allBounds = bvh.itemBounds;
+        bvhBuild(&bvh, allBounds);
+    }
+    generation++;
+}
+
+const Aabb* fleetInstanceBounds(unsigned index) {
+    return &bvh.itemBounds[index];
+}
+
+void fleetSetFill(unsigned index, const GLfloat fill[BIN_COMPARTMENT_COUNT]) {
+    BinInstance& bin = instances[index];
+    if (memcmp(bin.fill, fill, sizeof(bin.fill)) == 0) return;
+    memcpy(bin.fill, fill, sizeof(bin.fill));
+    memcpy(fillData[index].fill, fill, sizeof(bin.fill));
+    markFillDirty(index);
+    generation++;
+}
+
+unsigned long fleetGeneration() {
+    return generation;
+}
+
+static FleetLidBin* lidBin(unsigned index) {
+    if (lidSlot[index] < 0) {
+        FleetLidBin state;
+        memset(&state, 0, sizeof(state));
+        state.bin = index;
+        GLfloat placement[16];
+        binPlacementMatrix(instances[index].position, instances[index].yaw, placement);
+        sceneAddBin(&lidGraph, -1, placement, &state.nodes);
+        sceneUpdate(&lidGraph);
+        lidNodesUpdated += lidGraph.nodesUpdated;
+        lidSlot[index] = (int)lidBins.size();
+        lidBins.push_back(state);
+    }
+    return &lidBins[lidSlot[index]];
+}
+
+static void releaseLidBin(size_t slot) {
+    sceneRemove(&lidGraph, lidBins[slot].nodes.root);
+    lidSlot[lidBins[slot].bin] = -1;
+    if (slot + 1 < lidBins.size()) {
+        lidBins[slot] = lidBins.back();
+        lidSlot[lidBins[slot].bin] = (int)slot;
+    }
+    lidBins.pop_back();
+}
+
+void fleetOpenLid(unsigned index, int compartment, float holdSeconds) {
+    FleetLidBin* state = lidBin(index);
+    state->target[compartment] = LID_OPEN_ANGLE;
+    state->hold[compartment] = holdSeconds;
+}
+
+void fleetCloseLid(unsigned index, int compartment) {
+    if (lidSlot[index] >= 0) lidBins[lidSlot[index]].target[compartment] = 0.0f;
+}
+
+bool fleetLidOpen(unsigned index, int compartment) {
+    return lidSlot[index] >= 0 && lidBins[lidSlot[index]].target[compartment] > 0.0f;
+}
+
+void fleetAnimateLids(float elapsed) {
+    if (lidBins.empty()) return;
+    PROFILE_SCOPE("fleetAnimateLids");
+    float swing = LID_SWING_SPEED * elapsed;
+    for (size_t i = 0; i < lidBins.size();) {
+        FleetLidBin& state = lidBins[i];
+        bool shut = true;
+        for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+            if (state.angle[c] == state.target[c] && state.target[c] > 0.0f && state.hold[c] >= 0.0f) {
+                state.hold[c] -= elapsed;
+                if (state.hold[c] <= 0.0f) state.target[c] = 0.0f;
+            }
+            if (state.angle[c] != state.target[c]) {
+                float target = state.target[c];
+                if (state.angle[c] < target) {
+                    state.angle[c] = state.angle[c] + swing < target ? state.angle[c] + swing : target;
+                } else {
+                    state.angle[c] = state.angle[c] - swing > target ? state.angle[c] - swing : target;
+                }
+                GLfloat hinge[16];
+                binHingeMatrix(state.angle[c], hinge);
+                sceneSetLocal(&lidGraph, state.nodes.hinges[c], hinge);
+                generation++;
+            }
+            if (state.angle[c] > 0.0f || state.target[c] > 0.0f) shut = false;
+        }
+        if (shut) {
+            releaseLidBin(i);
+            generation++;
+            continue;
+        }
+        i++;
+    }
+    sceneUpdate(&lidGraph);
+    lidNodesUpdated += lidGraph.nodesUpdated;
+}
+
+const BinNodes* fleetBinNodes(unsigned index) {
+    return lidSlot[index] >= 0 ? &lidBins[lidSlot[index]].nodes : NULL;
+}
+
+const SceneGraph* fleetSceneGraph() {
+    return &lidGraph;
+}
+
+unsigned fleetLidBins() {
+    return (unsigned)lidBins.size();
+}
+
+void fleetFillColor(float level, GLfloat color[3]) {
+    // Matches levelColor in gaugeVertexSource
+    color[0] = 2.0f * level < 1.0f ? 2.0f * level : 1.0f;
+    color[1] = 2.0f - 2.0f * level < 1.0f ? 2.0f - 2.0f * level : 1.0f;
+    color[2] = 0.0f;
+}
+
+// Next run of set bits at or after start, joining runs separated by at most gap clear bits.
+// Returns false when there are no more.
+static bool nextRun(const std::vector<unsigned long long>& bits, size_t count, size_t start, size_t gap,
+                    size_t* runBegin, size_t* runEnd) {
+    size_t word = start / 64;
+    if (word >= bits.size()) return false;
+    unsigned long long pending = bits[word] & (~0ull << (start % 64));
+    while (!pending) {
+        if (++word >= bits.size()) return false;
+        pending = bits[word];
+    }
+    size_t begin = word * 64 + __builtin_ctzll(pending);
+    size_t end = begin + 1;
+    for (size_t i = end; i < count && i < end + gap + 1; i++) {
+        if (bits[i / 64] & (1ull << (i % 64))) end = i + 1;
+    }
+    *runBegin = begin;
+    *runEnd = end;
+    return true;
+}
+
+// Send changed fill records, merging nearby ones into one sub-range update
+static void uploadFill() {
+    stats.fillUploads = 0;
+    stats.fillRecords = 0;
+    stats.fillChanged = 0;
+    if (fillData.empty()) return;
+    pglBindBuffer(GL_ARRAY_BUFFER, fillBuffer);
+    if (fillBufferStale) {
+        pglBufferData(GL_ARRAY_BUFFER, fillData.size() * sizeof(FleetFillData), &fillData[0], GL_DYNAMIC_DRAW);
+        std::fill(fillDirty.begin(), fillDirty.end(), 0ull);
+        fillBufferStale = false;
+        stats.fillUploads = 1;
+        stats.fillRecords = stats.fillChanged = fillData.size();
+        return;
+    }
+
+    for (size_t w = 0; w < fillDirty.size(); w++) stats.fillChanged += __builtin_popcountll(fillDirty[w]);
+    size_t begin, end;
+    for (size_t start = 0; nextRun(fillDirty, fillData.size(), start, FILL_MERGE_GAP, &begin, &end); start = end) {
+        pglBufferSubData(GL_ARRAY_BUFFER, begin * sizeof(FleetFillData), (end - begin) * sizeof(FleetFillData),
+                         &fillData[begin]);
+        stats.fillUploads++;
+        stats.fillRecords += end - begin;
+    }
+    std::fill(fillDirty.begin(), fillDirty.end(), 0ull);
+}
+
+// Fill gauges for the visible bins above low detail, which are too small to read them.
+// The records stay in bin order, so each run of nearby visible bins is one instanced draw.
+static void drawGauges(const std::vector<unsigned> visible[BIN_DETAIL_COUNT]) {
+    PROFILE_SCOPE("fleetGauges");
+    uploadFill();
+    stats.gaugeRuns = 0;
+
+    std::fill(gaugeVisible.begin(), gaugeVisible.end(), 0ull);
+    bool any = false;
+    for (int level = BIN_DETAIL_HIGH; level < BIN_DETAIL_LOW; level++) {
+        for (size_t i = 0; i < visible[level].size(); i++) {
+            unsigned index = visible[level][i];
+            gaugeVisible[index / 64] |= 1ull << (index % 64);
+            any = true;
+        }
+    }
+    if (!any) return;
+
+    GLsizei stride = sizeof(FleetFillData);
+    pglUseProgram(gaugeProgram);
+    pglUniform1f(uniformGaugeFloor, BIN_FLOOR_Y);
+    pglBindBuffer(GL_ARRAY_BUFFER, gaugeVertexBuffer);
+    pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gaugeIndexBuffer);
+    pglVertexAttribPointer(GAUGE_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(GaugeVertex), (const GLvoid*)0);
+    pglVertexAttribPointer(GAUGE_ATTRIB_SLOT, 4, GL_FLOAT, GL_FALSE, sizeof(GaugeVertex),
+                           (const GLvoid*)(3 * sizeof(GLfloat)));
+    for (int a = GAUGE_ATTRIB_POSITION; a <= GAUGE_ATTRIB_FILL; a++) pglEnableVertexAttribArray(a);
+    pglVertexAttribDivisor(GAUGE_ATTRIB_PLACEMENT, 1);
+    pglVertexAttribDivisor(GAUGE_ATTRIB_FILL, 1);
+
+    pglBindBuffer(GL_ARRAY_BUFFER, fillBuffer);
+    size_t begin, end;
+    for (size_t start = 0; nextRun(gaugeVisible, instances.size(), start, GAUGE_MERGE_GAP, &begin, &end); start = end) {
+        size_t base = begin * sizeof(FleetFillData);
+        pglVertexAttribPointer(GAUGE_ATTRIB_PLACEMENT, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)base);
+        pglVertexAttribPointer(GAUGE_ATTRIB_FILL, 3, GL_FLOAT, GL_FALSE, stride,
+                               (const GLvoid*)(base + 4 * sizeof(GLfloat)));
+        pglDrawElementsInstanced(GL_TRIANGLES, BIN_COMPARTMENT_COUNT * 12, GL_UNSIGNED_INT, (const GLvoid*)0,
+                                 (GLsizei)(end - begin));
+        stats.gaugeRuns++;
+        stats.drawCalls++;
+        stats.verticesDrawn += (unsigned long)BIN_COMPARTMENT_COUNT * 12 * (end - begin);
+    }
+
+    pglVertexAttribDivisor(GAUGE_ATTRIB_PLACEMENT, 0);
+    pglVertexAttribDivisor(GAUGE_ATTRIB_FILL, 0);
+    for (int a = GAUGE_ATTRIB_POSITION; a <= GAUGE_ATTRIB_FILL; a++) pglDisableVertexAttribArray(a);
+}
+
+const std::vector<unsigned>& fleetCull(const Frustum* frustum) {
+    PROFILE_SCOPE("fleetCull");
+    visibleList.clear();
+    cullStats.nodesTested = 0;
+    cullStats.binsCulled = 0;
+    cullStats.binsDrawn = 0;
+
+    if (!frustum) {
+        visibleList.resize(instances.size());
+        for (size_t i = 0; i < instances.size(); i++) visibleList[i] = (unsigned)i;
+        cullStats.binsDrawn = instances.size();
+        return visibleList;
+    }
+    bvhCull(&bvh, frustum, &visibleList, &cullStats);
+    return visibleList;
+}
+
+const CullStats* fleetCullStats() {
+    return &cullStats;
+}
+
+const std::vector<unsigned>* fleetSelectDetail(const std::vector<unsigned>& visible, const Camera* camera,
+                                              int viewportHeight) {
+    return fleetSelectDetail(visible, camera, viewportHeight, &instanceDetail);
+}
+
+const std::vector<unsigned>* fleetSelectDetail(const std::vector<unsigned>& visible, const Camera* camera,
+                                              int viewportHeight, std::vector<signed char>* levels) {
+    PROFILE_SCOPE("fleetSelectDetail");
+    for (int level = 0; level < BIN_DETAIL_COUNT; level++) detailLists[level].clear();
+    if (!camera) {
+        detailLists[BIN_DETAIL_HIGH] = visible;
+        return detailLists;
+    }
+    if (levels->size() != instances.size()) levels->assign(instances.size(), -1);
+
+    for (size_t i = 0; i < visible.size(); i++) {
+        unsigned index = visible[i];
+        const Aabb& box = bvh.itemBounds[index];
+        float center[3] = {(box.min[0] + box.max[0]) * 0.5f, (box.min[1] + box.max[1]) * 0.5f,
+                           (box.min[2] + box.max[2]) * 0.5f};
+        float pixels = lodProjectedRadius(camera, viewportHeight, center, boundingRadius);
+        int level = lodSelect((*levels)[index], pixels);
+        (*levels)[index] = (signed char)level;
+        detailLists[level].push_back(index);
+    }
+    return detailLists;
+}
+
+// Draw one part mesh for count instances, tinted per instance, or by tint when given
+static void drawPartBatches(const Mesh& mesh, int compartment, const GLfloat* tint, GLsizei count) {
+    pglBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+    pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+    pglVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (const GLvoid*)0);
+    pglVertexAttribPointer(ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex),
+                           (const GLvoid*)(3 * sizeof(GLfloat)));
+
+    for (size_t b = 0; b < mesh.batches.size(); b++) {
+        const MeshBatch& batch = mesh.batches[b];
+        const MeshMaterial& material = mesh.materials[batch.material];
+
+        // Lid color tints the filled surfaces; line highlights keep their own material
+        if (compartment >= 0 && batch.mode == GL_TRIANGLES && !tint) {
+            pglEnableVertexAttribArray(ATTRIB_TINT);
+        } else if (compartment >= 0 && batch.mode == GL_TRIANGLES) {
+            pglDisableVertexAttribArray(ATTRIB_TINT);
+            pglVertexAttrib3f(ATTRIB_TINT, tint[0], tint[1], tint[2]);
+        } else {
+            pglDisableVertexAttribArray(ATTRIB_TINT);
+            pglVertexAttrib3f(ATTRIB_TINT, 1.0f, 1.0f, 1.0f);
+        }
+
+        pglUniform4fv(uniformAmbient, 1, material.ambient);
+        pglUniform4fv(uniformDiffuse, 1, material.diffuse);
+        pglUniform4fv(uniformSpecular, 1, material.specular);
+        pglUniform4fv(uniformEmission, 1, material.emission);
+        pglUniform1f(uniformShininess, material.shininess);
+        if (batch.mode == GL_LINES) glLineWidth(batch.lineWidth);
+
+        pglDrawElementsInstanced(batch.mode, batch.indexCount, GL_UNSIGNED_INT,
+                                 (const GLvoid*)(batch.firstIndex * sizeof(GLuint)), count);
+        stats.drawCalls++;
+        stats.verticesDrawn += (unsigned long)batch.indexCount * count;
+    }
+}
+
+// One instanced draw per mesh batch and detail level, independent of the number of bins.
+// Bins with a lid open or swinging share the body draws but get their lids one at a
+// time, placed by the world matrices cached in the lid scene graph.
+void fleetDraw(const std::vector<unsigned> visible[BIN_DETAIL_COUNT]) {
+    PROFILE_SCOPE("fleetDraw");
+    stats.drawCalls = 0;
+    stats.instancesDrawn = 0;
+    stats.verticesDrawn = 0;
+    stats.lidBinsDrawn = 0;
+    stats.lidNodesUpdated = lidNodesUpdated;
+    lidNodesUpdated = 0;
+    size_t total = 0;
+    for (int level = 0; level < BIN_DETAIL_COUNT; level++) {
+        stats.instancesPerDetail[level] = visible[level].size();
+        total += visible[level].size();
+    }
+    if (!program || total == 0) return;
+
+    // Stream this frame's visible instances, grouped by level with the open bins last in each group;
+    // orphaning the old store avoids waiting on the GPU
+    visibleData.resize(total);
+    size_t levelStart[BIN_DETAIL_COUNT];
+    size_t next = 0;
+    for (int level = 0; level < BIN_DETAIL_COUNT; level++) {
+        levelStart[level] = next;
+        openLists[level].clear();
+        for (size_t i = 0; i < visible[level].size(); i++) {
+            unsigned index = visible[level][i];
+            if (lidSlot[index] >= 0) {
+                openLists[level].push_back(index);
+            } else {
+                visibleData[next++] = instanceData[index];
+            }
+        }
+        for (size_t i = 0; i < openLists[level].size(); i++) visibleData[next++] = instanceData[openLists[level][i]];
+        stats.lidBinsDrawn += openLists[level].size();
+    }
+    pglBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    pglBufferData(GL_ARRAY_BUFFER, visibleData.size() * sizeof(FleetInstanceData), NULL, GL_STREAM_DRAW);
+    pglBufferSubData(GL_ARRAY_BUFFER, 0, visibleData.size() * sizeof(FleetInstanceData), &visibleData[0]);
+
+    GLsizei stride = sizeof(FleetInstanceData);
+
+    pglUseProgram(program);
+    pglEnableVertexAttribArray(ATTRIB_POSITION);
+    pglEnableVertexAttribArray(ATTRIB_NORMAL);
+    pglVertexAttribDivisor(ATTRIB_PLACEMENT, 1);
+    pglVertexAttribDivisor(ATTRIB_TINT, 1);
+
+    for (int level = 0; level < BIN_DETAIL_COUNT; level++) {
+        GLsizei count = (GLsizei)visible[level].size();
+        if (count == 0) continue;
+        GLsizei shutCount = count - (GLsizei)openLists[level].size();
+        size_t base = levelStart[level] * sizeof(FleetInstanceData);
+
+        pglEnableVertexAttribArray(ATTRIB_PLACEMENT);
+        for (int part = 0; part < BIN_PART_COUNT; part++) {
+            const Mesh& mesh = partMeshes[level][part];
+            if (!mesh.vertexBuffer) continue;
+            int compartment = partCompartment(part);
+            GLsizei partCount = compartment >= 0 ? shutCount : count;
+            if (partCount == 0) continue;
+
+            pglBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+            pglVertexAttribPointer(ATTRIB_PLACEMENT, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)base);
+            if (compartment >= 0) {
+                size_t offset = base + sizeof(GLfloat) * (4 + 3 * compartment);
+                pglVertexAttribPointer(ATTRIB_TINT, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)offset);
+            }
+            drawPartBatches(mesh, compartment, NULL, partCount);
+        }
+        if (openLists[level].empty()) continue;
+
+        // The world matrix already holds the placement, so the shader's is zeroed
+        pglDisableVertexAttribArray(ATTRIB_PLACEMENT);
+        pglVertexAttrib4f(ATTRIB_PLACEMENT, 0.0f, 0.0f, 0.0f, 0.0f);
+        for (size_t i = 0; i < openLists[level].size(); i++) {
+            unsigned index = openLists[level][i];
+            const BinNodes& nodes = lidBins[lidSlot[index]].nodes;
+            for (int part = 0; part < BIN_PART_COUNT; part++) {
+                const Mesh& mesh = partMeshes[level][part];
+                int compartment = partCompartment(part);
+                if (!mesh.vertexBuffer || compartment < 0) continue;
+                glPushMatrix();
+                glMultMatrixf(sceneWorld(&lidGraph, nodes.parts[part]));
+                drawPartBatches(mesh, compartment, instanceData[index].lidTint[compartment], 1);
+                glPopMatrix();
+            }
+        }
+    }
+    stats.instancesDrawn = total;
+
+    pglVertexAttribDivisor(ATTRIB_PLACEMENT, 0);
+    pglVertexAttribDivisor(ATTRIB_TINT, 0);
+    pglDisableVertexAttribArray(ATTRIB_POSITION);
+    pglDisableVertexAttribArray(ATTRIB_NORMAL);
+    pglDisableVertexAttribArray(ATTRIB_PLACEMENT);
+    pglDisableVertexAttribArray(ATTRIB_TINT);
+    if (gaugeProgram) drawGauges(visible);
+    pglBindBuffer(GL_ARRAY_BUFFER, 0);
+    pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    pglUseProgram(0);
+}
+
+void fleetRelease() {
+    if (instanceBuffer) pglDeleteBuffers(1, &instanceBuffer);
+    if (program) pglDeleteProgram(program);
+    if (fillBuffer) pglDeleteBuffers(1, &fillBuffer);
+    if (gaugeVertexBuffer) pglDeleteBuffers(1, &gaugeVertexBuffer);
+    if (gaugeIndexBuffer) pglDeleteBuffers(1, &gaugeIndexBuffer);
+    if (gaugeProgram) pglDeleteProgram(gaugeProgram);
+    instanceBuffer = fillBuffer = gaugeVertexBuffer = gaugeIndexBuffer = 0;
+    program = gaugeProgram = 0;
+    fillData.clear();
+    fillDirty.clear();
+    gaugeVisible.clear();
+    fillBufferStale = true;
+    instances.clear();
+    instanceData.clear();
+    instanceDetail.clear();
+    sceneClear(&lidGraph);
+    lidBins.clear();
+    lidSlot.clear();
+    bvhBuild(&bvh, std::vector<Aabb>());
+    generation++;
+}
+
+const FleetStats* fleetStats() {
+    return &stats;
+}
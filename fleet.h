@@ -0,0 +1,81 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include "bin.h"
+#include "culling.h"
+#include "mesh.h"
+#include "picking.h"
+#include "scenegraph.h"
+
+// One bin in a fleet scene
+struct BinInstance {
+    GLfloat position[3];
+    GLfloat yaw;                                 // Degrees about +Y
+    GLfloat lidColors[BIN_COMPARTMENT_COUNT][3]; // Base compartment colors, like recyclableBinColor
+    GLfloat fill[BIN_COMPARTMENT_COUNT];         // Share of each compartment in use, 0..1
+};
+
+// Per-frame counters for the last fleetDraw()
+struct FleetStats {
+    unsigned drawCalls;
+    unsigned long instancesDrawn;
+    unsigned long instancesPerDetail[BIN_DETAIL_COUNT];
+    unsigned long verticesDrawn;
+    unsigned fillUploads;         // glBufferSubData calls for changed fill records
+    unsigned long fillRecords;    // Records those calls covered, including merged gaps
+    unsigned long fillChanged;    // Bins whose fill or placement changed since the last draw
+    unsigned gaugeRuns;           // Instanced gauge draws, one per run of nearby visible bins
+    unsigned lidBinsDrawn;        // Visible bins whose lids were drawn one by one, swung open
+    unsigned long lidNodesUpdated; // Scene graph world matrices recomputed since the last draw
+};
+
+// parts: each detail level's meshes recorded with white lids, so the
+// per-instance lid color can tint them. Returns false if instancing is unavailable.
+bool fleetInit(const Mesh parts[BIN_DETAIL_COUNT][BIN_PART_COUNT]);
+void fleetSetInstances(const std::vector<BinInstance>& instances);
+void fleetSetInstances(const BinInstance* instances, size_t count); // Copied, so a mapped fleet file can be closed
+const std::vector<BinInstance>& fleetInstances();
+// Move one bin, refitting the culling hierarchy (rebuilt when refits degrade it)
+void fleetMoveInstance(unsigned index, const GLfloat position[3], GLfloat yaw);
+const Aabb* fleetInstanceBounds(unsigned index);
+// Nearest bin (and lid) under a ray; nodesTested counts hierarchy nodes visited
+bool fleetPick(const PickRay* ray, PickResult* result, unsigned long* nodesTested);
+// Report a bin's fill; only changed bins are re-uploaded before the next fleetDraw()
+void fleetSetFill(unsigned index, const GLfloat fill[BIN_COMPARTMENT_COUNT]);
+// Lids. A bin gets scene graph nodes while any of its lids is open or moving and
+// gives them back once they have all shut, so closed bins stay plain instances.
+// Swing a lid open, shutting it again after holdSeconds fully open (negative: until closed)
+void fleetOpenLid(unsigned index, int compartment, float holdSeconds);
+void fleetCloseLid(unsigned index, int compartment);
+bool fleetLidOpen(unsigned index, int compartment); // Open or opening
+// Move swinging lids on; only the subtrees of bins with a lid in motion are updated
+void fleetAnimateLids(float elapsed);
+// Nodes of a bin with a lid open or moving, NULL for a shut bin
+const BinNodes* fleetBinNodes(unsigned index);
+const SceneGraph* fleetSceneGraph();
+unsigned fleetLidBins();
+
+// Bumped by every change to the bins, so images of the fleet can be checked for staleness
+unsigned long fleetGeneration();
+// Green when empty through yellow to red when full
+void fleetFillColor(float level, GLfloat color[3]);
+
+// Indices of bins inside the frustum, or of every bin when frustum is NULL.
+// The returned list stays valid until the next call.
+const std::vector<unsigned>& fleetCull(const Frustum* frustum);
+const CullStats* fleetCullStats();
+
+// Split visible bins into BIN_DETAIL_COUNT lists by projected size, remembering
+// each bin's level for hysteresis. A NULL camera puts every bin at full detail.
+// The returned lists stay valid until the next call.
+const std::vector<unsigned>* fleetSelectDetail(const std::vector<unsigned>& visible, const Camera* camera,
+                                              int viewportHeight);
+// Same, with the levels used last time kept by the caller (one set per view when several are drawn)
+const std::vector<unsigned>* fleetSelectDetail(const std::vector<unsigned>& visible, const Camera* camera,
+                                              int viewportHeight, std::vector<signed char>* levels);
+
+void fleetDraw(const std::vector<unsigned> visible[BIN_DETAIL_COUNT]);
+void fleetRelease();
+const FleetStats* fleetStats();
+
+#endif
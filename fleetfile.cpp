@@ -0,0 +1,296 @@
+#include "fleetfile.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+static bool validate(const char* path, const MappedFile* map) {
+    const FleetFileHeader* header = (const FleetFileHeader*)map->data;
+    if (map->size < sizeof(FleetFileHeader) || memcmp(header->magic, FLEET_FILE_MAGIC, 8) != 0) {
+        printf("%s: not a fleet file\n", path);
+        return false;
+    }
+    if (header->endianTag != FLEET_FILE_ENDIAN_TAG) {
+        printf("%s: written on a machine with a different byte order\n", path);
+        return false;
+    }
+    if (header->version > FLEET_FILE_VERSION) {
+        printf("%s: version %u is newer than this build reads (%d)\n", path, header->version, FLEET_FILE_VERSION);
+        return false;
+    }
+    if (header->recordSize != sizeof(BinInstance) || header->headerSize < sizeof(FleetFileHeader) ||
+        header->headerSize % sizeof(float) != 0) {
+        printf("%s: unexpected record layout\n", path);
+        return false;
+    }
+    if (header->headerSize > map->size ||
+        header->count > (map->size - header->headerSize) / header->recordSize) {
+        printf("%s: truncated, %llu bins declared\n", path, (unsigned long long)header->count);
+        return false;
+    }
+    if (header->binWidth != BIN_TOTAL_WIDTH || header->binDepth != BIN_DEPTH || header->binHeight != BIN_HEIGHT) {
+        printf("%s: laid out for %gx%gx%g bins, drawing %gx%gx%g\n", path, header->binWidth, header->binDepth,
+               header->binHeight, BIN_TOTAL_WIDTH, BIN_DEPTH, BIN_HEIGHT);
+    }
+    return true;
+}
+
+bool fleetFileOpen(const char* path, FleetFile* file) {
+    memset(file, 0, sizeof(*file));
+    if (!mapFile(path, &file->map)) return false;
+    if (!validate(path, &file->map)) {
+        unmapFile(&file->map);
+        return false;
+    }
+    file->header = (const FleetFileHeader*)file->map.data;
+    file->bins = (const BinInstance*)((const char*)file->map.data + file->header->headerSize);
+    file->count = (size_t)file->header->count;
+    return true;
+}
+
+void fleetFileClose(FleetFile* file) {
+    unmapFile(&file->map);
+    memset(file, 0, sizeof(*file));
+}
+
+bool fleetFileWrite(const char* path, const BinInstance* bins, size_t count) {
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        printf("Cannot write fleet file %s\n", path);
+        return false;
+    }
+    FleetFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FLEET_FILE_MAGIC, 8);
+    header.version = FLEET_FILE_VERSION;
+    header.headerSize = sizeof(header);
+    header.recordSize = sizeof(BinInstance);
+    header.endianTag = FLEET_FILE_ENDIAN_TAG;
+    header.count = count;
+    header.binWidth = BIN_TOTAL_WIDTH;
+    header.binDepth = BIN_DEPTH;
+    header.binHeight = BIN_HEIGHT;
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              (count == 0 || fwrite(bins, sizeof(BinInstance), count, out) == count);
+    ok = fclose(out) == 0 && ok;
+    if (!ok) printf("Error writing fleet file %s\n", path);
+    return ok;
+}
+
+static void setDefaults(BinInstance* bin, const GLfloat* const lidColors[BIN_COMPARTMENT_COUNT]) {
+    memset(bin, 0, sizeof(*bin));
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        for (int k = 0; k < 3; k++) bin->lidColors[c][k] = lidColors[c][k];
+    }
+}
+
+static bool loadCsvLayout(const char* path, FILE* in, const GLfloat* const lidColors[BIN_COMPARTMENT_COUNT],
+                          std::vector<BinInstance>* bins) {
+    char line[1024];
+    int lineNumber = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), in)) {
+        lineNumber++;
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        float values[16];
+        int fields = 0;
+        char* cursor = line;
+        while (fields < 16) {
+            char* end;
+            float value = strtof(cursor, &end);
+            if (end == cursor) break;
+            values[fields++] = value;
+            cursor = end;
+            while (isspace((unsigned char)*cursor)) cursor++;
+            if (*cursor != ',') break;
+            cursor++;
+        }
+        if (fields == 0) {
+            // Blank line, or a header row of column names
+            continue;
+        }
+        if (fields != 4 && fields != 7 && fields != 13 && fields != 16) {
+            printf("%s:%d: expected x,y,z,yaw then optional lid colors and fill levels\n", path, lineNumber);
+            ok = false;
+            continue;
+        }
+
+        BinInstance bin;
+        setDefaults(&bin, lidColors);
+        memcpy(bin.position, values, 3 * sizeof(float));
+        bin.yaw = values[3];
+        int next = 4;
+        if (fields >= 13) {
+            memcpy(bin.lidColors, values + next, 9 * sizeof(float));
+            next += 9;
+        }
+        if (fields > next) memcpy(bin.fill, values + next, 3 * sizeof(float));
+        bins->push_back(bin);
+    }
+    return ok;
+}
+
+// Just enough JSON for the layout schema; unknown keys are skipped
+struct JsonReader {
+    std::string text;
+    size_t at;
+    bool failed;
+
+    void space() {
+        while (at < text.size() && isspace((unsigned char)text[at])) at++;
+    }
+    bool take(char c) {
+        space();
+        if (at < text.size() && text[at] == c) {
+            at++;
+            return true;
+        }
+        return false;
+    }
+    void expect(char c) {
+        if (!take(c)) failed = true;
+    }
+    std::string string() {
+        std::string value;
+        expect('"');
+        while (!failed && at < text.size() && text[at] != '"') {
+            if (text[at] == '\\') at++;
+            value += text[at++];
+        }
+        expect('"');
+        return value;
+    }
+    float number() {
+        space();
+        char* end;
+        float value = strtof(text.c_str() + at, &end);
+        if (end == text.c_str() + at) failed = true;
+        at = end - text.c_str();
+        return value;
+    }
+    // Array of up to n numbers
+    int numbers(float* out, int n) {
+        int count = 0;
+        expect('[');
+        if (take(']')) return 0;
+        do {
+            float value = number();
+            if (count < n) out[count] = value;
+            count++;
+        } while (!failed && take(','));
+        expect(']');
+        return count;
+    }
+    void skip() {
+        space();
+        if (at >= text.size()) {
+            failed = true;
+        } else if (text[at] == '"') {
+            string();
+        } else if (take('[')) {
+            if (take(']')) return;
+            do skip(); while (!failed && take(','));
+            expect(']');
+        } else if (take('{')) {
+            if (take('}')) return;
+            do {
+                string();
+                expect(':');
+                skip();
+            } while (!failed && take(','));
+            expect('}');
+        } else if (isalpha((unsigned char)text[at])) {
+            while (at < text.size() && isalpha((unsigned char)text[at])) at++; // true, false, null
+        } else {
+            number();
+        }
+    }
+};
+
+static bool loadJsonLayout(const char* path, FILE* in, const GLfloat* const lidColors[BIN_COMPARTMENT_COUNT],
+                           std::vector<BinInstance>* bins) {
+    JsonReader json;
+    json.at = 0;
+    json.failed = false;
+    char buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), in)) > 0) json.text.append(buffer, read);
+
+    json.expect('{');
+    bool sawBins = false;
+    while (!json.failed && !json.take('}')) {
+        std::string key = json.string();
+        json.expect(':');
+        if (key != "bins") {
+            json.skip();
+        } else {
+            sawBins = true;
+            json.expect('[');
+            if (!json.take(']')) {
+                do {
+                    BinInstance bin;
+                    setDefaults(&bin, lidColors);
+                    json.expect('{');
+                    if (!json.take('}')) {
+                        do {
+                            std::string field = json.string();
+                            json.expect(':');
+                            if (field == "position") {
+                                if (json.numbers(bin.position, 3) != 3) json.failed = true;
+                            } else if (field == "yaw") {
+                                bin.yaw = json.number();
+                            } else if (field == "fill") {
+                                if (json.numbers(bin.fill, 3) != 3) json.failed = true;
+                            } else if (field == "lidColors") {
+                                int c = 0;
+                                json.expect('[');
+                                do {
+                                    if (c >= BIN_COMPARTMENT_COUNT) {
+                                        json.skip();
+                                    } else if (json.numbers(bin.lidColors[c], 3) != 3) {
+                                        json.failed = true;
+                                    }
+                                    c++;
+                                } while (!json.failed && json.take(','));
+                                json.expect(']');
+                                if (c != BIN_COMPARTMENT_COUNT) json.failed = true;
+                            } else {
+                                json.skip();
+                            }
+                        } while (!json.failed && json.take(','));
+                        json.expect('}');
+                    }
+                    bins->push_back(bin);
+                } while (!json.failed && json.take(','));
+                json.expect(']');
+            }
+        }
+        if (!json.failed && !json.take(',')) {
+            json.expect('}');
+            break;
+        }
+    }
+
+    if (json.failed || !sawBins) {
+        printf("%s: bad layout near byte %lu, expected {\"bins\": [...]}\n", path, (unsigned long)json.at);
+        return false;
+    }
+    return true;
+}
+
+bool loadFleetLayout(const char* path, const GLfloat* const lidColors[BIN_COMPARTMENT_COUNT],
+                     std::vector<BinInstance>* bins) {
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        printf("Cannot open layout %s\n", path);
+        return false;
+    }
+    const char* extension = strrchr(path, '.');
+    bool ok = extension && strcmp(extension, ".json") == 0 ? loadJsonLayout(path, in, lidColors, bins)
+                                                             : loadCsvLayout(path, in, lidColors, bins);
+    fclose(in);
+    return ok;
+}
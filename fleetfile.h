@@ -0,0 +1,54 @@
+#ifndef FLEETFILE_H
+#define FLEETFILE_H
+
+#include "fleet.h"
+#include "mappedfile.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Binary fleet files: a 64-byte header followed by count BinInstance records,
+// stored exactly as they sit in memory, so a mapped file needs no parsing.
+// fleetSetInstances() still copies the records, packs them for the GPU and
+// builds the culling hierarchy over them; that, not the file, is most of the
+// load time (about 0.4 s for 1M bins).
+// Little-endian only; the endian tag catches files moved across byte orders.
+#define FLEET_FILE_MAGIC      "BINFLEET"
+#define FLEET_FILE_VERSION    1
+#define FLEET_FILE_ENDIAN_TAG 0x01020304u
+
+struct FleetFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize; // Records start here; later versions may grow the header
+    uint32_t recordSize;
+    uint32_t endianTag;
+    uint64_t count;
+    float binWidth, binDepth, binHeight; // Bin model the layout was made for
+    uint8_t reserved[20];
+};
+
+static_assert(sizeof(FleetFileHeader) == 64, "fleet file header is 64 bytes");
+static_assert(sizeof(BinInstance) == 16 * sizeof(float), "fleet file records are packed BinInstances");
+
+// A mapped fleet file; bins points into the mapping until fleetFileClose()
+struct FleetFile {
+    const FleetFileHeader* header;
+    const BinInstance* bins;
+    size_t count;
+    MappedFile map;
+};
+
+// Map and validate a fleet file; prints the reason and returns false if it cannot be used
+bool fleetFileOpen(const char* path, FleetFile* file);
+void fleetFileClose(FleetFile* file);
+bool fleetFileWrite(const char* path, const BinInstance* bins, size_t count);
+
+// Read a human-readable layout, CSV or JSON by extension.
+// CSV: one bin per line, "x,y,z,yaw[,r,g,b x3 lid colors][,fill x3]", # comments.
+// JSON: {"bins": [{"position": [x,y,z], "yaw": d, "lidColors": [[r,g,b],...], "fill": [f,f,f]}, ...]}
+// Missing lid colors and fill levels take the given defaults.
+bool loadFleetLayout(const char* path, const GLfloat* const defaultLidColors[BIN_COMPARTMENT_COUNT],
+                     std::vector<BinInstance>* bins);
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef GEOMTABLES_H
+#define GEOMTABLES_H
+
+// Vertex tables for the curved bin details, generated at compile time so the
+// draw functions do no trig. Every table is templated on its segment count and
+// instantiated for the counts detailSegments() can produce.
+
+#define LID_SEGMENTS    10 // Curved lid top at full detail
+#define LEAF_SEGMENTS   12 // Leaf symbol outline at full detail
+#define LEAF_VEINS      4  // Vein pairs on each side of the leaf stem
+#define RECYCLE_ARROWS  3
+#define LID_CURVE       0.1f // Rise of the lid top at its center
+
+#define TABLE_PI 3.14159265358979323846
+
+// Segment count used below full detail; detailSegments() applies this
+constexpr int reducedSegments(int segments) {
+    return segments / 2 > 4 ? segments / 2 : 4;
+}
+
+// C++11 constexpr sine: fold into [-pi/2, pi/2], then a Taylor series that
+// reaches double precision by its 25th power
+constexpr double tableSinSeries(double x2, double term, int n) {
+    return n > 25 ? term : term + tableSinSeries(x2, -term * x2 / ((n + 1) * (n + 2)), n + 2);
+}
+constexpr double tableWrap(double x) {
+    return x > TABLE_PI ? tableWrap(x - 2.0 * TABLE_PI) : x < -TABLE_PI ? tableWrap(x + 2.0 * TABLE_PI) : x;
+}
+constexpr double tableFold(double x) {
+    return x > TABLE_PI / 2.0 ? TABLE_PI - x : x < -TABLE_PI / 2.0 ? -TABLE_PI - x : x;
+}
+constexpr double tableSin(double x) {
+    return tableSinSeries(tableFold(tableWrap(x)) * tableFold(tableWrap(x)), tableFold(tableWrap(x)), 1);
+}
+constexpr double tableCos(double x) {
+    return tableSin(x + TABLE_PI / 2.0);
+}
+
+// Index packs for expanding a table initializer
+template <int... I>
+struct TableIndices {};
+template <int N, int... I>
+struct MakeTableIndices : MakeTableIndices<N - 1, N - 1, I...> {};
+template <int... I>
+struct MakeTableIndices<0, I...> {
+    typedef TableIndices<I...> type;
+};
+
+// Height of the curved lid top above its flat rim at Segments + 1 evenly spaced points
+template <int Segments, typename Indices = typename MakeTableIndices<Segments + 1>::type>
+struct LidProfile;
+template <int Segments, int... I>
+struct LidProfile<Segments, TableIndices<I...> > {
+    static constexpr float height[Segments + 1] = {(float)(tableSin(TABLE_PI * I / Segments) * LID_CURVE)...};
+};
+template <int Segments, int... I>
+constexpr float LidProfile<Segments, TableIndices<I...> >::height[Segments + 1];
+
+// Leaf outline in units of the symbol size, swept from the tip at the bottom to the stem at the top
+template <int Segments, typename Indices = typename MakeTableIndices<Segments + 1>::type>
+struct LeafOutline;
+template <int Segments, int... I>
+struct LeafOutline<Segments, TableIndices<I...> > {
+    static constexpr float x[Segments + 1] = {(float)(tableSin(TABLE_PI * I / Segments) * 0.4)...};
+    static constexpr float y[Segments + 1] = {(float)(-tableCos(TABLE_PI * I / Segments) * 0.8)...};
+};
+template <int Segments, int... I>
+constexpr float LeafOutline<Segments, TableIndices<I...> >::x[Segments + 1];
+template <int Segments, int... I>
+constexpr float LeafOutline<Segments, TableIndices<I...> >::y[Segments + 1];
+
+// Half-spread of each vein pair, in units of the symbol size
+template <int Veins, typename Indices = typename MakeTableIndices<Veins>::type>
+struct LeafVeins;
+template <int Veins, int... I>
+struct LeafVeins<Veins, TableIndices<I...> > {
+    static constexpr float width[Veins] = {(float)(tableSin((I + 1) * TABLE_PI / 10.0) * 0.35)...};
+};
+template <int Veins, int... I>
+constexpr float LeafVeins<Veins, TableIndices<I...> >::width[Veins];
+
+// Recycle symbol arrows in units of the symbol size. Each arrow is a head
+// triangle followed by a shaft quad, rotated a full turn / Arrows apart.
+#define RECYCLE_ARROW_VERTICES 7
+constexpr double recycleArrowLocal(int vertex, int axis) {
+    // Head (0-2) and shaft (3-6) before rotation, arrow size 0.3 and offset 0.2 along +Y
+    return axis == 0 ? (vertex == 1 ? -0.15 : vertex == 2 ? 0.15 : vertex == 3 || vertex == 6 ? -0.06
+                        : vertex == 4 || vertex == 5 ? 0.06 : 0.0)
+                     : 0.2 + (vertex == 0 ? 0.3 : vertex == 5 || vertex == 6 ? -0.45 : 0.0);
+}
+constexpr double recycleArrowVertex(int index, int axis, int arrows) {
+    return axis == 0 ? tableCos(2.0 * TABLE_PI * (index / RECYCLE_ARROW_VERTICES) / arrows) *
+                               recycleArrowLocal(index % RECYCLE_ARROW_VERTICES, 0) -
+                           tableSin(2.0 * TABLE_PI * (index / RECYCLE_ARROW_VERTICES) / arrows) *
+                               recycleArrowLocal(index % RECYCLE_ARROW_VERTICES, 1)
+                     : tableSin(2.0 * TABLE_PI * (index / RECYCLE_ARROW_VERTICES) / arrows) *
+                               recycleArrowLocal(index % RECYCLE_ARROW_VERTICES, 0) +
+                           tableCos(2.0 * TABLE_PI * (index / RECYCLE_ARROW_VERTICES) / arrows) *
+                               recycleArrowLocal(index % RECYCLE_ARROW_VERTICES, 1);
+}
+template <int Arrows, typename Indices = typename MakeTableIndices<Arrows * RECYCLE_ARROW_VERTICES>::type>
+struct RecycleArrows;
+template <int Arrows, int... I>
+struct RecycleArrows<Arrows, TableIndices<I...> > {
+    static constexpr float x[Arrows * RECYCLE_ARROW_VERTICES] = {(float)recycleArrowVertex(I, 0, Arrows)...};
+    static constexpr float y[Arrows * RECYCLE_ARROW_VERTICES] = {(float)recycleArrowVertex(I, 1, Arrows)...};
+};
+template <int Arrows, int... I>
+constexpr float RecycleArrows<Arrows, TableIndices<I...> >::x[Arrows * RECYCLE_ARROW_VERTICES];
+template <int Arrows, int... I>
+constexpr float RecycleArrows<Arrows, TableIndices<I...> >::y[Arrows * RECYCLE_ARROW_VERTICES];
+
+// Tables for a segment count returned by detailSegments()
+inline const float* lidProfile(int segments) {
+    return segments == LID_SEGMENTS ? LidProfile<LID_SEGMENTS>::height
+                                    : LidProfile<reducedSegments(LID_SEGMENTS)>::height;
+}
+inline const float* leafOutlineX(int segments) {
+    return segments == LEAF_SEGMENTS ? LeafOutline<LEAF_SEGMENTS>::x : LeafOutline<reducedSegments(LEAF_SEGMENTS)>::x;
+}
+inline const float* leafOutlineY(int segments) {
+    return segments == LEAF_SEGMENTS ? LeafOutline<LEAF_SEGMENTS>::y : LeafOutline<reducedSegments(LEAF_SEGMENTS)>::y;
+}
+
+static_assert(LidProfile<LID_SEGMENTS>::height[LID_SEGMENTS / 2] > LID_CURVE * 0.999f, "lid profile peaks at the center");
+static_assert(LeafOutline<LEAF_SEGMENTS>::y[0] < -0.799f, "leaf outline starts at its tip");
+
+#endif
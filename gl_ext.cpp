@@ -0,0 +1,181 @@
+#include "gl_ext.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <GL/glx.h>
+#endif
+
+PFNGLGENBUFFERSPROC pglGenBuffers = NULL;
+PFNGLDELETEBUFFERSPROC pglDeleteBuffers = NULL;
+PFNGLBINDBUFFERPROC pglBindBuffer = NULL;
+PFNGLBUFFERDATAPROC pglBufferData = NULL;
+PFNGLBUFFERSUBDATAPROC pglBufferSubData = NULL;
+PFNGLMAPBUFFERPROC pglMapBuffer = NULL;
+PFNGLUNMAPBUFFERPROC pglUnmapBuffer = NULL;
+
+PFNGLCREATESHADERPROC pglCreateShader = NULL;
+PFNGLDELETESHADERPROC pglDeleteShader = NULL;
+PFNGLSHADERSOURCEPROC pglShaderSource = NULL;
+PFNGLCOMPILESHADERPROC pglCompileShader = NULL;
+PFNGLGETSHADERIVPROC pglGetShaderiv = NULL;
+PFNGLGETSHADERINFOLOGPROC pglGetShaderInfoLog = NULL;
+PFNGLCREATEPROGRAMPROC pglCreateProgram = NULL;
+PFNGLDELETEPROGRAMPROC pglDeleteProgram = NULL;
+PFNGLATTACHSHADERPROC pglAttachShader = NULL;
+PFNGLBINDATTRIBLOCATIONPROC pglBindAttribLocation = NULL;
+PFNGLLINKPROGRAMPROC pglLinkProgram = NULL;
+PFNGLGETPROGRAMIVPROC pglGetProgramiv = NULL;
+PFNGLGETPROGRAMINFOLOGPROC pglGetProgramInfoLog = NULL;
+PFNGLUSEPROGRAMPROC pglUseProgram = NULL;
+PFNGLGETUNIFORMLOCATIONPROC pglGetUniformLocation = NULL;
+PFNGLUNIFORM1FPROC pglUniform1f = NULL;
+PFNGLUNIFORM1IPROC pglUniform1i = NULL;
+PFNGLUNIFORM4FVPROC pglUniform4fv = NULL;
+PFNGLENABLEVERTEXATTRIBARRAYPROC pglEnableVertexAttribArray = NULL;
+PFNGLDISABLEVERTEXATTRIBARRAYPROC pglDisableVertexAttribArray = NULL;
+PFNGLVERTEXATTRIBPOINTERPROC pglVertexAttribPointer = NULL;
+PFNGLVERTEXATTRIB3FPROC pglVertexAttrib3f = NULL;
+PFNGLVERTEXATTRIB4FPROC pglVertexAttrib4f = NULL;
+
+PFNGLDRAWELEMENTSINSTANCEDPROC pglDrawElementsInstanced = NULL;
+PFNGLVERTEXATTRIBDIVISORPROC pglVertexAttribDivisor = NULL;
+
+PFNGLGENQUERIESPROC pglGenQueries = NULL;
+PFNGLDELETEQUERIESPROC pglDeleteQueries = NULL;
+PFNGLBEGINQUERYPROC pglBeginQuery = NULL;
+PFNGLENDQUERYPROC pglEndQuery = NULL;
+PFNGLGETQUERYOBJECTIVPROC pglGetQueryObjectiv = NULL;
+PFNGLGETQUERYOBJECTUI64VPROC pglGetQueryObjectui64v = NULL;
+
+bool glHasVertexBuffers = false;
+bool glHasShaders = false;
+bool glHasInstancing = false;
+bool glHasTimerQueries = false;
+bool glHasPixelBuffers = false;
+
+static GLProcLoader procLoader = NULL;
+
+void setGLProcLoader(GLProcLoader loader) {
+    procLoader = loader;
+}
+
+// Look up a GL entry point in the current context
+static void* getProc(const char* name) {
+    if (procLoader) return procLoader(name);
+#ifdef _WIN32
+    return (void*)wglGetProcAddress(name);
+#else
+    return (void*)glXGetProcAddressARB((const GLubyte*)name);
+#endif
+}
+
+// Look up name + suffix, e.g. "glGenBuffers" + "ARB"
+static void* getProcSuffixed(const char* name, const char* suffix) {
+    char fullName[64];
+    snprintf(fullName, sizeof(fullName), "%s%s", name, suffix);
+    return getProc(fullName);
+}
+
+bool hasGLVersion(int major, int minor) {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int glMajor = 0, glMinor = 0;
+    if (!version || sscanf(version, "%d.%d", &glMajor, &glMinor) != 2) return false;
+    return glMajor > major || (glMajor == major && glMinor >= minor);
+}
+
+bool hasGLExtension(const char* name) {
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    if (!extensions) return false;
+
+    // Match whole tokens only (GL_ARB_foo must not match GL_ARB_foo_bar)
+    size_t length = strlen(name);
+    const char* p = extensions;
+    while ((p = strstr(p, name)) != NULL) {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) return true;
+        p += length;
+    }
+    return false;
+}
+
+bool loadGLExtensions() {
+    // Buffer objects are core in 1.5; the ARB entry points share the same signatures
+    bool core = hasGLVersion(1, 5);
+    if (core || hasGLExtension("GL_ARB_vertex_buffer_object")) {
+        const char* suffix = core ? "" : "ARB";
+        pglGenBuffers = (PFNGLGENBUFFERSPROC)getProcSuffixed("glGenBuffers", suffix);
+        pglDeleteBuffers = (PFNGLDELETEBUFFERSPROC)getProcSuffixed("glDeleteBuffers", suffix);
+        pglBindBuffer = (PFNGLBINDBUFFERPROC)getProcSuffixed("glBindBuffer", suffix);
+        pglBufferData = (PFNGLBUFFERDATAPROC)getProcSuffixed("glBufferData", suffix);
+        pglBufferSubData = (PFNGLBUFFERSUBDATAPROC)getProcSuffixed("glBufferSubData", suffix);
+        pglMapBuffer = (PFNGLMAPBUFFERPROC)getProcSuffixed("glMapBuffer", suffix);
+        pglUnmapBuffer = (PFNGLUNMAPBUFFERPROC)getProcSuffixed("glUnmapBuffer", suffix);
+    }
+    glHasVertexBuffers = pglGenBuffers && pglDeleteBuffers && pglBindBuffer && pglBufferData && pglBufferSubData;
+    glHasPixelBuffers = glHasVertexBuffers && pglMapBuffer && pglUnmapBuffer &&
+                        (hasGLVersion(2, 1) || hasGLExtension("GL_ARB_pixel_buffer_object"));
+
+    // The ARB shader objects API uses different names and handles, so only core 2.0 is supported
+    if (hasGLVersion(2, 0)) {
+        pglCreateShader = (PFNGLCREATESHADERPROC)getProc("glCreateShader");
+        pglDeleteShader = (PFNGLDELETESHADERPROC)getProc("glDeleteShader");
+        pglShaderSource = (PFNGLSHADERSOURCEPROC)getProc("glShaderSource");
+        pglCompileShader = (PFNGLCOMPILESHADERPROC)getProc("glCompileShader");
+        pglGetShaderiv = (PFNGLGETSHADERIVPROC)getProc("glGetShaderiv");
+        pglGetShaderInfoLog = (PFNGLGETSHADERINFOLOGPROC)getProc("glGetShaderInfoLog");
+        pglCreateProgram = (PFNGLCREATEPROGRAMPROC)getProc("glCreateProgram");
+        pglDeleteProgram = (PFNGLDELETEPROGRAMPROC)getProc("glDeleteProgram");
+        pglAttachShader = (PFNGLATTACHSHADERPROC)getProc("glAttachShader");
+        pglBindAttribLocation = (PFNGLBINDATTRIBLOCATIONPROC)getProc("glBindAttribLocation");
+        pglLinkProgram = (PFNGLLINKPROGRAMPROC)getProc("glLinkProgram");
+        pglGetProgramiv = (PFNGLGETPROGRAMIVPROC)getProc("glGetProgramiv");
+        pglGetProgramInfoLog = (PFNGLGETPROGRAMINFOLOGPROC)getProc("glGetProgramInfoLog");
+        pglUseProgram = (PFNGLUSEPROGRAMPROC)getProc("glUseProgram");
+        pglGetUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC)getProc("glGetUniformLocation");
+        pglUniform1f = (PFNGLUNIFORM1FPROC)getProc("glUniform1f");
+        pglUniform1i = (PFNGLUNIFORM1IPROC)getProc("glUniform1i");
+        pglUniform4fv = (PFNGLUNIFORM4FVPROC)getProc("glUniform4fv");
+        pglEnableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYPROC)getProc("glEnableVertexAttribArray");
+        pglDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYPROC)getProc("glDisableVertexAttribArray");
+        pglVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERPROC)getProc("glVertexAttribPointer");
+        pglVertexAttrib3f = (PFNGLVERTEXATTRIB3FPROC)getProc("glVertexAttrib3f");
+        pglVertexAttrib4f = (PFNGLVERTEXATTRIB4FPROC)getProc("glVertexAttrib4f");
+    }
+    glHasShaders = glHasVertexBuffers && pglCreateShader && pglDeleteShader && pglShaderSource && pglCompileShader &&
+                   pglGetShaderiv && pglGetShaderInfoLog && pglCreateProgram && pglDeleteProgram && pglAttachShader &&
+                   pglBindAttribLocation && pglLinkProgram && pglGetProgramiv && pglGetProgramInfoLog &&
+                   pglUseProgram && pglGetUniformLocation && pglUniform1f && pglUniform1i && pglUniform4fv &&
+                   pglEnableVertexAttribArray && pglDisableVertexAttribArray && pglVertexAttribPointer &&
+                   pglVertexAttrib3f && pglVertexAttrib4f;
+
+    // Per-instance attributes: core 3.3, or the two ARB extensions on older drivers
+    if (hasGLVersion(3, 3)) {
+        pglDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDPROC)getProc("glDrawElementsInstanced");
+        pglVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORPROC)getProc("glVertexAttribDivisor");
+    } else if (hasGLExtension("GL_ARB_draw_instanced") && hasGLExtension("GL_ARB_instanced_arrays")) {
+        pglDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDPROC)getProc("glDrawElementsInstancedARB");
+        pglVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORPROC)getProc("glVertexAttribDivisorARB");
+    }
+    glHasInstancing = glHasShaders && pglDrawElementsInstanced && pglVertexAttribDivisor;
+
+    // GL_TIME_ELAPSED queries: core 3.3 / ARB_timer_query, or EXT_timer_query on top of 1.5 queries
+    bool timerCore = hasGLVersion(3, 3) || hasGLExtension("GL_ARB_timer_query");
+    if (hasGLVersion(1, 5) && (timerCore || hasGLExtension("GL_EXT_timer_query"))) {
+        pglGenQueries = (PFNGLGENQUERIESPROC)getProc("glGenQueries");
+        pglDeleteQueries = (PFNGLDELETEQUERIESPROC)getProc("glDeleteQueries");
+        pglBeginQuery = (PFNGLBEGINQUERYPROC)getProc("glBeginQuery");
+        pglEndQuery = (PFNGLENDQUERYPROC)getProc("glEndQuery");
+        pglGetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)getProc("glGetQueryObjectiv");
+        pglGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)getProcSuffixed("glGetQueryObjectui64v",
+                                                                               timerCore ? "" : "EXT");
+    }
+    glHasTimerQueries = pglGenQueries && pglDeleteQueries && pglBeginQuery && pglEndQuery && pglGetQueryObjectiv &&
+                        pglGetQueryObjectui64v;
+
+    printf("OpenGL %s (%s)\n", (const char*)glGetString(GL_VERSION), (const char*)glGetString(GL_RENDERER));
+    printf("Vertex buffer objects: %s\n", glHasVertexBuffers ? "yes" : "no (using display lists)");
+    printf("Instanced drawing: %s\n", glHasInstancing ? "yes" : "no");
+    printf("GPU timer queries: %s\n", glHasTimerQueries ? "yes" : "no");
+    printf("Pixel buffer objects: %s\n", glHasPixelBuffers ? "yes" : "no");
+    return glHasVertexBuffers;
+}
@@ -0,0 +1,73 @@
+#ifndef GL_EXT_H
+#define GL_EXT_H
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+// Buffer objects (OpenGL 1.5 / ARB_vertex_buffer_object)
+extern PFNGLGENBUFFERSPROC pglGenBuffers;
+extern PFNGLDELETEBUFFERSPROC pglDeleteBuffers;
+extern PFNGLBINDBUFFERPROC pglBindBuffer;
+extern PFNGLBUFFERDATAPROC pglBufferData;
+extern PFNGLBUFFERSUBDATAPROC pglBufferSubData;
+extern PFNGLMAPBUFFERPROC pglMapBuffer;
+extern PFNGLUNMAPBUFFERPROC pglUnmapBuffer;
+
+// GLSL programs and generic vertex attributes (OpenGL 2.0)
+extern PFNGLCREATESHADERPROC pglCreateShader;
+extern PFNGLDELETESHADERPROC pglDeleteShader;
+extern PFNGLSHADERSOURCEPROC pglShaderSource;
+extern PFNGLCOMPILESHADERPROC pglCompileShader;
+extern PFNGLGETSHADERIVPROC pglGetShaderiv;
+extern PFNGLGETSHADERINFOLOGPROC pglGetShaderInfoLog;
+extern PFNGLCREATEPROGRAMPROC pglCreateProgram;
+extern PFNGLDELETEPROGRAMPROC pglDeleteProgram;
+extern PFNGLATTACHSHADERPROC pglAttachShader;
+extern PFNGLBINDATTRIBLOCATIONPROC pglBindAttribLocation;
+extern PFNGLLINKPROGRAMPROC pglLinkProgram;
+extern PFNGLGETPROGRAMIVPROC pglGetProgramiv;
+extern PFNGLGETPROGRAMINFOLOGPROC pglGetProgramInfoLog;
+extern PFNGLUSEPROGRAMPROC pglUseProgram;
+extern PFNGLGETUNIFORMLOCATIONPROC pglGetUniformLocation;
+extern PFNGLUNIFORM1FPROC pglUniform1f;
+extern PFNGLUNIFORM1IPROC pglUniform1i;
+extern PFNGLUNIFORM4FVPROC pglUniform4fv;
+extern PFNGLENABLEVERTEXATTRIBARRAYPROC pglEnableVertexAttribArray;
+extern PFNGLDISABLEVERTEXATTRIBARRAYPROC pglDisableVertexAttribArray;
+extern PFNGLVERTEXATTRIBPOINTERPROC pglVertexAttribPointer;
+extern PFNGLVERTEXATTRIB3FPROC pglVertexAttrib3f;
+extern PFNGLVERTEXATTRIB4FPROC pglVertexAttrib4f;
+
+// Instanced drawing (OpenGL 3.3 / ARB_draw_instanced + ARB_instanced_arrays)
+extern PFNGLDRAWELEMENTSINSTANCEDPROC pglDrawElementsInstanced;
+extern PFNGLVERTEXATTRIBDIVISORPROC pglVertexAttribDivisor;
+
+// GPU timer queries (OpenGL 3.3 / ARB_timer_query, or EXT_timer_query)
+extern PFNGLGENQUERIESPROC pglGenQueries;
+extern PFNGLDELETEQUERIESPROC pglDeleteQueries;
+extern PFNGLBEGINQUERYPROC pglBeginQuery;
+extern PFNGLENDQUERYPROC pglEndQuery;
+extern PFNGLGETQUERYOBJECTIVPROC pglGetQueryObjectiv;
+extern PFNGLGETQUERYOBJECTUI64VPROC pglGetQueryObjectui64v;
+
+// Feature flags, valid after loadGLExtensions()
+extern bool glHasVertexBuffers;
+extern bool glHasShaders;
+extern bool glHasInstancing;
+extern bool glHasTimerQueries;
+extern bool glHasPixelBuffers; // Asynchronous glReadPixels into GL_PIXEL_PACK_BUFFER (2.1 / ARB_pixel_buffer_object)
+
+// Entry point lookup for contexts not created through GLUT (e.g. EGL).
+// NULL restores the platform default.
+typedef void* (*GLProcLoader)(const char* name);
+void setGLProcLoader(GLProcLoader loader);
+
+// Resolve extension entry points for the current context
+bool loadGLExtensions();
+bool hasGLVersion(int major, int minor);
+bool hasGLExtension(const char* name);
+
+#endif
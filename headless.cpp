@@ -0,0 +1,177 @@
+#include "headless.h"
+#include "gl_ext.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+// No headless backend; the mode reports itself unavailable
+#elif defined(HEADLESS_OSMESA)
+#include <GL/osmesa.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#if defined(_WIN32)
+
+bool headlessCreateContext(int width, int height) {
+    printf("Headless rendering is not supported on this platform\n");
+    return false;
+}
+
+void headlessDestroyContext() {
+}
+
+#elif defined(HEADLESS_OSMESA)
+
+static OSMesaContext context = NULL;
+static std::vector<unsigned char> colorBuffer;
+
+static void* osmesaProc(const char* name) {
+    return (void*)OSMesaGetProcAddress(name);
+}
+
+bool headlessCreateContext(int width, int height) {
+    context = OSMesaCreateContextExt(OSMESA_RGBA, 24, 0, 0, NULL);
+    if (!context) {
+        printf("Headless: OSMesa context creation failed\n");
+        return false;
+    }
+    colorBuffer.resize((size_t)width * height * 4);
+    if (!OSMesaMakeCurrent(context, &colorBuffer[0], GL_UNSIGNED_BYTE, width, height)) {
+        printf("Headless: OSMesa could not bind a %dx%d buffer\n", width, height);
+        headlessDestroyContext();
+        return false;
+    }
+    setGLProcLoader(osmesaProc);
+    return true;
+}
+
+void headlessDestroyContext() {
+    if (context) OSMesaDestroyContext(context);
+    context = NULL;
+    colorBuffer.clear();
+    setGLProcLoader(NULL);
+}
+
+#else
+
+static EGLDisplay display = EGL_NO_DISPLAY;
+static EGLContext context = EGL_NO_CONTEXT;
+static EGLSurface surface = EGL_NO_SURFACE;
+
+static void* eglProc(const char* name) {
+    return (void*)eglGetProcAddress(name);
+}
+
+// Prefer Mesa's surfaceless platform, which needs neither X nor a DRM device
+static EGLDisplay openDisplay() {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (getPlatformDisplay && clientExtensions && strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        EGLDisplay surfaceless = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (surfaceless != EGL_NO_DISPLAY && eglInitialize(surfaceless, NULL, NULL)) return surfaceless;
+    }
+    EGLDisplay fallback = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (fallback != EGL_NO_DISPLAY && eglInitialize(fallback, NULL, NULL)) return fallback;
+    return EGL_NO_DISPLAY;
+}
+
+bool headlessCreateContext(int width, int height) {
+    display = openDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        printf("Headless: no EGL display available\n");
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0 ||
+        !eglBindAPI(EGL_OPENGL_API)) {
+        printf("Headless: no desktop OpenGL pbuffer config\n");
+        headlessDestroyContext();
+        return false;
+    }
+
+    const EGLint surfaceAttributes[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+    surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+    if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context)) {
+        printf("Headless: could not create a %dx%d EGL pbuffer context\n", width, height);
+        headlessDestroyContext();
+        return false;
+    }
+    setGLProcLoader(eglProc);
+    return true;
+}
+
+void headlessDestroyContext() {
+    if (display != EGL_NO_DISPLAY) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+        eglTerminate(display);
+    }
+    display = EGL_NO_DISPLAY;
+    context = EGL_NO_CONTEXT;
+    surface = EGL_NO_SURFACE;
+    setGLProcLoader(NULL);
+}
+
+#endif
+
+void headlessReadPixels(int width, int height, std::vector<unsigned char>* rgb) {
+    size_t rowSize = (size_t)width * 3;
+    std::vector<unsigned char> bottomUp(rowSize * height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &bottomUp[0]);
+
+    rgb->resize(bottomUp.size());
+    for (int y = 0; y < height; y++) {
+        memcpy(&(*rgb)[y * rowSize], &bottomUp[(height - 1 - y) * rowSize], rowSize);
+    }
+}
+
+bool parseCameraPose(const char* text, CameraPose* pose) {
+    pose->output.clear();
+    return sscanf(text, "%f,%f,%f", &pose->yaw, &pose->pitch, &pose->distance) == 3;
+}
+
+bool loadCameraPoses(const char* path, std::vector<CameraPose>* poses) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("Cannot open pose file %s\n", path);
+        return false;
+    }
+
+    char line[512];
+    int lineNumber = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        CameraPose pose;
+        char output[256];
+        int fields = sscanf(line, "%f %f %f %255s", &pose.yaw, &pose.pitch, &pose.distance, output);
+        if (fields <= 0) continue; // Blank line
+        if (fields < 3) {
+            printf("%s:%d: expected yaw pitch distance [output]\n", path, lineNumber);
+            ok = false;
+            continue;
+        }
+        if (fields == 4) pose.output = output;
+        poses->push_back(pose);
+    }
+    fclose(file);
+    return ok;
+}
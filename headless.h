@@ -0,0 +1,26 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <string>
+#include <vector>
+
+// Offscreen GL context without a window system: EGL pbuffer on the surfaceless
+// (or default) display, or OSMesa when built with -DHEADLESS_OSMESA.
+// Link with -lEGL (or -lOSMesa). Not available on Windows.
+bool headlessCreateContext(int width, int height);
+void headlessDestroyContext();
+// Read the current color buffer as top-down RGB rows
+void headlessReadPixels(int width, int height, std::vector<unsigned char>* rgb);
+
+// Orbit camera for one batch frame
+struct CameraPose {
+    float yaw, pitch, distance;
+    std::string output; // Empty: numbered from the --output pattern
+};
+
+// "yaw,pitch,distance"
+bool parseCameraPose(const char* text, CameraPose* pose);
+// One pose per line: yaw pitch distance [output file]. Blank lines and # comments are skipped.
+bool loadCameraPoses(const char* path, std::vector<CameraPose>* poses);
+
+#endif
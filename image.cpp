@@ -0,0 +1,107 @@
+#include "image.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+bool writePPM(const char* path, const unsigned char* rgb, int width, int height) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    size_t size = (size_t)width * height * 3;
+    bool ok = fwrite(rgb, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
+
+static unsigned long crcTable[256];
+
+static unsigned long crc32(unsigned long crc, const unsigned char* data, size_t length) {
+    if (!crcTable[1]) {
+        for (unsigned long n = 0; n < 256; n++) {
+            unsigned long c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+            crcTable[n] = c;
+        }
+    }
+    crc ^= 0xFFFFFFFFUL;
+    for (size_t i = 0; i < length; i++) crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFUL;
+}
+
+static void putBigEndian(std::vector<unsigned char>* out, unsigned long value) {
+    out->push_back((unsigned char)(value >> 24));
+    out->push_back((unsigned char)(value >> 16));
+    out->push_back((unsigned char)(value >> 8));
+    out->push_back((unsigned char)value);
+}
+
+static bool writeChunk(FILE* file, const char* type, const std::vector<unsigned char>& data) {
+    std::vector<unsigned char> chunk;
+    putBigEndian(&chunk, (unsigned long)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    putBigEndian(&chunk, crc32(0, &chunk[4], chunk.size() - 4));
+    return fwrite(&chunk[0], 1, chunk.size(), file) == chunk.size();
+}
+
+// No compression library is linked, so image data goes in stored deflate blocks.
+// Files are about the size of a PPM, which is fine for thumbnails and reports.
+bool writePNG(const char* path, const unsigned char* rgb, int width, int height) {
+    // Each row is prefixed with filter type 0 (none)
+    size_t rowSize = (size_t)width * 3;
+    std::vector<unsigned char> raw;
+    raw.reserve((rowSize + 1) * height);
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb + y * rowSize, rgb + (y + 1) * rowSize);
+    }
+
+    std::vector<unsigned char> zlib;
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    zlib.push_back(0x78); // Deflate, 32K window
+    zlib.push_back(0x01); // No preset dictionary, check bits
+    size_t offset = 0;
+    do {
+        size_t length = raw.size() - offset;
+        if (length > 65535) length = 65535;
+        zlib.push_back(offset + length == raw.size() ? 1 : 0); // Final block flag, type 00 (stored)
+        zlib.push_back((unsigned char)length);
+        zlib.push_back((unsigned char)(length >> 8));
+        zlib.push_back((unsigned char)~length);
+        zlib.push_back((unsigned char)(~length >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+    } while (offset < raw.size());
+
+    unsigned long a = 1, b = 0; // Adler-32 of the uncompressed data
+    for (size_t i = 0; i < raw.size(); i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBigEndian(&zlib, (b << 16) | a);
+
+    std::vector<unsigned char> header;
+    putBigEndian(&header, width);
+    putBigEndian(&header, height);
+    header.push_back(8); // Bit depth
+    header.push_back(2); // Truecolor RGB
+    header.push_back(0); // Deflate
+    header.push_back(0); // Adaptive filtering
+    header.push_back(0); // No interlace
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    bool ok = fwrite(signature, 1, 8, file) == 8;
+    ok = ok && writeChunk(file, "IHDR", header);
+    ok = ok && writeChunk(file, "IDAT", zlib);
+    ok = ok && writeChunk(file, "IEND", std::vector<unsigned char>());
+    return fclose(file) == 0 && ok;
+}
+
+bool writeImage(const char* path, const unsigned char* rgb, int width, int height) {
+    const char* extension = strrchr(path, '.');
+    if (extension && (strcmp(extension, ".png") == 0 || strcmp(extension, ".PNG") == 0)) {
+        return writePNG(path, rgb, width, height);
+    }
+    return writePPM(path, rgb, width, height);
+}
@@ -0,0 +1,10 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+// Write top-down 8-bit RGB pixels. The format follows the extension:
+// .png (stored, uncompressed deflate) or anything else as binary PPM.
+bool writeImage(const char* path, const unsigned char* rgb, int width, int height);
+bool writePPM(const char* path, const unsigned char* rgb, int width, int height);
+bool writePNG(const char* path, const unsigned char* rgb, int width, int height);
+
+#endif
@@ -0,0 +1,77 @@
+#include "input.h"
+#include <GL/glut.h>
+#include <chrono>
+
+typedef std::chrono::steady_clock Clock;
+
+static PendingInput queued = {0, 0, 0};
+static bool redrawPosted = false;  // A display or timer is already on its way
+static bool frameDegraded = false; // The last frame used interactive detail
+static bool dragging = false;
+static float frameBudgetMs = 0.0f;
+static float averageFrameMs = 0.0f; // Full-detail frames only, so coarse drag frames do not mask the cost
+static Clock::time_point frameStart;
+static Clock::time_point lastFrameStart;
+
+void inputSetFrameBudget(float ms) {
+    frameBudgetMs = ms > 0.0f ? ms : 0.0f;
+}
+
+float inputFrameBudget() {
+    return frameBudgetMs;
+}
+
+static void redrawTimer(int) {
+    glutPostRedisplay();
+}
+
+void inputRequestRedraw() {
+    if (redrawPosted) return;
+    redrawPosted = true;
+
+    // Hold back until the budget since the previous frame start has passed
+    std::chrono::duration<float, std::milli> sinceLast = Clock::now() - lastFrameStart;
+    float wait = frameBudgetMs - sinceLast.count();
+    if (wait >= 1.0f) {
+        glutTimerFunc((unsigned)wait, redrawTimer, 0);
+    } else {
+        glutPostRedisplay();
+    }
+}
+
+void inputQueueOrbit(int dx, int dy) {
+    queued.orbitX += dx;
+    queued.orbitY += dy;
+    inputRequestRedraw();
+}
+
+void inputQueueZoom(int steps) {
+    queued.zoomSteps += steps;
+    inputRequestRedraw();
+}
+
+void inputSetDragging(bool enabled) {
+    dragging = enabled;
+    // Replace the coarse drag frame with a full-detail one
+    if (!dragging && frameDegraded) inputRequestRedraw();
+}
+
+void inputBeginFrame(PendingInput* pending) {
+    *pending = queued;
+    queued.orbitX = queued.orbitY = queued.zoomSteps = 0;
+    redrawPosted = false;
+    frameStart = Clock::now();
+    lastFrameStart = frameStart;
+    frameDegraded = inputUseInteractiveDetail();
+}
+
+void inputEndFrame() {
+    if (frameDegraded) return;
+    std::chrono::duration<float, std::milli> elapsed = Clock::now() - frameStart;
+    // Smooth over a few frames so one slow frame does not flip detail
+    averageFrameMs = averageFrameMs > 0.0f ? averageFrameMs * 0.75f + elapsed.count() * 0.25f : elapsed.count();
+}
+
+bool inputUseInteractiveDetail() {
+    return dragging && averageFrameMs > INPUT_DRAG_LOD_MS;
+}
@@ -0,0 +1,32 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+// Input coalescing and redraw scheduling. Event handlers queue camera deltas and
+// request a redraw; the deltas are applied once per frame, at most one redraw is
+// outstanding, and nothing runs between events when the view is unchanged.
+
+#define INPUT_DRAG_LOD_MS 33.0f // Frames slower than this drop detail while dragging
+
+struct PendingInput {
+    int orbitX, orbitY; // Mouse pixels since the last frame
+    int zoomSteps;      // Positive zooms in
+};
+
+// Minimum time between frame starts in ms; 0 renders as soon as a request arrives
+void inputSetFrameBudget(float ms);
+float inputFrameBudget();
+
+// Coalesced replacement for glutPostRedisplay()
+void inputRequestRedraw();
+void inputQueueOrbit(int dx, int dy);
+void inputQueueZoom(int steps);
+void inputSetDragging(bool dragging);
+
+// Bracket display(); inputBeginFrame() hands over and clears the queued deltas
+void inputBeginFrame(PendingInput* pending);
+void inputEndFrame();
+
+// True while a drag is in progress and recent frames were too slow for it
+bool inputUseInteractiveDetail();
+
+#endif
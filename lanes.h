@@ -0,0 +1,102 @@
+#ifndef LANES_H
+#define LANES_H
+
+// Lane types give a SIMD kernel one templated body for scalar, SSE and AVX
+// code. AvxLanes only exists in builds that enable AVX (-mavx).
+
+#include <emmintrin.h>
+#include <math.h>
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+// Kernel choices for functions built on the lane types
+enum LaneKernel {
+    LANE_KERNEL_SCALAR,
+    LANE_KERNEL_SSE,
+    LANE_KERNEL_AVX // Only with a build that enables AVX
+};
+
+// Fastest kernel this build supports
+inline int laneBestKernel() {
+#ifdef __AVX__
+    return LANE_KERNEL_AVX;
+#else
+    return LANE_KERNEL_SSE;
+#endif
+}
+
+inline const char* laneKernelName(int kernel) {
+    switch (kernel) {
+        case LANE_KERNEL_SSE: return "SSE";
+        case LANE_KERNEL_AVX: return "AVX";
+        default: return "scalar";
+    }
+}
+
+struct ScalarLanes {
+    typedef float V;
+    typedef bool M;
+    static const int width = 1;
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V v) { *p = v; }
+    static V set(float f) { return f; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V min(V a, V b) { return a < b ? a : b; }
+    static V max(V a, V b) { return a > b ? a : b; }
+    static V abs(V a) { return fabsf(a); }
+    static M less(V a, V b) { return a < b; }
+    static M both(M a, M b) { return a && b; }
+    static M butNot(M a, M b) { return a && !b; } // a and not b
+    static V select(M m, V a, V b) { return m ? a : b; }
+    static bool any(M m) { return m; }
+};
+
+struct SseLanes {
+    typedef __m128 V;
+    typedef __m128 M;
+    static const int width = 4;
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V set(float f) { return _mm_set1_ps(f); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V min(V a, V b) { return _mm_min_ps(a, b); }
+    static V max(V a, V b) { return _mm_max_ps(a, b); }
+    static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static M less(V a, V b) { return _mm_cmplt_ps(a, b); }
+    static M both(M a, M b) { return _mm_and_ps(a, b); }
+    static M butNot(M a, M b) { return _mm_andnot_ps(b, a); }
+    static V select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static bool any(M m) { return _mm_movemask_ps(m) != 0; }
+};
+
+#ifdef __AVX__
+struct AvxLanes {
+    typedef __m256 V;
+    typedef __m256 M;
+    static const int width = 8;
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V set(float f) { return _mm256_set1_ps(f); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static M less(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static M both(M a, M b) { return _mm256_and_ps(a, b); }
+    static M butNot(M a, M b) { return _mm256_andnot_ps(b, a); }
+    static V select(M m, V a, V b) { return _mm256_or_ps(_mm256_and_ps(m, a), _mm256_andnot_ps(m, b)); }
+    static bool any(M m) { return _mm256_movemask_ps(m) != 0; }
+};
+#endif
+
+#endif
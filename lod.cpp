@@ -0,0 +1,34 @@
+#include "lod.h"
+#include "bin.h"
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+float lodProjectedRadius(const Camera* camera, int viewportHeight, const float center[3], float radius) {
+    float dx = center[0] - camera->eye[0];
+    float dy = center[1] - camera->eye[1];
+    float dz = center[2] - camera->eye[2];
+    float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+    if (distance <= radius) return (float)viewportHeight; // Camera inside the sphere
+
+    float halfHeight = distance * tanf(camera->fovY * (float)M_PI / 360.0f);
+    return radius / halfHeight * viewportHeight * 0.5f;
+}
+
+int lodSelect(int current, float pixels) {
+    static const float thresholds[BIN_DETAIL_COUNT - 1] = {LOD_HIGH_PIXELS, LOD_MEDIUM_PIXELS};
+
+    // Level i is used above thresholds[i]. Near the current level, the boundary
+    // shifts away from it so a bin sitting on a threshold does not flicker.
+    for (int level = 0; level < BIN_DETAIL_COUNT - 1; level++) {
+        float threshold = thresholds[level];
+        if (current >= 0) {
+            if (level < current) threshold *= 1.0f + LOD_HYSTERESIS; // Refining needs a bit more size
+            else threshold *= 1.0f - LOD_HYSTERESIS; // Coarsening needs a bit less
+        }
+        if (pixels > threshold) return level;
+    }
+    return BIN_DETAIL_COUNT - 1;
+}
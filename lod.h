@@ -0,0 +1,16 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include "camera.h"
+
+// Projected bounding-sphere radius, in pixels, above which each finer level is used
+#define LOD_HIGH_PIXELS   60.0f
+#define LOD_MEDIUM_PIXELS 15.0f
+#define LOD_HYSTERESIS    0.2f // Fraction a size must cross a threshold by before switching
+
+// Radius in pixels of a sphere seen through camera on a viewport viewportHeight pixels tall
+float lodProjectedRadius(const Camera* camera, int viewportHeight, const float center[3], float radius);
+// Detail level (BinDetail) for a projected size; current < 0 selects without hysteresis
+int lodSelect(int current, float pixels);
+
+#endif
@@ -1,8 +1,42 @@
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <GL/glut.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "benchmark.h"
+#include "bin.h"
+#include "camera.h"
+#include "capture.h"
+#include "classify.h"
+#include "culling.h"
+#include "fleet.h"
+#include "fleetfile.h"
+#include "geomtables.h"
+#include "gl_ext.h"
+#include "headless.h"
+#include "input.h"
+#include "image.h"
+#include "lanes.h"
+#include "lod.h"
+#include "mesh.h"
+#include "meshcache.h"
+#include "picking.h"
+#include "pipeline.h"
+#include "primitives.h"
+#include "profiler.h"
+#include "renderqueue.h"
+#include "routes.h"
+#include "scenegraph.h"
+#include "sim.h"
+#include "softraster.h"
+#include "telemetry.h"
+#include "viewwall.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -12,33 +46,127 @@
 #define WIDTH 800
 #define HEIGHT 600
 
-// Bin & Lid constants
-#define LID_THICKNESS 0.15f
-#define RIM_HEIGHT    0.2f
+#define FILL_REPORT_SECONDS 3.0f // Each fleet bin reports its fill this often
+#define FILL_REPORT_STRIDE  7919 // Prime step through the fleet, so consecutive reports come from scattered bins
+#define LID_DEPOSITS_PER_SECOND 20.0f // Lids opened across the fleet while deposits run
+#define LID_DEPOSIT_HOLD        0.5f  // Seconds a deposit keeps its lid fully open
+#define ROUTE_REPLAN_SECONDS    1.0f  // Collection routes follow fleet changes at most this often
+#define ROUTE_OVERLAY_HEIGHT    0.05f // Route lines float this far over the ground
 
 // Camera (mouse interaction)
 float cameraYaw = 0.0f;    // Horizontal orbit angle (degrees)
 float cameraPitch = 20.0f; // Vertical orbit angle (degrees)
 float cameraDistance = 20.0f;
+float maxCameraDistance = 50.0f;
+float farPlane = 100.0f;
+int windowWidth = WIDTH, windowHeight = HEIGHT;
+Camera camera; // Parameters of the last gluPerspective/gluLookAt
 int lastMouseX, lastMouseY;
 int mouseButton = -1;
+int pressX, pressY;                 // Where the left button went down; released in place it selects
+PickResult hover = {-1, -1, 0.0f};  // Bin and lid under the cursor, outlined every frame
+PickStats pickStats;
 
 // Global variables
 GLfloat noEmission[4] = {0.0f, 0.0f, 0.0f, 1.0f};
 
+// Retained-mode bin geometry, recorded once per detail level from the draw functions below
+Mesh binMeshes[BIN_DETAIL_COUNT][BIN_PART_COUNT];
+Mesh fleetMeshes[BIN_DETAIL_COUNT][BIN_PART_COUNT]; // Same parts with white lids, tinted per instance
+Mesh* recordParts = binMeshes[BIN_DETAIL_HIGH];
+int binDetail = BIN_DETAIL_HIGH; // Level the bin draw functions produce
+bool useRetainedMode = true;
+bool useRenderQueue = true; // Sort retained draws by state and skip redundant material/matrix calls
+const char* meshCachePath = MESH_CACHE_PATH; // NULL records the meshes every launch (--no-mesh-cache)
+
+// Fleet scene (many bins drawn with instancing)
+bool fleetMode = false;
+bool useInstancing = true;
+bool useFrustumCulling = true;
+bool useLevelOfDetail = true;
+
+// Profiling (P toggles, D dumps; --profile FILE records from startup and dumps on exit)
+const char* profilePath = NULL;
+const char* capturePath = "capture.y4m"; // O toggles video capture to here
+bool captureAtLaunch = false;            // --capture FILE: from the first frame, including --benchmark runs
+int fleetSize = 1000;
+int wallViews = WALL_DEFAULT_VIEWS; // Views on the monitoring wall when N turns it on (--wall N)
+const char* fleetPath = NULL; // Fleet file mapped in place of the generated grid (--load-fleet)
+FleetStats loopedStats; // Counters for drawFleetLooped(), which bypasses fleetDraw()
+bool fillReports = false; // Fleet bins report fill levels while true (redraws continuously)
+bool lidDeposits = false; // Random fleet lids swing open and shut while true (redraws continuously)
+bool showRoutes = false;  // Collection routes over the fleet's ground (U toggles, --routes)
+int routeThreadCount = 0; // Route planner threads, 0 for one per core (--route-threads N)
+float groundHalfSize = 20.0f;
+bool useSoftRaster = false; // Draw with the CPU rasterizer and show its image (B toggles, --soft)
+int softThreadCount = 0;    // Rasterizer threads, 0 for one per core (--soft-threads N)
+bool softStarted = false;
+SoftFramebuffer softFrame;
+Mesh softGround; // drawGround()'s quad for the CPU rasterizer
+std::chrono::steady_clock::time_point launchTime = std::chrono::steady_clock::now(); // Set before main() runs
+
 // Define bin colors
 GLfloat recyclableBinColor[3] = {0.0f, 0.7f, 0.3f}; // Brighter green
 GLfloat organicBinColor[3] = {1.0f, 0.6f, 0.0f};    // Brighter orange
 GLfloat hazardousBinColor[3] = {0.9f, 0.1f, 0.1f};  // Brighter red
+const GLfloat* binLidColors[BIN_COMPARTMENT_COUNT] = {recyclableBinColor, organicBinColor, hazardousBinColor};
+float lidOpenAngles[BIN_COMPARTMENT_COUNT] = {0.0f, 0.0f, 0.0f}; // Degrees, swung up about the back edge
+SceneGraph binGraph; // The single bin's parts; its hinges follow lidOpenAngles
+BinNodes binNodes;
+
+// Two lights, set by init() under an identity modelview so the positions are in eye space
+GLfloat backgroundColor[4] = {0.8f, 0.8f, 0.9f, 1.0f}; // Light blue-gray
+GLfloat lightAmbient[2][4] = {{0.2f, 0.2f, 0.2f, 1.0f}, {0.1f, 0.1f, 0.1f, 1.0f}};
+GLfloat lightDiffuse[2][4] = {{0.7f, 0.7f, 0.7f, 1.0f}, {0.3f, 0.3f, 0.3f, 1.0f}};
+GLfloat lightSpecular[2][4] = {{1.0f, 1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f, 1.0f}}; // GL_LIGHT1 keeps its default
+GLfloat lightPosition[2][4] = {{-5.0f, 15.0f, 10.0f, 1.0f}, {10.0f, 10.0f, -5.0f, 1.0f}};
 
 // Function prototypes
 void init();
 void display();
+void renderScene();
+void drawView(const Camera* view, int viewportHeight, WallView* wallView);
+void drawWallView(WallView* view);
+void setSoftRaster(bool enabled);
+void drawSoftView(const Camera* view);
+void blitSoftFrame();
+void printSoftStats();
+uint64_t sceneKey();
 void reshape(int width, int height);
-void drawGarbageBin();
+void drawGarbageBin(const GLfloat* const lidColors[BIN_COMPARTMENT_COUNT]);
+void buildBinMeshes();
+uint64_t binMeshKey();
+void reportFirstFrame();
+void recordBinMeshes(Mesh parts[BIN_PART_COUNT], const GLfloat* const lidColors[BIN_COMPARTMENT_COUNT], int detail);
+void drawBinMeshes(int detail, const SceneGraph* graph, const BinNodes* nodes);
+int detailSegments(int segments);
+void beginBinPart(int part);
+void compareRenderPaths(int frames);
+void layoutFleet(int count, std::vector<BinInstance>* bins);
+void buildFleet(int count);
+bool loadFleet(const char* path);
+void fitGroundToFleet();
+void setFleetMode(bool enabled);
+void drawFleetLooped(const std::vector<unsigned> visible[BIN_DETAIL_COUNT]);
+void moveRandomBins(int count);
+void reportFleetFill(float elapsed);
+void depositRandomItems(float elapsed);
+void updateRoutes(bool force);
+void drawRouteOverlay();
+void drawFillGauges(const GLfloat fill[BIN_COMPARTMENT_COUNT]);
+void printFrameStats();
+const FleetStats* frameDrawStats();
+int runBenchmark(const std::vector<int>& sizes, int frames, const char* outputPath, int width, int height);
+int runHeadless(const std::vector<CameraPose>& poses, const char* outputPattern, int width, int height,
+                bool startInFleet);
+int runTelemetryBenchmark(int rate, float seconds);
+std::string frameOutputPath(const char* pattern, int index);
 void drawUnifiedBinContainer(float width, float height, float depth, const GLfloat color[3]);
 void drawBinDivider(float x, float y, float z, float height, float depth, const GLfloat color[3]);
 void drawLid(float width, float depth, const GLfloat color[3]);
+void swingLid(int compartment, float depth);
+void updateLidAngles(float elapsed);
+void drawCompartmentCounts();
 void drawCylinder(float radius, float height, int segments);
 void drawRecycleSymbol(float x, float y, float z, float size);
 void drawLeafSymbol(float x, float y, float z, float size);
@@ -47,84 +175,773 @@ void drawCompartmentLabels();
 void drawGround();
 void mouse(int button, int state, int x, int y);
 void motion(int x, int y);
+void passiveMotion(int x, int y);
+void pickAt(int x, int y, PickResult* result);
+void printPickedBin(const PickResult& pick);
+void drawPickHighlight();
+void toggleCapture();
 void keyboard(unsigned char key, int x, int y);
+void applyPendingInput(const PendingInput& input);
 
 // Initialize OpenGL
 void init() {
-    glClearColor(0.8f, 0.8f, 0.9f, 1.0f); // Light blue-gray background
+    glClearColor(backgroundColor[0], backgroundColor[1], backgroundColor[2], backgroundColor[3]);
     glEnable(GL_DEPTH_TEST);
 
-    // Enhanced lighting setup
+    // A bright key light with full specular, and a dimmer fill light from the opposite side
     glEnable(GL_LIGHTING);
-    glEnable(GL_LIGHT0);
-
-    // Increase ambient light to make objects more visible
-    GLfloat ambientLight[] = {0.2f, 0.2f, 0.2f, 1.0f}; // Brighter ambient light
-    GLfloat diffuseLight[] = {0.7f, 0.7f, 0.7f, 1.0f}; // Brighter diffuse light
-    GLfloat specularLight[] = {1.0f, 1.0f, 1.0f, 1.0f}; // Full intensity specular
-    GLfloat position[] = {-5.0f, 15.0f, 10.0f, 1.0f}; // Better position
-
-    glLightfv(GL_LIGHT0, GL_AMBIENT, ambientLight);
-    glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuseLight);
-    glLightfv(GL_LIGHT0, GL_SPECULAR, specularLight);
-    glLightfv(GL_LIGHT0, GL_POSITION, position);
-
-    // Add a second light source from a different angle
-    glEnable(GL_LIGHT1);
-    GLfloat ambientLight2[] = {0.1f, 0.1f, 0.1f, 1.0f};
-    GLfloat diffuseLight2[] = {0.3f, 0.3f, 0.3f, 1.0f};
-    GLfloat position2[] = {10.0f, 10.0f, -5.0f, 1.0f}; // Light from opposite direction
-
-    glLightfv(GL_LIGHT1, GL_AMBIENT, ambientLight2);
-    glLightfv(GL_LIGHT1, GL_DIFFUSE, diffuseLight2);
-    glLightfv(GL_LIGHT1, GL_POSITION, position2);
+    SoftLight softLights[2];
+    for (int i = 0; i < 2; i++) {
+        GLenum light = GL_LIGHT0 + i;
+        glEnable(light);
+        glLightfv(light, GL_AMBIENT, lightAmbient[i]);
+        glLightfv(light, GL_DIFFUSE, lightDiffuse[i]);
+        glLightfv(light, GL_SPECULAR, lightSpecular[i]);
+        glLightfv(light, GL_POSITION, lightPosition[i]);
+        memcpy(softLights[i].ambient, lightAmbient[i], sizeof(softLights[i].ambient));
+        memcpy(softLights[i].diffuse, lightDiffuse[i], sizeof(softLights[i].diffuse));
+        memcpy(softLights[i].specular, lightSpecular[i], sizeof(softLights[i].specular));
+        memcpy(softLights[i].position, lightPosition[i], sizeof(softLights[i].position));
+    }
+    GLfloat modelAmbient[4];
+    glGetFloatv(GL_LIGHT_MODEL_AMBIENT, modelAmbient);
+    softSetLights(softLights, 2, modelAmbient);
 
     // Enable color tracking
     glEnable(GL_COLOR_MATERIAL);
     glColorMaterial(GL_FRONT, GL_AMBIENT_AND_DIFFUSE);
 
-    // Enable normalization of normal vectors
-    glEnable(GL_NORMALIZE);
-
     // Enable line smoothing for better looking lines
     glEnable(GL_LINE_SMOOTH);
     glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+
+    // Record the static bin once and keep it on the GPU
+    loadGLExtensions();
+    profilerInit();
+
+    // The GLSL pipeline relies on recorded normals being unit length; fixed-function needs them renormalized
+    if (!pipelineInit()) glEnable(GL_NORMALIZE);
+    buildBinMeshes();
+
+    static const float origin[3] = {0.0f, 0.0f, 0.0f};
+    GLfloat placement[16];
+    binPlacementMatrix(origin, 0.0f, placement);
+    sceneClear(&binGraph);
+    sceneAddBin(&binGraph, -1, placement, &binNodes);
+    sceneUpdate(&binGraph);
 }
 
 // Main display function
 void display() {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    PendingInput input;
+    inputBeginFrame(&input);
+    applyPendingInput(input);
+
+    // Real time since the last frame drives the waste simulation when it is not on its worker thread
+    static std::chrono::steady_clock::time_point lastFrame = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    float elapsed = std::chrono::duration<float>(now - lastFrame).count();
+    lastFrame = now;
+
+    profilerBeginFrame();
+    simStep(elapsed);
+    if (fleetMode && fillReports) reportFleetFill(elapsed);
+    if (fleetMode && lidDeposits) depositRandomItems(elapsed);
+    if (fleetMode && showRoutes) updateRoutes(false);
+    if (telemetryActive()) {
+        PROFILE_SCOPE("telemetry");
+        telemetryDrain(TELEMETRY_DRAIN_MAX);
+    }
+    updateLidAngles(elapsed);
+    renderScene();
+    if (!fleetMode && simCount() > 0 && !wallActive()) drawCompartmentCounts();
+    if (profilerEnabled) profilerDrawOverlay(windowWidth, windowHeight);
+    if (captureActive()) {
+        PROFILE_SCOPE("capture");
+        captureFrame();
+    }
+    {
+        PROFILE_SCOPE("swap");
+        glutSwapBuffers();
+    }
+    profilerEndFrame();
+    inputEndFrame();
+    reportFirstFrame();
+
+    // Keep frames coming while measuring, simulating, receiving fill reports or telemetry, swinging lids or capturing
+    bool lidsMoving = fleetMode && (lidDeposits || fleetLidBins() > 0);
+    bool reporting = (fleetMode && fillReports) || telemetryActive();
+    if (profilerEnabled || simEnabled() || reporting || lidsMoving || captureActive()) {
+        inputRequestRedraw();
+    }
+}
 
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+// Draw one frame into the back buffer
+void renderScene() {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // Spherical-to-Cartesian camera orbit calculation (look at bin center)
     float camX = cameraDistance * cosf(cameraPitch * M_PI / 180.0f) * sinf(cameraYaw * M_PI / 180.0f);
     float camY = cameraDistance * sinf(cameraPitch * M_PI / 180.0f);
     float camZ = cameraDistance * cosf(cameraPitch * M_PI / 180.0f) * cosf(cameraYaw * M_PI / 180.0f);
 
+    camera.eye[0] = camX;
+    camera.eye[1] = camY + 2.0f; // Y+2 centers the bin in view
+    camera.eye[2] = camZ;
+    camera.target[0] = 0.0f;
+    camera.target[1] = 2.0f;
+    camera.target[2] = 0.0f;
+    camera.up[0] = 0.0f;
+    camera.up[1] = 1.0f;
+    camera.up[2] = 0.0f;
+
+    if (wallActive()) {
+        wallSetOrbitCamera(&camera);
+        wallRender(drawWallView, sceneKey());
+    } else if (useSoftRaster) {
+        drawSoftView(&camera);
+        blitSoftFrame();
+    } else {
+        drawView(&camera, windowHeight, NULL);
+    }
+}
+
+// Draw the scene through view, with the projection and viewport already set.
+// A wall view keeps its own level-of-detail history and culling counters.
+void drawView(const Camera* view, int viewportHeight, WallView* wallView) {
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
     gluLookAt(
-        camX, camY + 2.0f, camZ,  // Camera position (Y+2 centers the bin in view)
-        0.0f, 2.0f, 0.0f,         // Look at
-        0.0f, 1.0f, 0.0f          // Up
+        view->eye[0], view->eye[1], view->eye[2],          // Camera position
+        view->target[0], view->target[1], view->target[2], // Look at
+        view->up[0], view->up[1], view->up[2]              // Up
     );
 
     // Draw ground
     drawGround();
 
+    // The ground and last frame's overlay set materials directly
+    renderStateReset();
+    renderStatsReset();
+
+    // Slow frames during a drag trade detail for responsiveness
+    bool interactive = inputUseInteractiveDetail();
+
     // Draw bin system
-    drawGarbageBin();
+    if (fleetMode) {
+        Frustum frustum;
+        frustumFromCamera(view, &frustum);
+        const std::vector<unsigned>& visible = fleetCull(useFrustumCulling ? &frustum : NULL);
+        // Selecting detail for a quarter-height viewport makes every bin look 4x smaller
+        const Camera* lodCamera = useLevelOfDetail || interactive ? view : NULL;
+        int lodHeight = interactive ? viewportHeight / 4 : viewportHeight;
+        const std::vector<unsigned>* levels = wallView
+                                                  ? fleetSelectDetail(visible, lodCamera, lodHeight, &wallView->detail)
+                                                  : fleetSelectDetail(visible, lodCamera, lodHeight);
+        if (wallView) wallView->cull = *fleetCullStats();
+        if (useInstancing && glHasInstancing) {
+            fleetDraw(levels);
+        } else {
+            drawFleetLooped(levels);
+        }
+    } else if (useRetainedMode) {
+        PROFILE_SCOPE("drawBinMeshes");
+        drawBinMeshes(interactive ? BIN_DETAIL_MEDIUM : BIN_DETAIL_HIGH, &binGraph, &binNodes);
+    } else {
+        // Immediate drawing scales its normals, so it needs renormalizing under either pipeline
+        if (pipelineActive()) glEnable(GL_NORMALIZE);
+        drawGarbageBin(binLidColors);
+        if (pipelineActive()) glDisable(GL_NORMALIZE);
+    }
+
+    // Waste items falling into the single bin, and how full they have made it
+    if (!fleetMode && simCount() > 0) {
+        simDraw(binLidColors);
+        GLfloat fill[BIN_COMPARTMENT_COUNT];
+        simFillLevels(fill);
+        drawFillGauges(fill);
+    }
+    drawPickHighlight();
+}
+
+void drawWallView(WallView* view) {
+    drawView(&view->camera, view->height, view);
+}
+
+void setSoftRaster(bool enabled) {
+    if (enabled && !softStarted) {
+        softInit(softThreadCount);
+        softStarted = true;
+    }
+    useSoftRaster = enabled;
+}
+
+// The same scene as drawView() rasterized on the CPU into softFrame: ground and bin
+// meshes only, without line highlights, gauges, falling items or the pick outline
+void drawSoftView(const Camera* view) {
+    PROFILE_SCOPE("drawSoftView");
+    static const GLfloat identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    softBegin(&softFrame, windowWidth, windowHeight, backgroundColor, view);
+
+    if (softGround.vertices.empty() || softGround.vertices[0].position[0] != -groundHalfSize) {
+        static const float corners[4][2] = {{-1.0f, -1.0f}, {-1.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, -1.0f}};
+        MeshMaterial ground = {{0.6f, 0.6f, 0.6f, 1.0f}, {0.6f, 0.6f, 0.6f, 1.0f}, {0.0f, 0.0f, 0.0f, 1.0f},
+                               {0.0f, 0.0f, 0.0f, 1.0f}, 0.0f};
+        softGround = Mesh();
+        for (int i = 0; i < 4; i++) {
+            MeshVertex vertex = {{corners[i][0] * groundHalfSize, 0.0f, corners[i][1] * groundHalfSize},
+                                 {0.0f, 1.0f, 0.0f}};
+            softGround.vertices.push_back(vertex);
+        }
+        static const GLuint quad[6] = {0, 1, 2, 0, 2, 3};
+        softGround.indices.assign(quad, quad + 6);
+        softGround.materials.push_back(ground);
+        MeshBatch batch = {GL_TRIANGLES, 0, 1.0f, 0, 6};
+        softGround.batches.push_back(batch);
+    }
+    softDrawMesh(&softGround, identity);
+
+    bool interactive = inputUseInteractiveDetail();
+    if (fleetMode) {
+        Frustum frustum;
+        frustumFromCamera(view, &frustum);
+        const std::vector<unsigned>& visible = fleetCull(useFrustumCulling ? &frustum : NULL);
+        const Camera* lodCamera = useLevelOfDetail || interactive ? view : NULL;
+        const std::vector<unsigned>* levels =
+            fleetSelectDetail(visible, lodCamera, interactive ? windowHeight / 4 : windowHeight);
+        const std::vector<BinInstance>& bins = fleetInstances();
+        for (int level = 0; level < BIN_DETAIL_COUNT; level++) {
+            for (size_t i = 0; i < levels[level].size(); i++) {
+                const BinInstance& bin = bins[levels[level][i]];
+                const BinNodes* nodes = fleetBinNodes(levels[level][i]);
+                GLfloat placement[16];
+                binPlacementMatrix(bin.position, bin.yaw, placement);
+                for (int part = 0; part < BIN_PART_COUNT; part++) {
+                    softDrawMesh(&binMeshes[level][part],
+                                 nodes ? sceneWorld(fleetSceneGraph(), nodes->parts[part]) : placement);
+                }
+            }
+        }
+    } else {
+        int detail = interactive ? BIN_DETAIL_MEDIUM : BIN_DETAIL_HIGH;
+        for (int part = 0; part < BIN_PART_COUNT; part++) {
+            softDrawMesh(&binMeshes[detail][part], sceneWorld(&binGraph, binNodes.parts[part]));
+        }
+    }
+    softEnd();
+}
+
+// Show softFrame in the window, replacing what is there
+void blitSoftFrame() {
+    PROFILE_SCOPE("blitSoftFrame");
+    glPushAttrib(GL_ENABLE_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    glRasterPos2f(-1.0f, -1.0f);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, softFrame.stride);
+    glDrawPixels(softFrame.width, softFrame.height, GL_RGBA, GL_UNSIGNED_BYTE, &softFrame.color[0]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+}
+
+void printSoftStats() {
+    const SoftStats* s = softStats();
+    printf("CPU rasterizer: %d threads, %s fill, %dx%d pixel tiles\n", s->threads, laneKernelName(s->kernel),
+           SOFT_TILE_SIZE, SOFT_TILE_SIZE);
+    printf("  Triangles:    %lu in %lu draws, %lu culled, %lu clipped, %lu tile entries\n", s->triangles, s->draws,
+           s->trianglesCulled, s->trianglesClipped, s->tileEntries);
+    printf("  Pixels:       %lu written\n", s->pixelsWritten);
+    printf("  Time:         %.2f ms vertices and binning, %.2f ms filling tiles\n", s->vertexMs, s->rasterMs);
+}
+
+// Everything besides the camera that decides what a view shows; wall views whose
+// camera and key match their last draw show that image again
+uint64_t sceneKey() {
+    static unsigned long simFrame = 0;
+    unsigned long generation = fleetMode ? fleetGeneration() : 0;
+    bool flags[] = {fleetMode, useRetainedMode, useInstancing, useFrustumCulling, useLevelOfDetail,
+                    inputUseInteractiveDetail()};
+    int picked[] = {hover.bin, hover.lid};
+    uint64_t key = meshCacheHash(&generation, sizeof(generation));
+    key = meshCacheHash(flags, sizeof(flags), key);
+    key = meshCacheHash(picked, sizeof(picked), key);
+    key = meshCacheHash(lidOpenAngles, sizeof(lidOpenAngles), key);
+    key = meshCacheHash(&groundHalfSize, sizeof(groundHalfSize), key);
+    // Items falling into the single bin move every frame while the simulation runs
+    if (!fleetMode && simEnabled()) {
+        simFrame++;
+        key = meshCacheHash(&simFrame, sizeof(simFrame), key);
+    }
+    return key;
+}
+
+// Time the same scene through the immediate and retained paths
+// (per-bin loop and instancing in fleet mode)
+void compareRenderPaths(int frames) {
+    bool savedMode = fleetMode ? useInstancing : useRetainedMode;
+    bool* mode = fleetMode ? &useInstancing : &useRetainedMode;
+    double averageMs[2];
+
+    for (int pass = 0; pass < 2; pass++) {
+        *mode = pass == 1;
+        renderScene();
+        glFinish();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+            renderScene();
+            glFinish();
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        averageMs[pass] = elapsed.count() / frames;
+    }
+    *mode = savedMode;
+
+    if (fleetMode) {
+        printf("Frame time over %d frames, %d bins:\n", frames, fleetSize);
+        printf("  Per-bin loop: %.3f ms\n", averageMs[0]);
+        printf("  Instanced:    %.3f ms (%.2fx, %u draw calls)\n", averageMs[1], averageMs[0] / averageMs[1],
+               fleetStats()->drawCalls);
+    } else {
+        printf("Frame time over %d frames:\n", frames);
+        printf("  Immediate mode: %.3f ms\n", averageMs[0]);
+        printf("  Retained mode:  %.3f ms (%.2fx)\n", averageMs[1], averageMs[0] / averageMs[1]);
+    }
+}
+
+// Lay out count bins in a grid of streets, alternate rows facing each other
+void layoutFleet(int count, std::vector<BinInstance>* bins) {
+    const float spacingX = 16.0f;
+    const float spacingZ = 10.0f;
+    int columns = (int)ceilf(sqrtf((float)count));
+    int rows = (count + columns - 1) / columns;
+
+    bins->resize(count);
+    for (int i = 0; i < count; i++) {
+        BinInstance& bin = (*bins)[i];
+        int column = i % columns;
+        int row = i / columns;
+        bin.position[0] = (column - (columns - 1) * 0.5f) * spacingX;
+        bin.position[1] = 0.0f;
+        bin.position[2] = (row - (rows - 1) * 0.5f) * spacingZ;
+        bin.yaw = (row % 2) ? 180.0f : 0.0f;
+        for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+            for (int k = 0; k < 3; k++) bin.lidColors[c][k] = binLidColors[c][k];
+            // Bins start part full, differently for each compartment
+            bin.fill[c] = (((unsigned)i * 2654435761u) >> (8 * c) & 255) / 255.0f;
+        }
+    }
+}
+
+void buildFleet(int count) {
+    std::vector<BinInstance> bins;
+    layoutFleet(count, &bins);
+    fleetSetInstances(bins);
+    fleetSize = count;
+    fitGroundToFleet();
+    printf("Fleet: %d bins in a grid\n", count);
+}
+
+// Map a fleet file and hand its records to the fleet, which copies them
+bool loadFleet(const char* path) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    FleetFile file;
+    if (!fleetFileOpen(path, &file)) return false;
+    if (file.count == 0) {
+        printf("%s: no bins\n", path);
+        fleetFileClose(&file);
+        return false;
+    }
+    std::chrono::steady_clock::time_point mapped = std::chrono::steady_clock::now();
+    fleetSetInstances(file.bins, file.count);
+    fleetSize = (int)file.count;
+    fleetFileClose(&file);
+    fitGroundToFleet();
+    std::chrono::steady_clock::time_point ready = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double, std::milli> mapMs = mapped - start;
+    std::chrono::duration<double, std::milli> setupMs = ready - mapped;
+    printf("Fleet: %d bins from %s (mapped in %.2f ms, culling and instance data in %.2f ms)\n", fleetSize, path,
+           mapMs.count(), setupMs.count());
+    return true;
+}
+
+// Size the ground to cover every bin with a margin of street around the edge
+void fitGroundToFleet() {
+    const std::vector<BinInstance>& bins = fleetInstances();
+    float extent = 0.0f;
+    for (size_t i = 0; i < bins.size(); i++) {
+        float x = fabsf(bins[i].position[0]);
+        float z = fabsf(bins[i].position[2]);
+        if (x > extent) extent = x;
+        if (z > extent) extent = z;
+    }
+    groundHalfSize = extent + BIN_TOTAL_WIDTH + 16.0f;
+}
+
+// Switch between the single bin and the fleet, sizing camera range and ground to fit
+void setFleetMode(bool enabled) {
+    fleetMode = enabled;
+    hover.bin = -1;
+    if (fleetMode) {
+        if (fleetInstances().empty() && !(fleetPath && loadFleet(fleetPath))) buildFleet(fleetSize);
+        if (showRoutes) updateRoutes(true);
+        maxCameraDistance = groundHalfSize * 2.0f;
+        farPlane = maxCameraDistance + groundHalfSize * 2.0f;
+    } else {
+        groundHalfSize = 20.0f;
+        maxCameraDistance = 50.0f;
+        farPlane = 100.0f;
+    }
+    if (cameraDistance > maxCameraDistance) cameraDistance = maxCameraDistance;
+    reshape(windowWidth, windowHeight);
+}
+
+// Fallback without instancing: one retained bin per fleet entry (lids keep their default colors)
+void drawFleetLooped(const std::vector<unsigned> visible[BIN_DETAIL_COUNT]) {
+    PROFILE_SCOPE("drawFleetLooped");
+    memset(&loopedStats, 0, sizeof(loopedStats));
+    const std::vector<BinInstance>& bins = fleetInstances();
+    if (useRenderQueue) renderQueueBegin();
+    for (int level = 0; level < BIN_DETAIL_COUNT; level++) {
+        unsigned long count = visible[level].size();
+        for (int part = 0; part < BIN_PART_COUNT; part++) {
+            loopedStats.drawCalls += (unsigned)(binMeshes[level][part].batches.size() * count);
+            loopedStats.verticesDrawn += binMeshes[level][part].indices.size() * count;
+        }
+        loopedStats.instancesPerDetail[level] = count;
+        loopedStats.instancesDrawn += count;
+
+        for (size_t i = 0; i < visible[level].size(); i++) {
+            const BinInstance& bin = bins[visible[level][i]];
+            // Bins with a lid open or moving have scene graph nodes, which already include their placement
+            const BinNodes* nodes = fleetBinNodes(visible[level][i]);
+            if (useRenderQueue) {
+                // Translate, then rotate about Y, as the glTranslatef/glRotatef pair below
+                GLfloat transform[16];
+                binPlacementMatrix(bin.position, bin.yaw, transform);
+                for (int part = 0; part < BIN_PART_COUNT; part++) {
+                    renderQueueSubmit(&binMeshes[level][part],
+                                      nodes ? sceneWorld(fleetSceneGraph(), nodes->parts[part]) : transform);
+                }
+                continue;
+            }
+            if (nodes) {
+                drawBinMeshes(level, fleetSceneGraph(), nodes);
+                continue;
+            }
+            glPushMatrix();
+            glTranslatef(bin.position[0], bin.position[1], bin.position[2]);
+            glRotatef(bin.yaw, 0.0f, 1.0f, 0.0f);
+            drawBinMeshes(level, NULL, NULL);
+            glPopMatrix();
+        }
+    }
+    if (useRenderQueue) {
+        renderQueueFlush();
+        renderStateMaterialfv(GL_EMISSION, noEmission);
+    }
+
+    // Fill gauges, skipped at low detail like the instanced path
+    for (int level = BIN_DETAIL_HIGH; level < BIN_DETAIL_LOW; level++) {
+        for (size_t i = 0; i < visible[level].size(); i++) {
+            const BinInstance& bin = bins[visible[level][i]];
+            glPushMatrix();
+            glTranslatef(bin.position[0], bin.position[1], bin.position[2]);
+            glRotatef(bin.yaw, 0.0f, 1.0f, 0.0f);
+            drawFillGauges(bin.fill);
+            glPopMatrix();
+            loopedStats.drawCalls++;
+        }
+    }
+}
+
+// Fill gauges on the front of one bin, in bin space
+void drawFillGauges(const GLfloat fill[BIN_COMPARTMENT_COUNT]) {
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_COLOR_MATERIAL);
+    glBegin(GL_QUADS);
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        float left = FILL_GAUGE_LEFT(c), right = FILL_GAUGE_RIGHT(c);
+        float level = BIN_FLOOR_Y + (BIN_LID_Y - BIN_FLOOR_Y) * fill[c];
+        GLfloat color[3];
+        fleetFillColor(fill[c], color);
+
+        glColor3f(0.25f, 0.25f, 0.25f);
+        glVertex3f(left, BIN_FLOOR_Y, BIN_FRONT_Z + 0.01f);
+        glVertex3f(right, BIN_FLOOR_Y, BIN_FRONT_Z + 0.01f);
+        glVertex3f(right, BIN_LID_Y, BIN_FRONT_Z + 0.01f);
+        glVertex3f(left, BIN_LID_Y, BIN_FRONT_Z + 0.01f);
+        glColor3fv(color);
+        glVertex3f(left, BIN_FLOOR_Y, BIN_FRONT_Z + 0.02f);
+        glVertex3f(right, BIN_FLOOR_Y, BIN_FRONT_Z + 0.02f);
+        glVertex3f(right, level, BIN_FRONT_Z + 0.02f);
+        glVertex3f(left, level, BIN_FRONT_Z + 0.02f);
+    }
+    glEnd();
+    glPopAttrib();
+}
+
+// Synthetic fill reports: every bin once per FILL_REPORT_SECONDS, in a
+// scattered order. Compartments creep up and are emptied once full.
+void reportFleetFill(float elapsed) {
+    static float reportCarry = 0.0f;
+    static unsigned long reportCursor = 0;
+    const std::vector<BinInstance>& bins = fleetInstances();
+    if (bins.empty()) return;
+    unsigned long count = bins.size();
+    unsigned long stride = count % FILL_REPORT_STRIDE ? FILL_REPORT_STRIDE : 1;
+
+    reportCarry += count * elapsed / FILL_REPORT_SECONDS;
+    unsigned long due = (unsigned long)reportCarry;
+    if (due > count) due = count;
+    reportCarry -= (float)(unsigned long)reportCarry;
+    for (unsigned long r = 0; r < due; r++) {
+        unsigned index = (unsigned)(reportCursor++ * stride % count);
+        GLfloat fill[BIN_COMPARTMENT_COUNT];
+        for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+            fill[c] = bins[index].fill[c] + (rand() % 100) * 0.0008f;
+            if (fill[c] > 1.0f) fill[c] = 0.0f; // Collected
+        }
+        fleetSetFill(index, fill);
+    }
+}
+
+// Synthetic deposits: a random lid somewhere in the fleet swings open, holds, then shuts
+void depositRandomItems(float elapsed) {
+    static float depositCarry = 0.0f;
+    const std::vector<BinInstance>& bins = fleetInstances();
+    if (bins.empty()) return;
+    depositCarry += LID_DEPOSITS_PER_SECOND * elapsed;
+    for (; depositCarry >= 1.0f; depositCarry -= 1.0f) {
+        fleetOpenLid((unsigned)(rand() % bins.size()), rand() % BIN_COMPARTMENT_COUNT, LID_DEPOSIT_HOLD);
+    }
+}
+
+// Replan collection routes once the fleet has changed, patching the last plan rather than starting over
+void updateRoutes(bool force) {
+    static unsigned long plannedGeneration = 0;
+    static std::chrono::steady_clock::time_point plannedAt;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (!force && (fleetGeneration() == plannedGeneration ||
+                   std::chrono::duration<float>(now - plannedAt).count() < ROUTE_REPLAN_SECONDS)) {
+        return;
+    }
+    PROFILE_SCOPE("routes");
+    routesPlan(fleetInstances(), true);
+    plannedGeneration = fleetGeneration();
+    plannedAt = now;
+}
+
+// Nudge some bins to exercise incremental culling updates
+void moveRandomBins(int count) {
+    const std::vector<BinInstance>& bins = fleetInstances();
+    if (bins.empty()) return;
+    for (int i = 0; i < count; i++) {
+        unsigned index = (unsigned)(rand() % bins.size());
+        GLfloat position[3] = {bins[index].position[0] + (rand() % 9 - 4), bins[index].position[1],
+                               bins[index].position[2] + (rand() % 9 - 4)};
+        fleetMoveInstance(index, position, bins[index].yaw + (rand() % 31 - 15));
+    }
+    printf("Moved %d bins\n", count);
+}
 
-    glutSwapBuffers();
+// Counters from the last rendered frame
+void printFrameStats() {
+    if (!fleetMode) {
+        printf("Frame stats are collected in fleet mode\n");
+        return;
+    }
+    const CullStats* cull = fleetCullStats();
+    const FleetStats* draw = frameDrawStats();
+    printf("Frustum culling: %s, level of detail: %s\n", useFrustumCulling ? "on" : "off",
+           useLevelOfDetail ? "on" : "off");
+    printf("  Nodes tested: %lu\n", cull->nodesTested);
+    printf("  Bins culled:  %lu\n", cull->binsCulled);
+    printf("  Bins drawn:   %lu\n", cull->binsDrawn);
+    printf("  Bins by detail (high/medium/low): %lu / %lu / %lu\n", draw->instancesPerDetail[BIN_DETAIL_HIGH],
+           draw->instancesPerDetail[BIN_DETAIL_MEDIUM], draw->instancesPerDetail[BIN_DETAIL_LOW]);
+    printf("  Draw calls:   %u\n", draw->drawCalls);
+    printf("  Vertices:     %lu\n", draw->verticesDrawn);
+    if (draw == fleetStats()) {
+        printf("  Fill changes: %lu bins, %u uploads covering %lu records (of %lu)\n", draw->fillChanged,
+               draw->fillUploads, draw->fillRecords, (unsigned long)fleetInstances().size());
+        printf("  Gauge runs:   %u\n", draw->gaugeRuns);
+        printf("  Open lids:    %u bins (%u visible), %lu world matrices updated\n", fleetLidBins(),
+               draw->lidBinsDrawn, draw->lidNodesUpdated);
+    }
+}
+
+// Counters from whichever fleet path drew the last frame
+const FleetStats* frameDrawStats() {
+    return useInstancing && glHasInstancing ? fleetStats() : &loopedStats;
 }
 
 // Handle window reshape
 void reshape(int width, int height) {
+    windowWidth = width;
+    windowHeight = height;
     glViewport(0, 0, width, height);
 
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
-    gluPerspective(45.0f, (float)width / (float)height, 0.1f, 100.0f);
+    camera.fovY = 45.0f;
+    camera.aspect = (float)width / (float)height;
+    camera.zNear = 0.1f;
+    camera.zFar = farPlane;
+    gluPerspective(camera.fovY, camera.aspect, camera.zNear, camera.zFar);
+    glMatrixMode(GL_MODELVIEW);
+
+    static const std::vector<BinInstance> noBins;
+    wallLayout(width, height, &camera, fleetMode ? fleetInstances() : noBins);
+}
+
+// Render each pose offscreen and write it to disk, reusing one context for the batch
+int runHeadless(const std::vector<CameraPose>& poses, const char* outputPattern, int width, int height,
+                bool startInFleet) {
+    if (!headlessCreateContext(width, height)) return 1;
+
+    init();
+    if (startInFleet) setFleetMode(true);
+    reshape(width, height);
+
+    int failures = 0;
+    std::vector<unsigned char> pixels;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < poses.size(); i++) {
+        cameraYaw = poses[i].yaw;
+        cameraPitch = poses[i].pitch;
+        cameraDistance = poses[i].distance;
+        if (cameraDistance < 5.0f) cameraDistance = 5.0f;
+        if (cameraDistance > maxCameraDistance) cameraDistance = maxCameraDistance;
+
+        profilerBeginFrame();
+        renderScene();
+        {
+            PROFILE_SCOPE("readback");
+            headlessReadPixels(width, height, &pixels);
+        }
+        profilerEndFrame();
+        if (i == 0) reportFirstFrame();
+
+        std::string path = poses[i].output.empty() ? frameOutputPath(outputPattern, (int)i) : poses[i].output;
+        if (writeImage(path.c_str(), &pixels[0], width, height)) {
+            printf("Wrote %s\n", path.c_str());
+        } else {
+            printf("Failed to write %s\n", path.c_str());
+            failures++;
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    printf("Headless: %u frames at %dx%d in %.1f ms\n", (unsigned)poses.size(), width, height, elapsed.count());
+    if (profilePath) profilerDump(profilePath);
+
+    headlessDestroyContext();
+    return failures ? 1 : 0;
+}
+
+// Time fixed orbits over each fleet size and zoom level offscreen
+int runBenchmark(const std::vector<int>& sizes, int frames, const char* outputPath, int width, int height) {
+    if (!headlessCreateContext(width, height)) return 1;
+    init();
+    reshape(width, height);
+
+    char configuration[128];
+    char renderer[64];
+    if (useSoftRaster) {
+        snprintf(renderer, sizeof(renderer), "CPU rasterizer, %d threads, %s", softThreads(),
+                 laneKernelName(softKernel()));
+    } else {
+        snprintf(renderer, sizeof(renderer), "%s", (const char*)glGetString(GL_RENDERER));
+    }
+    snprintf(configuration, sizeof(configuration), "%s, %s pipeline, culling %s, lod %s",
+             useSoftRaster ? "cpu" : useInstancing && glHasInstancing ? "instanced" : "looped", pipelineName(),
+             useFrustumCulling ? "on" : "off", useLevelOfDetail ? "on" : "off");
+    printf("Benchmark: %s, %s, %dx%d, %d frames per scenario\n", renderer, configuration, width, height, frames);
+    if (captureAtLaunch) captureStart(capturePath, width, height, 60);
+
+    std::vector<BenchmarkScenario> scenarios = benchmarkScenarios(sizes, frames);
+    std::vector<BenchmarkResult> results;
+    std::vector<BenchmarkFrame> samples;
+    for (size_t s = 0; s < scenarios.size(); s++) {
+        const BenchmarkScenario& scenario = scenarios[s];
+        if (scenario.bins != fleetSize || fleetInstances().empty()) buildFleet(scenario.bins);
+        setFleetMode(true);
+
+        samples.clear();
+        CameraPose pose;
+        for (int i = -BENCHMARK_WARMUP_FRAMES; i < scenario.frames; i++) {
+            benchmarkPose(scenario, i < 0 ? 0 : i, maxCameraDistance, &pose);
+            cameraYaw = pose.yaw;
+            cameraPitch = pose.pitch;
+            cameraDistance = pose.distance;
+
+            // glFinish makes the time cover the GPU (or llvmpipe) work, not just submission
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            renderScene();
+            if (captureActive()) captureFrame();
+            glFinish();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (i < 0) continue;
+
+            const FleetStats* draw = frameDrawStats();
+            BenchmarkFrame frame = {elapsed.count(), draw->drawCalls, draw->verticesDrawn, fleetCullStats()->binsDrawn};
+            if (useSoftRaster) {
+                frame.drawCalls = (unsigned)softStats()->draws;
+                frame.vertices = softStats()->triangles * 3;
+            }
+            samples.push_back(frame);
+        }
+        results.push_back(summarizeBenchmark(scenario, samples));
+        printf("  %s: mean %.3f ms\n", scenario.name.c_str(), results.back().meanMs);
+        fflush(stdout); // Progress for CI logs; large fleets take minutes on llvmpipe
+    }
+
+    captureStop();
+    printBenchmarkResults(results);
+    bool ok = !outputPath ||
+              writeBenchmarkJson(outputPath, results, renderer, configuration, width, height);
+    headlessDestroyContext();
+    return ok ? 0 : 1;
+}
+
+// Feed the generated fleet from a local load generator, without drawing (the meshes need a context)
+int runTelemetryBenchmark(int rate, float seconds) {
+    if (!headlessCreateContext(WIDTH, HEIGHT)) return 1;
+    init();
+    buildFleet(fleetSize);
+    benchmarkTelemetry(rate, seconds > 0.0f ? seconds : 5.0f);
+    headlessDestroyContext();
+    return 0;
+}
+
+// Replace the run of '#' in pattern with the zero-padded frame index (appended if there is none)
+std::string frameOutputPath(const char* pattern, int index) {
+    std::string path = pattern;
+    size_t first = path.find('#');
+    if (first == std::string::npos) {
+        size_t dot = path.rfind('.');
+        if (dot == std::string::npos) dot = path.size();
+        path.insert(dot, "_#");
+        first = dot + 1;
+    }
+    size_t last = path.find_first_not_of('#', first);
+    if (last == std::string::npos) last = path.size();
+
+    char number[32];
+    snprintf(number, sizeof(number), "%0*d", (int)(last - first), index);
+    return path.replace(first, last - first, number);
 }
 
 // Mouse and motion interaction
@@ -133,23 +950,177 @@ void mouse(int button, int state, int x, int y) {
         mouseButton = button;
         lastMouseX = x;
         lastMouseY = y;
+        pressX = x;
+        pressY = y;
     } else {
+        // A left click that did not orbit selects what is under it
+        if (mouseButton == GLUT_LEFT_BUTTON && abs(x - pressX) + abs(y - pressY) <= 3) {
+            PickResult pick;
+            pickAt(x, y, &pick);
+            printPickedBin(pick);
+            // A fleet lid stays open once clicked, until clicked again
+            if (fleetMode && pick.bin >= 0 && pick.lid >= 0) {
+                if (fleetLidOpen(pick.bin, pick.lid)) {
+                    fleetCloseLid(pick.bin, pick.lid);
+                } else {
+                    fleetOpenLid(pick.bin, pick.lid, -1.0f);
+                }
+                inputRequestRedraw();
+            }
+        }
         mouseButton = -1;
     }
+    inputSetDragging(mouseButton == GLUT_LEFT_BUTTON);
 }
 
+// Motion only queues the delta; the next frame applies everything that arrived before it
 void motion(int x, int y) {
-    int dx = x - lastMouseX;
-    int dy = y - lastMouseY;
     if (mouseButton == GLUT_LEFT_BUTTON) { // Orbit
-        cameraYaw += dx * 0.5f;
-        cameraPitch += dy * 0.5f;
-        if (cameraPitch > 89.0f) cameraPitch = 89.0f;
-        if (cameraPitch < -89.0f) cameraPitch = -89.0f;
+        inputQueueOrbit(x - lastMouseX, y - lastMouseY);
     }
     lastMouseX = x;
     lastMouseY = y;
-    glutPostRedisplay();
+}
+
+// Hover: re-pick on every move, redrawing only when the outlined bin or lid changes
+void passiveMotion(int x, int y) {
+    PickResult pick;
+    pickAt(x, y, &pick);
+    if (pick.bin != hover.bin || pick.lid != hover.lid) inputRequestRedraw();
+    hover = pick;
+}
+
+// Cast a ray through a window pixel with the camera of the last frame (or of the wall view under it)
+void pickAt(int x, int y, PickResult* result) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    PickRay ray;
+    if (wallActive()) {
+        int viewX, viewY;
+        WallView* view = wallViewAt(x, y, &viewX, &viewY);
+        if (!view) {
+            result->bin = result->lid = -1;
+            result->distance = 0.0f;
+            return;
+        }
+        pickRayFromCamera(&view->camera, viewX, viewY, view->width, view->height, &ray);
+    } else {
+        pickRayFromCamera(&camera, x, y, windowWidth, windowHeight, &ray);
+    }
+    pickStats.nodesTested = 0;
+    if (fleetMode) {
+        fleetPick(&ray, result, &pickStats.nodesTested);
+    } else {
+        static const float origin[3] = {0.0f, 0.0f, 0.0f};
+        result->distance = pickBin(&ray, origin, 0.0f, &result->lid);
+        result->bin = result->distance >= 0.0f ? 0 : -1;
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    pickStats.picks++;
+    pickStats.lastUs = elapsed.count();
+    if (pickStats.lastUs > pickStats.maxUs) pickStats.maxUs = pickStats.lastUs;
+}
+
+void printPickedBin(const PickResult& pick) {
+    static const char* compartmentNames[BIN_COMPARTMENT_COUNT] = {"recyclable", "organic", "hazardous"};
+    if (pick.bin < 0) {
+        printf("Nothing under the cursor (%.1f us)\n", pickStats.lastUs);
+        return;
+    }
+    GLfloat fill[BIN_COMPARTMENT_COUNT];
+    if (fleetMode) {
+        const BinInstance& bin = fleetInstances()[pick.bin];
+        memcpy(fill, bin.fill, sizeof(fill));
+        printf("Bin %d at (%.1f, %.1f), facing %.0f degrees", pick.bin, bin.position[0], bin.position[2], bin.yaw);
+    } else {
+        simFillLevels(fill);
+        printf("Bin");
+    }
+    if (pick.lid >= 0) printf(", %s lid", compartmentNames[pick.lid]);
+    printf(" (%.1f us, %lu nodes)\n", pickStats.lastUs, pickStats.nodesTested);
+    printf("  Fill: %s %.0f%%, %s %.0f%%, %s %.0f%%\n", compartmentNames[0], fill[0] * 100.0f, compartmentNames[1],
+           fill[1] * 100.0f, compartmentNames[2], fill[2] * 100.0f);
+    unsigned faults = fleetMode ? telemetryFaults(pick.bin) : 0;
+    if (faults) {
+        printf("  Faults:%s%s%s%s\n", faults & TELEMETRY_FAULT_SENSOR ? " sensor" : "",
+               faults & TELEMETRY_FAULT_JAMMED ? " jammed lid" : "", faults & TELEMETRY_FAULT_BATTERY ? " battery" : "",
+               faults & TELEMETRY_FAULT_TILT ? " tilted" : "");
+    }
+}
+
+// Outline the hovered lid, or the whole bin when the cursor is on its body
+void drawPickHighlight() {
+    if (hover.bin < 0) return;
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float yaw = 0.0f;
+    if (fleetMode) {
+        if ((size_t)hover.bin >= fleetInstances().size()) return;
+        const BinInstance& bin = fleetInstances()[hover.bin];
+        memcpy(position, bin.position, sizeof(position));
+        yaw = bin.yaw;
+    }
+    Aabb box;
+    if (hover.lid >= 0) {
+        binLidBox(hover.lid, &box);
+    } else {
+        binBodyBox(&box);
+    }
+
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LINE_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_COLOR_MATERIAL);
+    glLineWidth(2.0f);
+    glColor3f(1.0f, 0.9f, 0.1f);
+    glPushMatrix();
+    glTranslatef(position[0], position[1], position[2]);
+    glRotatef(yaw, 0.0f, 1.0f, 0.0f);
+    // Two rectangles and the four edges joining them, a little outside the box
+    const float* lo = box.min;
+    const float* hi = box.max;
+    const float pad = 0.03f;
+    for (int side = 0; side < 2; side++) {
+        float y = side ? hi[1] + pad : lo[1] - pad;
+        glBegin(GL_LINE_LOOP);
+        glVertex3f(lo[0] - pad, y, lo[2] - pad);
+        glVertex3f(hi[0] + pad, y, lo[2] - pad);
+        glVertex3f(hi[0] + pad, y, hi[2] + pad);
+        glVertex3f(lo[0] - pad, y, hi[2] + pad);
+        glEnd();
+    }
+    glBegin(GL_LINES);
+    for (int corner = 0; corner < 4; corner++) {
+        float x = (corner & 1) ? hi[0] + pad : lo[0] - pad;
+        float z = (corner & 2) ? hi[2] + pad : lo[2] - pad;
+        glVertex3f(x, lo[1] - pad, z);
+        glVertex3f(x, hi[1] + pad, z);
+    }
+    glEnd();
+    glPopMatrix();
+    glPopAttrib();
+}
+
+// Capture at the frame budget's rate, or 60 fps when frames are drawn on demand
+void toggleCapture() {
+    if (captureActive()) {
+        captureStop();
+        return;
+    }
+    float budget = inputFrameBudget();
+    int fps = budget > 0.0f ? (int)(1000.0f / budget + 0.5f) : 60;
+    if (captureStart(capturePath, windowWidth, windowHeight, fps)) inputRequestRedraw();
+}
+
+// Apply the camera changes queued since the last frame
+void applyPendingInput(const PendingInput& input) {
+    cameraYaw += input.orbitX * 0.5f;
+    cameraPitch += input.orbitY * 0.5f;
+    if (cameraPitch > 89.0f) cameraPitch = 89.0f;
+    if (cameraPitch < -89.0f) cameraPitch = -89.0f;
+
+    int steps = input.zoomSteps;
+    for (; steps > 0; steps--) cameraDistance -= fleetMode ? cameraDistance * 0.1f : 1.0f;
+    for (; steps < 0; steps++) cameraDistance += fleetMode ? cameraDistance * 0.1f : 1.0f;
+    if (cameraDistance < 5.0f) cameraDistance = 5.0f;
+    if (cameraDistance > maxCameraDistance) cameraDistance = maxCameraDistance;
 }
 
 // Keyboard handler for zoom
@@ -157,17 +1128,135 @@ void keyboard(unsigned char key, int x, int y) {
     switch (key) {
         case '+':
         case '=': // Allow both + and = for zoom in
-            cameraDistance -= 1.0f;
-            if (cameraDistance < 5.0f) cameraDistance = 5.0f;
-            glutPostRedisplay();
+            inputQueueZoom(1);
             break;
         case '-':
         case '_': // Allow both - and _ for zoom out
-            cameraDistance += 1.0f;
-            if (cameraDistance > 50.0f) cameraDistance = 50.0f;
-            glutPostRedisplay();
+            inputQueueZoom(-1);
+            break;
+        case 'r':
+        case 'R': // Toggle retained/immediate drawing
+            useRetainedMode = !useRetainedMode;
+            printf("Drawing path: %s\n", useRetainedMode ? "retained" : "immediate");
+            inputRequestRedraw();
+            break;
+        case 't':
+        case 'T': // Compare frame times of both paths
+            compareRenderPaths(200);
+            inputRequestRedraw();
+            break;
+        case 'f':
+        case 'F': // Toggle fleet scene
+            setFleetMode(!fleetMode);
+            inputRequestRedraw();
+            break;
+        case 'v':
+        case 'V': // Toggle frustum culling
+            useFrustumCulling = !useFrustumCulling;
+            printf("Frustum culling: %s\n", useFrustumCulling ? "on" : "off");
+            inputRequestRedraw();
+            break;
+        case 'l':
+        case 'L': // Toggle level of detail
+            useLevelOfDetail = !useLevelOfDetail;
+            printf("Level of detail: %s\n", useLevelOfDetail ? "on" : "off");
+            inputRequestRedraw();
+            break;
+        case 'm':
+        case 'M': // Move 1% of the fleet
+            moveRandomBins((int)fleetInstances().size() / 100 + 1);
+            inputRequestRedraw();
+            break;
+        case 'i':
+        case 'I': // Culling and draw counters for the last frame
+            printFrameStats();
+            if (wallActive()) printWallStats();
+            if (useSoftRaster) printSoftStats();
+            printRenderStats();
+            if (pickStats.picks > 0) {
+                printf("Picking: %lu picks, last %.1f us (%lu nodes), max %.1f us\n", pickStats.picks, pickStats.lastUs,
+                       pickStats.nodesTested, pickStats.maxUs);
+            }
+            if (simCount() > 0) printSimStats();
+            if (telemetryActive()) printTelemetryStats();
+            if (fleetMode && showRoutes) printRouteStats();
+            break;
+        case 's':
+        case 'S': // Start or pause the waste simulation
+            if (simItems()->x.empty()) simInit(SIM_DEFAULT_ITEMS);
+            simSetEnabled(!simEnabled());
+            printf("Waste simulation: %s\n", simEnabled() ? "running" : "paused");
+            inputRequestRedraw();
+            break;
+        case 'w':
+        case 'W': // Step the simulation on its own thread or in each frame
+            simSetThreaded(!simUseWorker);
+            printf("Simulation stepping: %s\n", simUseWorker ? "worker thread" : "in-frame");
+            inputRequestRedraw();
+            break;
+        case 'g':
+        case 'G': // Toggle fleet fill reports
+            fillReports = !fillReports;
+            printf("Fill reports: %s\n", fillReports ? "on" : "off");
+            inputRequestRedraw();
+            break;
+        case 'h':
+        case 'H': // Toggle fleet lid deposits
+            lidDeposits = !lidDeposits;
+            printf("Lid deposits: %s\n", lidDeposits ? "on" : "off");
+            inputRequestRedraw();
+            break;
+        case 'b':
+        case 'B': // Toggle the CPU rasterizer
+            setSoftRaster(!useSoftRaster);
+            printf("Renderer: %s\n", useSoftRaster ? "CPU rasterizer" : "OpenGL");
+            inputRequestRedraw();
+            break;
+        case 'q':
+        case 'Q': // Toggle state-sorted render queue
+            useRenderQueue = !useRenderQueue;
+            renderStateFiltering = useRenderQueue;
+            printf("Render queue: %s\n", useRenderQueue ? "on" : "off");
+            inputRequestRedraw();
+            break;
+        case 'c':
+        case 'C': // Primitive cache report
+            printPrimitiveCacheStats();
+            break;
+        case 'p':
+        case 'P': // Profiler with on-screen overlay
+            profilerSetEnabled(!profilerEnabled);
+            inputRequestRedraw();
+            break;
+        case 'd':
+        case 'D': // Write recorded profiler frames
+            profilerDump(profilePath ? profilePath : "profile.csv");
+            if (!profilePath) profilerDump("profile.json");
+            break;
+        case 'n':
+        case 'N': // Toggle the monitoring wall
+            wallSetViewCount(wallActive() ? 0 : wallViews);
+            reshape(windowWidth, windowHeight);
+            printf("View wall: %s\n", wallActive() ? "on" : "off");
+            inputRequestRedraw();
+            break;
+        case 'u':
+        case 'U': // Toggle collection routes
+            showRoutes = !showRoutes;
+            if (showRoutes && fleetMode) {
+                updateRoutes(true);
+                printRouteStats();
+            }
+            printf("Collection routes: %s\n", showRoutes ? "on" : "off");
+            inputRequestRedraw();
+            break;
+        case 'o':
+        case 'O': // Start/stop video capture
+            toggleCapture();
             break;
         case 27: // ESC
+            if (profilePath) profilerDump(profilePath);
+            captureStop();
             exit(0);
             break;
     }
@@ -175,6 +1264,7 @@ void keyboard(unsigned char key, int x, int y) {
 
 // Draw the ground
 void drawGround() {
+    PROFILE_SCOPE("drawGround");
     GLfloat groundColor[] = {0.6f, 0.6f, 0.6f, 1.0f};
     GLfloat groundSpecular[] = {0.0f, 0.0f, 0.0f, 1.0f};
 
@@ -185,32 +1275,62 @@ void drawGround() {
     glPushMatrix();
     glBegin(GL_QUADS);
     glNormal3f(0.0f, 1.0f, 0.0f);
-    glVertex3f(-20.0f, 0.0f, -20.0f);
-    glVertex3f(-20.0f, 0.0f, 20.0f);
-    glVertex3f(20.0f, 0.0f, 20.0f);
-    glVertex3f(20.0f, 0.0f, -20.0f);
+    glVertex3f(-groundHalfSize, 0.0f, -groundHalfSize);
+    glVertex3f(-groundHalfSize, 0.0f, groundHalfSize);
+    glVertex3f(groundHalfSize, 0.0f, groundHalfSize);
+    glVertex3f(groundHalfSize, 0.0f, -groundHalfSize);
     glEnd();
     glPopMatrix();
+
+    if (fleetMode && showRoutes) drawRouteOverlay();
+}
+
+// Each truck's loop from the depot, in its compartment's color, and the depot itself
+void drawRouteOverlay() {
+    const std::vector<Route>& plan = routes();
+    const std::vector<BinInstance>& bins = fleetInstances();
+    glDisable(GL_LIGHTING);
+    glLineWidth(2.0f);
+    for (size_t r = 0; r < plan.size(); r++) {
+        const std::vector<unsigned>& stops = plan[r].stops;
+        if (stops.empty()) continue;
+        glColor3fv(binLidColors[plan[r].compartment]);
+        glBegin(GL_LINE_LOOP);
+        glVertex3f(ROUTE_DEPOT_X, ROUTE_OVERLAY_HEIGHT, ROUTE_DEPOT_Z);
+        for (size_t i = 0; i < stops.size(); i++) {
+            if (stops[i] >= bins.size()) continue; // Fleet replaced since the last plan
+            glVertex3f(bins[stops[i]].position[0], ROUTE_OVERLAY_HEIGHT, bins[stops[i]].position[2]);
+        }
+        glEnd();
+    }
+    glPointSize(10.0f);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glBegin(GL_POINTS);
+    glVertex3f(ROUTE_DEPOT_X, ROUTE_OVERLAY_HEIGHT, ROUTE_DEPOT_Z);
+    glEnd();
+    glPointSize(1.0f);
+    glLineWidth(1.0f);
+    glEnable(GL_LIGHTING);
 }
 
 // Draw a cylinder
 void drawCylinder(float radius, float height, int segments) {
-    GLUquadricObj* quadric = gluNewQuadric();
-    gluQuadricNormals(quadric, GLU_SMOOTH);
-
-    glPushMatrix();
-    glRotatef(-90.0f, 1.0f, 0.0f, 0.0f);
-    gluCylinder(quadric, radius, radius, height, segments, 1);
-    gluDisk(quadric, 0.0f, radius, segments, 1);
-    glTranslatef(0.0f, 0.0f, height);
-    gluDisk(quadric, 0.0f, radius, segments, 1);
-    glPopMatrix();
-
-    gluDeleteQuadric(quadric);
+    const Primitive* side = primitiveCylinder(radius, height, segments);
+    const Primitive* cap = primitiveDisk(radius, segments);
+    primitiveCountQuadricAvoided();
+
+    geomPushMatrix();
+    geomRotatef(-90.0f, 1.0f, 0.0f, 0.0f);
+    geomPrimitive(side);
+    geomPrimitive(cap);
+    geomTranslatef(0.0f, 0.0f, height);
+    geomPrimitive(cap);
+    geomPopMatrix();
 }
 
 // Draw complete garbage bin system
-void drawGarbageBin() {
+void drawGarbageBin(const GLfloat* const lidColors[BIN_COMPARTMENT_COUNT]) {
+    PROFILE_SCOPE("drawGarbageBin");
     // Base platform colors
     GLfloat baseColor[3] = {0.8f, 0.8f, 0.85f};
 
@@ -219,65 +1339,242 @@ void drawGarbageBin() {
     GLfloat baseDiffuse[4] = {baseColor[0], baseColor[1], baseColor[2], 1.0f};
     GLfloat baseSpecular[4] = {0.4f, 0.4f, 0.4f, 1.0f};
 
-    glMaterialfv(GL_FRONT, GL_AMBIENT, baseAmbient);
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, baseDiffuse);
-    glMaterialfv(GL_FRONT, GL_SPECULAR, baseSpecular);
-    glMaterialf(GL_FRONT, GL_SHININESS, 30.0f);
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, baseAmbient);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, baseDiffuse);
+    geomMaterialfv(GL_FRONT, GL_SPECULAR, baseSpecular);
+    geomMaterialf(GL_FRONT, GL_SHININESS, 30.0f);
 
-    glPushMatrix();
-    glTranslatef(0.0f, 0.25f, 0.0f);
+    geomPushMatrix();
+    geomTranslatef(0.0f, 0.25f, 0.0f);
 
     // Bin proportions
-    float totalWidth = 12.0f;
-    float binDepth = 6.0f;
-    float binHeight = 5.0f;
+    float totalWidth = BIN_TOTAL_WIDTH;
+    float binDepth = BIN_DEPTH;
+    float binHeight = BIN_HEIGHT;
 
     // Draw main bin container (shared body)
     GLfloat binColor[3] = {0.7f, 0.7f, 0.7f}; // Neutral color for bin body
 
-    glPushMatrix();
-    glTranslatef(0.0f, 2.1f, 0.0f);
+    geomPushMatrix();
+    geomTranslatef(0.0f, 2.1f, 0.0f);
 
     // Draw the shared container body
+    beginBinPart(BIN_PART_BODY);
     drawUnifiedBinContainer(totalWidth, binHeight, binDepth, binColor);
 
     // Dividers - correct positions/heights so flush with bin top (not rim)
     GLfloat dividerColor[3] = {0.5f, 0.5f, 0.5f};
     float dividerHeight = binHeight - RIM_HEIGHT;
     float dividerY = -binHeight/2 + dividerHeight/2;
-    drawBinDivider(-2.0f, dividerY, 0.0f, dividerHeight, binDepth * 0.9f, dividerColor);
-    drawBinDivider(2.0f, dividerY, 0.0f, dividerHeight, binDepth * 0.9f, dividerColor);
+    beginBinPart(BIN_PART_DIVIDERS);
+    if (binDetail != BIN_DETAIL_LOW) { // Hidden under the lids from afar
+        drawBinDivider(-BIN_DIVIDER_X, dividerY, 0.0f, dividerHeight, binDepth * 0.9f, dividerColor);
+        drawBinDivider(BIN_DIVIDER_X, dividerY, 0.0f, dividerHeight, binDepth * 0.9f, dividerColor);
+    }
 
     // Draw the three colored lids - flush with rim + bin, not floating
-    float compartmentWidth = 3.9f;
+    float compartmentWidth = BIN_COMPARTMENT_WIDTH;
     float lidY = binHeight/2 - RIM_HEIGHT - LID_THICKNESS/2;
 
-    glPushMatrix();
-    glTranslatef(-4.0f, lidY, 0.0f);
-    drawLid(compartmentWidth, binDepth * 1.0f, recyclableBinColor);
-    glPopMatrix();
+    beginBinPart(BIN_PART_RECYCLABLE_LID);
+    geomPushMatrix();
+    geomTranslatef(-4.0f, lidY, 0.0f);
+    swingLid(BIN_RECYCLABLE, binDepth);
+    drawLid(compartmentWidth, binDepth * 1.0f, lidColors[BIN_RECYCLABLE]);
+    geomPopMatrix();
+
+    beginBinPart(BIN_PART_ORGANIC_LID);
+    geomPushMatrix();
+    geomTranslatef(0.0f, lidY, 0.0f);
+    swingLid(BIN_ORGANIC, binDepth);
+    drawLid(compartmentWidth, binDepth * 1.0f, lidColors[BIN_ORGANIC]);
+    geomPopMatrix();
+
+    beginBinPart(BIN_PART_HAZARDOUS_LID);
+    geomPushMatrix();
+    geomTranslatef(4.0f, lidY, 0.0f);
+    swingLid(BIN_HAZARDOUS, binDepth);
+    drawLid(compartmentWidth, binDepth * 1.0f, lidColors[BIN_HAZARDOUS]);
+    geomPopMatrix();
+
+    geomPopMatrix();
 
-    glPushMatrix();
-    glTranslatef(0.0f, lidY, 0.0f);
-    drawLid(compartmentWidth, binDepth * 1.0f, organicBinColor);
-    glPopMatrix();
+    // Adjust compartment labels for new dimensions
+    beginBinPart(BIN_PART_LABELS);
+    drawCompartmentLabels();
 
-    glPushMatrix();
-    glTranslatef(4.0f, lidY, 0.0f);
-    drawLid(compartmentWidth, binDepth * 1.0f, hazardousBinColor);
-    glPopMatrix();
+    geomPopMatrix();
+}
 
-    glPopMatrix();
+// Open a lid drawn immediately about its back edge; recorded lids stay closed
+// and are swung by drawBinMeshes() instead
+void swingLid(int compartment, float depth) {
+    if (geomIsRecording() || lidOpenAngles[compartment] <= 0.0f) return;
+    geomTranslatef(0.0f, LID_THICKNESS / 2.0f, -depth / 2.0f);
+    geomRotatef(-lidOpenAngles[compartment], 1.0f, 0.0f, 0.0f);
+    geomTranslatef(0.0f, -LID_THICKNESS / 2.0f, depth / 2.0f);
+}
 
-    // Adjust compartment labels for new dimensions
-    drawCompartmentLabels();
+// Route the following geometry into one part's mesh (no-op when drawing immediately)
+void beginBinPart(int part) {
+    if (geomIsRecording()) geomRecordSwitch(&recordParts[part]);
+}
 
-    glPopMatrix();
+// Record drawGarbageBin() at one detail level into per-part meshes and upload them
+void recordBinMeshes(Mesh parts[BIN_PART_COUNT], const GLfloat* const lidColors[BIN_COMPARTMENT_COUNT], int detail) {
+    for (int i = 0; i < BIN_PART_COUNT; i++) {
+        meshRelease(&parts[i]);
+        parts[i] = Mesh();
+    }
+
+    recordParts = parts;
+    binDetail = detail;
+    geomRecordBegin(&parts[BIN_PART_BODY]);
+    drawGarbageBin(lidColors);
+    geomRecordEnd();
+    binDetail = BIN_DETAIL_HIGH;
+
+    for (int i = 0; i < BIN_PART_COUNT; i++) {
+        meshUpload(&parts[i]);
+    }
+}
+
+// Everything the recorded bin depends on. Changes to the draw, recording and
+// tessellation code are covered by BIN_MESH_VERSION.
+uint64_t binMeshKey() {
+    const uint32_t codeVersion = BIN_MESH_VERSION;
+    const float parameters[] = {
+        LID_THICKNESS, RIM_HEIGHT, LID_COLOR_SCALE, LID_CURVE,
+        BIN_TOTAL_WIDTH, BIN_DEPTH, BIN_HEIGHT, BIN_CENTER_Y, BIN_CORNER_RADIUS,
+        BIN_DIVIDER_X, BIN_DIVIDER_THICKNESS, BIN_COMPARTMENT_WIDTH,
+        LID_SEGMENTS, LEAF_SEGMENTS, LEAF_VEINS, RECYCLE_ARROWS, BIN_CORNER_SEGMENTS, BIN_FOOT_SEGMENTS,
+        BIN_DETAIL_COUNT, BIN_PART_COUNT
+    };
+    uint64_t key = meshCacheHash(parameters, sizeof(parameters));
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) key = meshCacheHash(binLidColors[c], 3 * sizeof(GLfloat), key);
+    return meshCacheHash(&codeVersion, sizeof(codeVersion), key);
+}
+
+void buildBinMeshes() {
+    static const char* detailNames[BIN_DETAIL_COUNT] = {"high", "medium", "low"};
+
+    // White lids make the recorded lid materials pure multipliers of the instance color
+    static const GLfloat white[3] = {1.0f, 1.0f, 1.0f};
+    const GLfloat* whiteLids[BIN_COMPARTMENT_COUNT] = {white, white, white};
+
+    // Both sets of parts at every level, in one cache file
+    Mesh* allParts[2 * BIN_DETAIL_COUNT * BIN_PART_COUNT];
+    for (int level = 0; level < BIN_DETAIL_COUNT; level++) {
+        for (int i = 0; i < BIN_PART_COUNT; i++) {
+            allParts[level * BIN_PART_COUNT + i] = &binMeshes[level][i];
+            allParts[(BIN_DETAIL_COUNT + level) * BIN_PART_COUNT + i] = &fleetMeshes[level][i];
+        }
+    }
+    int partCount = sizeof(allParts) / sizeof(allParts[0]);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t key = binMeshKey();
+    bool cached = meshCachePath && meshCacheLoad(meshCachePath, key, allParts, partCount);
+    if (!cached) {
+        for (int level = 0; level < BIN_DETAIL_COUNT; level++) {
+            recordBinMeshes(binMeshes[level], binLidColors, level);
+            recordBinMeshes(fleetMeshes[level], whiteLids, level);
+        }
+        if (meshCachePath && meshCacheSave(meshCachePath, key, allParts, partCount)) {
+            printf("Mesh cache %s: written\n", meshCachePath);
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    printf("Bin meshes %s in %.2f ms\n", cached ? "loaded from cache" : "generated", elapsed.count());
+
+    for (int level = 0; level < BIN_DETAIL_COUNT; level++) {
+        size_t vertexCount = 0, indexCount = 0;
+        for (int i = 0; i < BIN_PART_COUNT; i++) {
+            vertexCount += binMeshes[level][i].vertices.size();
+            indexCount += binMeshes[level][i].indices.size();
+        }
+        printf("Bin meshes (%s detail): %d parts, %u vertices, %u indices\n", detailNames[level], BIN_PART_COUNT,
+               (unsigned)vertexCount, (unsigned)indexCount);
+    }
+
+    if (!fleetInit(fleetMeshes)) printf("Fleet: instancing unavailable, bins will be drawn one by one\n");
+}
+
+// Draw the recorded bin at one detail level from GPU buffers, each part at its node's
+// cached world matrix (without nodes, in bin space with the lids shut)
+void drawBinMeshes(int detail, const SceneGraph* graph, const BinNodes* nodes) {
+    if (useRenderQueue) {
+        static const GLfloat identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+        renderQueueBegin();
+        for (int i = 0; i < BIN_PART_COUNT; i++) {
+            renderQueueSubmit(&binMeshes[detail][i], nodes ? sceneWorld(graph, nodes->parts[i]) : identity);
+        }
+        renderQueueFlush();
+    } else {
+        for (int i = 0; i < BIN_PART_COUNT; i++) {
+            if (nodes) {
+                glPushMatrix();
+                glMultMatrixf(sceneWorld(graph, nodes->parts[i]));
+            }
+            meshDraw(&binMeshes[detail][i]);
+            if (nodes) glPopMatrix();
+        }
+    }
+
+    // The symbols reset emission after their last primitive, which a recording cannot capture
+    renderStateMaterialfv(GL_EMISSION, noEmission);
+}
+
+// Swing each lid towards open while classified items are falling through it,
+// and the fleet's lids by their own targets
+void updateLidAngles(float elapsed) {
+    const SimStats* stats = simCount() > 0 ? simStats() : NULL;
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        float target = stats && stats->passing[c] > 0 ? LID_OPEN_ANGLE : 0.0f;
+        float swing = LID_SWING_SPEED * elapsed;
+        if (lidOpenAngles[c] == target) continue;
+        if (lidOpenAngles[c] < target) {
+            lidOpenAngles[c] = lidOpenAngles[c] + swing < target ? lidOpenAngles[c] + swing : target;
+        } else {
+            lidOpenAngles[c] = lidOpenAngles[c] - swing > target ? lidOpenAngles[c] - swing : target;
+        }
+        GLfloat hinge[16];
+        binHingeMatrix(lidOpenAngles[c], hinge);
+        sceneSetLocal(&binGraph, binNodes.hinges[c], hinge);
+    }
+    sceneUpdate(&binGraph);
+    if (fleetMode) fleetAnimateLids(elapsed);
 }
 
+// Items the classifier has sent to each compartment, above its lid
+void drawCompartmentCounts() {
+    const SimStats* stats = simStats();
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    gluLookAt(camera.eye[0], camera.eye[1], camera.eye[2], camera.target[0], camera.target[1], camera.target[2],
+              camera.up[0], camera.up[1], camera.up[2]);
+    glColor3f(0.0f, 0.0f, 0.0f);
+    char text[32];
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        snprintf(text, sizeof(text), "%lu", stats->classify.assigned[c]);
+        glRasterPos3f(BIN_COMPARTMENT_CENTER(c) - 0.3f, BIN_LID_Y + 0.8f, BIN_DEPTH / 2.0f);
+        for (const char* p = text; *p; p++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *p);
+    }
+    glPopAttrib();
+}
+
+// Segment count for a curve drawn with segments at full detail
+int detailSegments(int segments) {
+    if (binDetail == BIN_DETAIL_HIGH) return segments;
+    return reducedSegments(segments);
+}
 
 // Draw unified bin container
 void drawUnifiedBinContainer(float width, float height, float depth, const GLfloat color[3]) {
+    PROFILE_SCOPE("drawUnifiedBinContainer");
     GLfloat brighterColor[3] = {
         color[0] * 1.5f > 1.0f ? 1.0f : color[0] * 1.5f,
         color[1] * 1.5f > 1.0f ? 1.0f : color[1] * 1.5f,
@@ -288,155 +1585,165 @@ void drawUnifiedBinContainer(float width, float height, float depth, const GLflo
     GLfloat diffuse[4] = {brighterColor[0], brighterColor[1], brighterColor[2], 1.0f};
     GLfloat specular[4] = {0.4f, 0.4f, 0.4f, 1.0f};
 
-    glMaterialfv(GL_FRONT, GL_AMBIENT, ambient);
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, diffuse);
-    glMaterialfv(GL_FRONT, GL_SPECULAR, specular);
-    glMaterialf(GL_FRONT, GL_SHININESS, 20.0f);
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, ambient);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, diffuse);
+    geomMaterialfv(GL_FRONT, GL_SPECULAR, specular);
+    geomMaterialf(GL_FRONT, GL_SHININESS, 20.0f);
 
     float w = width / 2.0f;
     float h = height / 2.0f;
     float d = depth / 2.0f;
-    float cornerRadius = 0.5f;
+    float cornerRadius = BIN_CORNER_RADIUS;
     float widthScale = 1.05f;
     float depthScale = 1.05f;
 
-    glPushMatrix();
+    if (binDetail == BIN_DETAIL_LOW) {
+        // Plain box up to the underside of the lids
+        float top = h - RIM_HEIGHT - LID_THICKNESS;
+        geomPushMatrix();
+        geomTranslatef(0.0f, (top - h) * 0.5f, 0.0f);
+        geomScalef(2.0f * w * widthScale, top + h, 2.0f * d * depthScale);
+        geomSolidCube(1.0f);
+        geomPopMatrix();
+        return;
+    }
+
+    geomPushMatrix();
 
     // Draw the main bin faces
-    glBegin(GL_QUADS);
+    geomBegin(GL_QUADS);
 
     // Front face - tapered
-    glNormal3f(0.0f, 0.0f, 1.0f);
-    glVertex3f(-w, -h + cornerRadius, d);
-    glVertex3f(w, -h + cornerRadius, d);
-    glVertex3f(w * widthScale, h - cornerRadius, d * depthScale);
-    glVertex3f(-w * widthScale, h - cornerRadius, d * depthScale);
+    geomNormal3f(0.0f, 0.0f, 1.0f);
+    geomVertex3f(-w, -h + cornerRadius, d);
+    geomVertex3f(w, -h + cornerRadius, d);
+    geomVertex3f(w * widthScale, h - cornerRadius, d * depthScale);
+    geomVertex3f(-w * widthScale, h - cornerRadius, d * depthScale);
 
     // Back face
-    glNormal3f(0.0f, 0.0f, -1.0f);
-    glVertex3f(-w, -h + cornerRadius, -d);
-    glVertex3f(-w * widthScale, h - cornerRadius, -d * depthScale);
-    glVertex3f(w * widthScale, h - cornerRadius, -d * depthScale);
-    glVertex3f(w, -h + cornerRadius, -d);
+    geomNormal3f(0.0f, 0.0f, -1.0f);
+    geomVertex3f(-w, -h + cornerRadius, -d);
+    geomVertex3f(-w * widthScale, h - cornerRadius, -d * depthScale);
+    geomVertex3f(w * widthScale, h - cornerRadius, -d * depthScale);
+    geomVertex3f(w, -h + cornerRadius, -d);
 
     // Left face
-    glNormal3f(-1.0f, 0.0f, 0.0f);
-    glVertex3f(-w, -h + cornerRadius, -d);
-    glVertex3f(-w, -h + cornerRadius, d);
-    glVertex3f(-w * widthScale, h - cornerRadius, d * depthScale);
-    glVertex3f(-w * widthScale, h - cornerRadius, -d * depthScale);
+    geomNormal3f(-1.0f, 0.0f, 0.0f);
+    geomVertex3f(-w, -h + cornerRadius, -d);
+    geomVertex3f(-w, -h + cornerRadius, d);
+    geomVertex3f(-w * widthScale, h - cornerRadius, d * depthScale);
+    geomVertex3f(-w * widthScale, h - cornerRadius, -d * depthScale);
 
     // Right face
-    glNormal3f(1.0f, 0.0f, 0.0f);
-    glVertex3f(w, -h + cornerRadius, -d);
-    glVertex3f(w * widthScale, h - cornerRadius, -d * depthScale);
-    glVertex3f(w * widthScale, h - cornerRadius, d * depthScale);
-    glVertex3f(w, -h + cornerRadius, d);
+    geomNormal3f(1.0f, 0.0f, 0.0f);
+    geomVertex3f(w, -h + cornerRadius, -d);
+    geomVertex3f(w * widthScale, h - cornerRadius, -d * depthScale);
+    geomVertex3f(w * widthScale, h - cornerRadius, d * depthScale);
+    geomVertex3f(w, -h + cornerRadius, d);
     // Bottom face
-    glNormal3f(0.0f, -1.0f, 0.0f);
-    glVertex3f(-w, -h + cornerRadius, -d);
-    glVertex3f(w, -h + cornerRadius, -d);
-    glVertex3f(w, -h + cornerRadius, d);
-    glVertex3f(-w, -h + cornerRadius, d);
-    glEnd();
+    geomNormal3f(0.0f, -1.0f, 0.0f);
+    geomVertex3f(-w, -h + cornerRadius, -d);
+    geomVertex3f(w, -h + cornerRadius, -d);
+    geomVertex3f(w, -h + cornerRadius, d);
+    geomVertex3f(-w, -h + cornerRadius, d);
+    geomEnd();
 
     // ADDED: Rounded corners using cylinders at bottom
     GLfloat cornerColor[4] = {brighterColor[0] * 0.9f, brighterColor[1] * 0.9f, brighterColor[2] * 0.9f, 1.0f};
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, cornerColor);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, cornerColor);
 
-    GLUquadricObj* cornerQuad = gluNewQuadric();
-    gluQuadricNormals(cornerQuad, GLU_SMOOTH);
+    const Primitive* corner = primitivePartialDisk(cornerRadius, detailSegments(BIN_CORNER_SEGMENTS), 90.0f);
+    primitiveCountQuadricAvoided();
 
     // Bottom corners (4 corners)
     float bottomY = -h + cornerRadius;
 
     // Bottom front left
-    glPushMatrix();
-    glTranslatef(-w, bottomY, d);
-    glRotatef(180.0f, 0.0f, 1.0f, 0.0f);
-    gluPartialDisk(cornerQuad, 0.0f, cornerRadius, 12, 1, 0, 90);
-    glPopMatrix();
+    geomPushMatrix();
+    geomTranslatef(-w, bottomY, d);
+    geomRotatef(180.0f, 0.0f, 1.0f, 0.0f);
+    geomPrimitive(corner);
+    geomPopMatrix();
 
     // Bottom front right
-    glPushMatrix();
-    glTranslatef(w, bottomY, d);
-    glRotatef(270.0f, 0.0f, 1.0f, 0.0f);
-    gluPartialDisk(cornerQuad, 0.0f, cornerRadius, 12, 1, 0, 90);
-    glPopMatrix();
+    geomPushMatrix();
+    geomTranslatef(w, bottomY, d);
+    geomRotatef(270.0f, 0.0f, 1.0f, 0.0f);
+    geomPrimitive(corner);
+    geomPopMatrix();
 
     // Bottom back right
-    glPushMatrix();
-    glTranslatef(w, bottomY, -d);
-    glRotatef(0.0f, 0.0f, 1.0f, 0.0f);
-    gluPartialDisk(cornerQuad, 0.0f, cornerRadius, 12, 1, 0, 90);
-    glPopMatrix();
+    geomPushMatrix();
+    geomTranslatef(w, bottomY, -d);
+    geomRotatef(0.0f, 0.0f, 1.0f, 0.0f);
+    geomPrimitive(corner);
+    geomPopMatrix();
 
     // Bottom back left
-    glPushMatrix();
-    glTranslatef(-w, bottomY, -d);
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-    gluPartialDisk(cornerQuad, 0.0f, cornerRadius, 12, 1, 0, 90);
-    glPopMatrix();
+    geomPushMatrix();
+    geomTranslatef(-w, bottomY, -d);
+    geomRotatef(90.0f, 0.0f, 1.0f, 0.0f);
+    geomPrimitive(corner);
+    geomPopMatrix();
 
     // Horizontal grooves
     GLfloat grooveColor[4] = {brighterColor[0] * 0.7f, brighterColor[1] * 0.7f, brighterColor[2] * 0.7f, 1.0f};
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, grooveColor);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, grooveColor);
 
-    for (int i = 1; i < 5; i++) {
+    for (int i = 1; i < 5 && binDetail == BIN_DETAIL_HIGH; i++) {
         float y = -h + height * 0.2f * i;
-        glBegin(GL_LINES);
-        glLineWidth(2.0f);
+        geomBegin(GL_LINES);
+        geomLineWidth(2.0f);
 
-        glVertex3f(-w * 0.95f, y, d * 1.01f);
-        glVertex3f(w * 0.95f, y, d * 1.01f);
+        geomVertex3f(-w * 0.95f, y, d * 1.01f);
+        geomVertex3f(w * 0.95f, y, d * 1.01f);
 
-        glVertex3f(-w * 1.01f, y, -d * 0.9f);
-        glVertex3f(-w * 1.01f, y, d * 0.9f);
+        geomVertex3f(-w * 1.01f, y, -d * 0.9f);
+        geomVertex3f(-w * 1.01f, y, d * 0.9f);
 
-        glVertex3f(w * 1.01f, y, -d * 0.9f);
-        glVertex3f(w * 1.01f, y, d * 0.9f);
-        glEnd();
+        geomVertex3f(w * 1.01f, y, -d * 0.9f);
+        geomVertex3f(w * 1.01f, y, d * 0.9f);
+        geomEnd();
     }
 
     // Rim (top edge)
     GLfloat rimColor[4] = {brighterColor[0] * 0.8f, brighterColor[1] * 0.8f, brighterColor[2] * 0.8f, 1.0f};
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, rimColor);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, rimColor);
 
     float rimHeight = RIM_HEIGHT;
-    glBegin(GL_QUAD_STRIP);
-    glVertex3f(-w * widthScale * 1.02f, h, -d * depthScale * 1.02f);
-    glVertex3f(-w * widthScale * 1.02f, h - rimHeight, -d * depthScale * 1.02f);
+    geomBegin(GL_QUAD_STRIP);
+    geomVertex3f(-w * widthScale * 1.02f, h, -d * depthScale * 1.02f);
+    geomVertex3f(-w * widthScale * 1.02f, h - rimHeight, -d * depthScale * 1.02f);
 
-    glVertex3f(-w * widthScale * 1.02f, h, d * depthScale * 1.02f);
-    glVertex3f(-w * widthScale * 1.02f, h - rimHeight, d * depthScale * 1.02f);
+    geomVertex3f(-w * widthScale * 1.02f, h, d * depthScale * 1.02f);
+    geomVertex3f(-w * widthScale * 1.02f, h - rimHeight, d * depthScale * 1.02f);
 
-    glVertex3f(w * widthScale * 1.02f, h, d * depthScale * 1.02f);
-    glVertex3f(w * widthScale * 1.02f, h - rimHeight, d * depthScale * 1.02f);
+    geomVertex3f(w * widthScale * 1.02f, h, d * depthScale * 1.02f);
+    geomVertex3f(w * widthScale * 1.02f, h - rimHeight, d * depthScale * 1.02f);
 
-    glVertex3f(w * widthScale * 1.02f, h, -d * depthScale * 1.02f);
-    glVertex3f(w * widthScale * 1.02f, h - rimHeight, -d * depthScale * 1.02f);
+    geomVertex3f(w * widthScale * 1.02f, h, -d * depthScale * 1.02f);
+    geomVertex3f(w * widthScale * 1.02f, h - rimHeight, -d * depthScale * 1.02f);
 
-    glVertex3f(-w * widthScale * 1.02f, h, -d * depthScale * 1.02f);
-    glVertex3f(-w * widthScale * 1.02f, h - rimHeight, -d * depthScale * 1.02f);
-    glEnd();
+    geomVertex3f(-w * widthScale * 1.02f, h, -d * depthScale * 1.02f);
+    geomVertex3f(-w * widthScale * 1.02f, h - rimHeight, -d * depthScale * 1.02f);
+    geomEnd();
 
-    glPopMatrix();
+    geomPopMatrix();
 
     // Bin feet (corners)
     GLfloat footColor[4] = {0.3f, 0.3f, 0.3f, 1.0f};
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, footColor);
-    glMaterialfv(GL_FRONT, GL_AMBIENT, footColor);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, footColor);
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, footColor);
     float footSize = 0.4f;
     float footHeight = 0.2f;
     float xOffsets[4] = {-w * 0.85f, w * 0.85f, w * 0.85f, -w * 0.85f};
     float zOffsets[4] = {-d * 0.85f, -d * 0.85f, d * 0.85f, d * 0.85f};
     for (int i = 0; i < 4; i++) {
-        glPushMatrix();
-        glTranslatef(xOffsets[i], -h, zOffsets[i]);
-        drawCylinder(footSize, footHeight, 8);
-        glPopMatrix();
+        geomPushMatrix();
+        geomTranslatef(xOffsets[i], -h, zOffsets[i]);
+        drawCylinder(footSize, footHeight, detailSegments(BIN_FOOT_SEGMENTS));
+        geomPopMatrix();
     }
-    gluDeleteQuadric(cornerQuad);
 }
 
 
@@ -445,27 +1752,28 @@ void drawBinDivider(float x, float y, float z, float height, float depth, const
     GLfloat ambient[4] = {color[0] * 0.6f, color[1] * 0.6f, color[2] * 0.6f, 1.0f};
     GLfloat diffuse[4] = {color[0], color[1], color[2], 1.0f};
 
-    glMaterialfv(GL_FRONT, GL_AMBIENT, ambient);
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, diffuse);
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, ambient);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, diffuse);
 
-    glPushMatrix();
-    glTranslatef(x, y, z);
-    glScalef(0.1f, height, depth);
-    glutSolidCube(1.0f);
-    glPopMatrix();
+    geomPushMatrix();
+    geomTranslatef(x, y, z);
+    geomScalef(BIN_DIVIDER_THICKNESS, height, depth);
+    geomSolidCube(1.0f);
+    geomPopMatrix();
 }
 
 // Draw a modern, sleek lid design
 void drawLid(float width, float depth, const GLfloat color[3]) {
+    PROFILE_SCOPE("drawLid");
     float w = width / 2.0f;
     float d = depth / 2.0f;
     float thickness = LID_THICKNESS;
 
     // Calculate slightly lighter color for lid
     GLfloat lidColor[3] = {
-        color[0] * 1.6f > 1.0f ? 1.0f : color[0] * 1.6f,
-        color[1] * 1.6f > 1.0f ? 1.0f : color[1] * 1.6f,
-        color[2] * 1.6f > 1.0f ? 1.0f : color[2] * 1.6f
+        color[0] * LID_COLOR_SCALE > 1.0f ? 1.0f : color[0] * LID_COLOR_SCALE,
+        color[1] * LID_COLOR_SCALE > 1.0f ? 1.0f : color[1] * LID_COLOR_SCALE,
+        color[2] * LID_COLOR_SCALE > 1.0f ? 1.0f : color[2] * LID_COLOR_SCALE
     };
 
     // Set material properties
@@ -473,302 +1781,581 @@ void drawLid(float width, float depth, const GLfloat color[3]) {
     GLfloat diffuse[4] = {lidColor[0], lidColor[1], lidColor[2], 1.0f};
     GLfloat specular[4] = {0.8f, 0.8f, 0.8f, 1.0f}; // More reflective
 
-    glMaterialfv(GL_FRONT, GL_AMBIENT, ambient);
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, diffuse);
-    glMaterialfv(GL_FRONT, GL_SPECULAR, specular);
-    glMaterialf(GL_FRONT, GL_SHININESS, 60.0f); // Higher shininess
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, ambient);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, diffuse);
+    geomMaterialfv(GL_FRONT, GL_SPECULAR, specular);
+    geomMaterialf(GL_FRONT, GL_SHININESS, 60.0f); // Higher shininess
+
+    if (binDetail == BIN_DETAIL_LOW) {
+        // Flat colored top only
+        geomBegin(GL_QUADS);
+        geomNormal3f(0.0f, 1.0f, 0.0f);
+        geomVertex3f(-w, thickness/2.0f, -d);
+        geomVertex3f(-w, thickness/2.0f, d);
+        geomVertex3f(w, thickness/2.0f, d);
+        geomVertex3f(w, thickness/2.0f, -d);
+        geomEnd();
+        return;
+    }
 
-    glPushMatrix();
+    geomPushMatrix();
 
     // Main lid surface
-    glBegin(GL_QUADS);
-    int segments = 10;
+    geomBegin(GL_QUADS);
+    int segments = detailSegments(LID_SEGMENTS);
+    const float* profile = lidProfile(segments);
     float segmentWidth = 2.0f * w / segments;
 
     for (int i = 0; i < segments; i++) {
         float x1 = -w + i * segmentWidth;
         float x2 = x1 + segmentWidth;
-        float y1 = thickness/2.0f + sin((float)i/segments * M_PI) * 0.1f;
-        float y2 = thickness/2.0f + sin((float)(i+1)/segments * M_PI) * 0.1f;
-
-        glNormal3f(0.0f, 1.0f, 0.0f);
-        glVertex3f(x1, y1, -d);
-        glVertex3f(x1, y1, d);
-        glVertex3f(x2, y2, d);
-        glVertex3f(x2, y2, -d);
+        float y1 = thickness/2.0f + profile[i];
+        float y2 = thickness/2.0f + profile[i + 1];
+
+        geomNormal3f(0.0f, 1.0f, 0.0f);
+        geomVertex3f(x1, y1, -d);
+        geomVertex3f(x1, y1, d);
+        geomVertex3f(x2, y2, d);
+        geomVertex3f(x2, y2, -d);
     }
 
-    glNormal3f(0.0f, -1.0f, 0.0f);
-    glVertex3f(-w, -thickness/2.0f, -d);
-    glVertex3f(w, -thickness/2.0f, -d);
-    glVertex3f(w, -thickness/2.0f, d);
-    glVertex3f(-w, -thickness/2.0f, d);
+    geomNormal3f(0.0f, -1.0f, 0.0f);
+    geomVertex3f(-w, -thickness/2.0f, -d);
+    geomVertex3f(w, -thickness/2.0f, -d);
+    geomVertex3f(w, -thickness/2.0f, d);
+    geomVertex3f(-w, -thickness/2.0f, d);
 
     // Front face
-    glNormal3f(0.0f, 0.0f, 1.0f);
-    glVertex3f(-w, -thickness/2.0f, d);
-    glVertex3f(w, -thickness/2.0f, d);
-    glVertex3f(w, thickness/2.0f, d);
-    glVertex3f(-w, thickness/2.0f, d);
+    geomNormal3f(0.0f, 0.0f, 1.0f);
+    geomVertex3f(-w, -thickness/2.0f, d);
+    geomVertex3f(w, -thickness/2.0f, d);
+    geomVertex3f(w, thickness/2.0f, d);
+    geomVertex3f(-w, thickness/2.0f, d);
 
     // Back face
-    glNormal3f(0.0f, 0.0f, -1.0f);
-    glVertex3f(-w, -thickness/2.0f, -d);
-    glVertex3f(-w, thickness/2.0f, -d);
-    glVertex3f(w, thickness/2.0f, -d);
-    glVertex3f(w, -thickness/2.0f, -d);
+    geomNormal3f(0.0f, 0.0f, -1.0f);
+    geomVertex3f(-w, -thickness/2.0f, -d);
+    geomVertex3f(-w, thickness/2.0f, -d);
+    geomVertex3f(w, thickness/2.0f, -d);
+    geomVertex3f(w, -thickness/2.0f, -d);
 
     // Left face
-    glNormal3f(-1.0f, 0.0f, 0.0f);
-    glVertex3f(-w, -thickness/2.0f, -d);
-    glVertex3f(-w, -thickness/2.0f, d);
-    glVertex3f(-w, thickness/2.0f, d);
-    glVertex3f(-w, thickness/2.0f, -d);
+    geomNormal3f(-1.0f, 0.0f, 0.0f);
+    geomVertex3f(-w, -thickness/2.0f, -d);
+    geomVertex3f(-w, -thickness/2.0f, d);
+    geomVertex3f(-w, thickness/2.0f, d);
+    geomVertex3f(-w, thickness/2.0f, -d);
 
     // Right face
-    glNormal3f(1.0f, 0.0f, 0.0f);
-    glVertex3f(w, -thickness/2.0f, -d);
-    glVertex3f(w, thickness/2.0f, -d);
-    glVertex3f(w, thickness/2.0f, d);
-    glVertex3f(w, -thickness/2.0f, d);
-    glEnd();
+    geomNormal3f(1.0f, 0.0f, 0.0f);
+    geomVertex3f(w, -thickness/2.0f, -d);
+    geomVertex3f(w, thickness/2.0f, -d);
+    geomVertex3f(w, thickness/2.0f, d);
+    geomVertex3f(w, -thickness/2.0f, d);
+    geomEnd();
 
     // Add raised edge for grip
     float edgeThickness = 0.2f;
     GLfloat edgeColor[4] = {lidColor[0] * 0.9f, lidColor[1] * 0.9f, lidColor[2] * 0.9f, 1.0f};
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, edgeColor);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, edgeColor);
 
-    glBegin(GL_QUADS);
+    geomBegin(GL_QUADS);
     // Top of edge
-    glNormal3f(0.0f, 1.0f, 0.0f);
-    glVertex3f(-w * 0.8f, thickness/2.0f, d);
-    glVertex3f(-w * 0.8f, thickness/2.0f, d + edgeThickness);
-    glVertex3f(w * 0.8f, thickness/2.0f, d + edgeThickness);
-    glVertex3f(w * 0.8f, thickness/2.0f, d);
+    geomNormal3f(0.0f, 1.0f, 0.0f);
+    geomVertex3f(-w * 0.8f, thickness/2.0f, d);
+    geomVertex3f(-w * 0.8f, thickness/2.0f, d + edgeThickness);
+    geomVertex3f(w * 0.8f, thickness/2.0f, d + edgeThickness);
+    geomVertex3f(w * 0.8f, thickness/2.0f, d);
 
     // Front of edge
-    glNormal3f(0.0f, 0.0f, 1.0f);
-    glVertex3f(-w * 0.8f, -thickness/2.0f, d + edgeThickness);
-    glVertex3f(w * 0.8f, -thickness/2.0f, d + edgeThickness);
-    glVertex3f(w * 0.8f, thickness/2.0f, d + edgeThickness);
-    glVertex3f(-w * 0.8f, thickness/2.0f, d + edgeThickness);
+    geomNormal3f(0.0f, 0.0f, 1.0f);
+    geomVertex3f(-w * 0.8f, -thickness/2.0f, d + edgeThickness);
+    geomVertex3f(w * 0.8f, -thickness/2.0f, d + edgeThickness);
+    geomVertex3f(w * 0.8f, thickness/2.0f, d + edgeThickness);
+    geomVertex3f(-w * 0.8f, thickness/2.0f, d + edgeThickness);
 
     // Left of edge
-    glNormal3f(-1.0f, 0.0f, 0.0f);
-    glVertex3f(-w * 0.8f, -thickness/2.0f, d);
-    glVertex3f(-w * 0.8f, -thickness/2.0f, d + edgeThickness);
-    glVertex3f(-w * 0.8f, thickness/2.0f, d + edgeThickness);
-    glVertex3f(-w * 0.8f, thickness/2.0f, d);
+    geomNormal3f(-1.0f, 0.0f, 0.0f);
+    geomVertex3f(-w * 0.8f, -thickness/2.0f, d);
+    geomVertex3f(-w * 0.8f, -thickness/2.0f, d + edgeThickness);
+    geomVertex3f(-w * 0.8f, thickness/2.0f, d + edgeThickness);
+    geomVertex3f(-w * 0.8f, thickness/2.0f, d);
 
     // Right of edge
-    glNormal3f(1.0f, 0.0f, 0.0f);
-    glVertex3f(w * 0.8f, -thickness/2.0f, d);
-    glVertex3f(w * 0.8f, thickness/2.0f, d);
-    glVertex3f(w * 0.8f, thickness/2.0f, d + edgeThickness);
-    glVertex3f(w * 0.8f, -thickness/2.0f, d + edgeThickness);
-    glEnd();
+    geomNormal3f(1.0f, 0.0f, 0.0f);
+    geomVertex3f(w * 0.8f, -thickness/2.0f, d);
+    geomVertex3f(w * 0.8f, thickness/2.0f, d);
+    geomVertex3f(w * 0.8f, thickness/2.0f, d + edgeThickness);
+    geomVertex3f(w * 0.8f, -thickness/2.0f, d + edgeThickness);
+    geomEnd();
+
+    if (binDetail != BIN_DETAIL_HIGH) {
+        geomPopMatrix();
+        return;
+    }
 
     // Add edge highlighting
     GLfloat highlightColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, highlightColor);
-    glMaterialfv(GL_FRONT, GL_AMBIENT, highlightColor);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, highlightColor);
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, highlightColor);
 
-    glLineWidth(2.0f);
-    glBegin(GL_LINE_LOOP);
+    geomLineWidth(2.0f);
+    geomBegin(GL_LINE_LOOP);
     for (int i = 0; i < segments; i++) {
         float x = -w + i * segmentWidth;
-        float y = thickness/2.0f + sin((float)i/segments * M_PI) * 0.1f;
-        glVertex3f(x, y, d);
+        float y = thickness/2.0f + profile[i];
+        geomVertex3f(x, y, d);
     }
-    glVertex3f(w, thickness/2.0f + sin(1.0f * M_PI) * 0.1f, d);
-    glVertex3f(w, thickness/2.0f + sin(1.0f * M_PI) * 0.1f, -d);
+    geomVertex3f(w, thickness/2.0f + profile[segments], d);
+    geomVertex3f(w, thickness/2.0f + profile[segments], -d);
 
     for (int i = segments; i > 0; i--) {
         float x = -w + i * segmentWidth;
-        float y = thickness/2.0f + sin((float)i/segments * M_PI) * 0.1f;
-        glVertex3f(x, y, -d);
+        float y = thickness/2.0f + profile[i];
+        geomVertex3f(x, y, -d);
     }
-    glVertex3f(-w, thickness/2.0f + sin(0.0f) * 0.1f, -d);
-    glEnd();
+    geomVertex3f(-w, thickness/2.0f + profile[0], -d);
+    geomEnd();
 
-    glPopMatrix();
+    geomPopMatrix();
 }
 
 // Draw a recycle symbol
 void drawRecycleSymbol(float x, float y, float z, float size) {
-    glPushMatrix();
-    glTranslatef(x, y, z);
+    geomPushMatrix();
+    geomTranslatef(x, y, z);
 
     // Use a solid white color with high emission for visibility
     GLfloat symbolColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
     GLfloat emissionColor[4] = {0.3f, 0.3f, 0.3f, 1.0f};
 
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, symbolColor);
-    glMaterialfv(GL_FRONT, GL_AMBIENT, symbolColor);
-    glMaterialfv(GL_FRONT, GL_EMISSION, emissionColor);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, symbolColor);
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, symbolColor);
+    geomMaterialfv(GL_FRONT, GL_EMISSION, emissionColor);
 
-    glLineWidth(2.0f);
+    geomLineWidth(2.0f);
 
-    float arrowSize = size * 0.3f;
-    float offset = size * 0.2f;
+    // Arrows come pre-rotated from the table: head triangle, then shaft quad
+    const float* arrowX = RecycleArrows<RECYCLE_ARROWS>::x;
+    const float* arrowY = RecycleArrows<RECYCLE_ARROWS>::y;
+    for (int i = 0; i < RECYCLE_ARROWS; i++) {
+        int v = i * RECYCLE_ARROW_VERTICES;
 
-    for (int i = 0; i < 3; i++) {
-        glPushMatrix();
-        glRotatef(i * 120.0f, 0.0f, 0.0f, 1.0f);
-        glTranslatef(0.0f, offset, 0.0f);
-
-        glBegin(GL_TRIANGLES);
-        glVertex3f(0.0f, arrowSize, 0.0f);
-        glVertex3f(-arrowSize * 0.5f, 0.0f, 0.0f);
-        glVertex3f(arrowSize * 0.5f, 0.0f, 0.0f);
-        glEnd();
+        geomBegin(GL_TRIANGLES);
+        for (int k = 0; k < 3; k++) geomVertex3f(arrowX[v + k] * size, arrowY[v + k] * size, 0.0f);
+        geomEnd();
 
-        glBegin(GL_QUADS);
-        glVertex3f(-arrowSize * 0.2f, 0.0f, 0.0f);
-        glVertex3f(arrowSize * 0.2f, 0.0f, 0.0f);
-        glVertex3f(arrowSize * 0.2f, -arrowSize * 1.5f, 0.0f);
-        glVertex3f(-arrowSize * 0.2f, -arrowSize * 1.5f, 0.0f);
-        glEnd();
-
-        glPopMatrix();
+        geomBegin(GL_QUADS);
+        for (int k = 3; k < 7; k++) geomVertex3f(arrowX[v + k] * size, arrowY[v + k] * size, 0.0f);
+        geomEnd();
     }
 
-    glMaterialfv(GL_FRONT, GL_EMISSION, noEmission);
+    geomMaterialfv(GL_FRONT, GL_EMISSION, noEmission);
 
-    glPopMatrix();
+    geomPopMatrix();
 }
 
 // Draw a leaf symbol for organic waste
 void drawLeafSymbol(float x, float y, float z, float size) {
-    glPushMatrix();
-    glTranslatef(x, y, z);
+    geomPushMatrix();
+    geomTranslatef(x, y, z);
 
     GLfloat symbolColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
     GLfloat emissionColor[4] = {0.3f, 0.3f, 0.3f, 1.0f};
 
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, symbolColor);
-    glMaterialfv(GL_FRONT, GL_AMBIENT, symbolColor);
-    glMaterialfv(GL_FRONT, GL_EMISSION, emissionColor);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, symbolColor);
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, symbolColor);
+    geomMaterialfv(GL_FRONT, GL_EMISSION, emissionColor);
 
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex3f(0.0f, size * 0.5f, 0.0f);
-    int segments = 12;
+    geomBegin(GL_TRIANGLE_FAN);
+    geomVertex3f(0.0f, size * 0.5f, 0.0f);
+    int segments = detailSegments(LEAF_SEGMENTS);
+    const float* outlineX = leafOutlineX(segments);
+    const float* outlineY = leafOutlineY(segments);
     for (int i = 0; i <= segments; i++) {
-        float angle = M_PI * i / segments;
-        float leafWidth = sin(angle) * size * 0.4f;
-        float leafLength = -cos(angle) * size * 0.8f;
-        glVertex3f(leafWidth, leafLength, 0.0f);
+        geomVertex3f(outlineX[i] * size, outlineY[i] * size, 0.0f);
     }
-    glEnd();
-
-    glBegin(GL_QUADS);
-    glVertex3f(-size * 0.05f, -size * 0.3f, 0.0f);
-    glVertex3f(size * 0.05f, -size * 0.3f, 0.0f);
-    glVertex3f(size * 0.05f, -size * 0.8f, 0.0f);
-    glVertex3f(-size * 0.05f, -size * 0.8f, 0.0f);
-    glEnd();
-
-    glLineWidth(2.0f);
-    glBegin(GL_LINES);
-    glVertex3f(0.0f, size * 0.5f, 0.0f);
-    glVertex3f(0.0f, -size * 0.3f, 0.0f);
-    for (int i = 1; i <= 4; i++) {
+    geomEnd();
+
+    geomBegin(GL_QUADS);
+    geomVertex3f(-size * 0.05f, -size * 0.3f, 0.0f);
+    geomVertex3f(size * 0.05f, -size * 0.3f, 0.0f);
+    geomVertex3f(size * 0.05f, -size * 0.8f, 0.0f);
+    geomVertex3f(-size * 0.05f, -size * 0.8f, 0.0f);
+    geomEnd();
+
+    geomLineWidth(2.0f);
+    geomBegin(GL_LINES);
+    geomVertex3f(0.0f, size * 0.5f, 0.0f);
+    geomVertex3f(0.0f, -size * 0.3f, 0.0f);
+    for (int i = 1; i <= LEAF_VEINS; i++) {
         float veinPos = -size * 0.3f + i * (size * 0.8f / 5);
-        float veinWidth = sin(i * M_PI / 10) * size * 0.35f;
-        glVertex3f(0.0f, veinPos, 0.0f);
-        glVertex3f(-veinWidth, veinPos - size * 0.1f, 0.0f);
-        glVertex3f(0.0f, veinPos, 0.0f);
-        glVertex3f(veinWidth, veinPos - size * 0.1f, 0.0f);
+        float veinWidth = LeafVeins<LEAF_VEINS>::width[i - 1] * size;
+        geomVertex3f(0.0f, veinPos, 0.0f);
+        geomVertex3f(-veinWidth, veinPos - size * 0.1f, 0.0f);
+        geomVertex3f(0.0f, veinPos, 0.0f);
+        geomVertex3f(veinWidth, veinPos - size * 0.1f, 0.0f);
     }
-    glEnd();
+    geomEnd();
 
-    glMaterialfv(GL_FRONT, GL_EMISSION, noEmission);
+    geomMaterialfv(GL_FRONT, GL_EMISSION, noEmission);
 
-    glPopMatrix();
+    geomPopMatrix();
 }
 
 // Draw a hazard symbol
 void drawHazardSymbol(float x, float y, float z, float size) {
-    glPushMatrix();
-    glTranslatef(x, y, z);
+    geomPushMatrix();
+    geomTranslatef(x, y, z);
 
     GLfloat symbolColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
     GLfloat emissionColor[4] = {0.3f, 0.3f, 0.3f, 1.0f};
 
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, symbolColor);
-    glMaterialfv(GL_FRONT, GL_AMBIENT, symbolColor);
-    glMaterialfv(GL_FRONT, GL_EMISSION, emissionColor);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, symbolColor);
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, symbolColor);
+    geomMaterialfv(GL_FRONT, GL_EMISSION, emissionColor);
 
-    glBegin(GL_TRIANGLES);
-    glVertex3f(0.0f, size * 0.6f, 0.0f);
-    glVertex3f(-size * 0.5f, -size * 0.4f, 0.0f);
-    glVertex3f(size * 0.5f, -size * 0.4f, 0.0f);
-    glEnd();
+    geomBegin(GL_TRIANGLES);
+    geomVertex3f(0.0f, size * 0.6f, 0.0f);
+    geomVertex3f(-size * 0.5f, -size * 0.4f, 0.0f);
+    geomVertex3f(size * 0.5f, -size * 0.4f, 0.0f);
+    geomEnd();
 
     GLfloat borderColor[4] = {0.0f, 0.0f, 0.0f, 1.0f};
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, borderColor);
-    glMaterialfv(GL_FRONT, GL_AMBIENT, borderColor);
-    glMaterialfv(GL_FRONT, GL_EMISSION, noEmission);
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, borderColor);
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, borderColor);
+    geomMaterialfv(GL_FRONT, GL_EMISSION, noEmission);
 
     float borderWidth = size * 0.05f;
-    glBegin(GL_TRIANGLES);
-    glVertex3f(0.0f, size * 0.6f - borderWidth, 0.0f);
-    glVertex3f(-size * 0.5f + borderWidth, -size * 0.4f + borderWidth, 0.0f);
-    glVertex3f(size * 0.5f - borderWidth, -size * 0.4f + borderWidth, 0.0f);
-    glEnd();
-
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, symbolColor);
-    glMaterialfv(GL_FRONT, GL_AMBIENT, symbolColor);
-    glMaterialfv(GL_FRONT, GL_EMISSION, emissionColor);
-
-    glBegin(GL_QUADS);
-    glVertex3f(-size * 0.05f, size * 0.2f, 0.0f);
-    glVertex3f(size * 0.05f, size * 0.2f, 0.0f);
-    glVertex3f(size * 0.05f, -size * 0.2f, 0.0f);
-    glVertex3f(-size * 0.05f, -size * 0.2f, 0.0f);
-    glEnd();
-
-    glBegin(GL_QUADS);
-    glVertex3f(-size * 0.05f, -size * 0.25f, 0.0f);
-    glVertex3f(size * 0.05f, -size * 0.25f, 0.0f);
-    glVertex3f(size * 0.05f, -size * 0.35f, 0.0f);
-    glVertex3f(-size * 0.05f, -size * 0.35f, 0.0f);
-    glEnd();
-
-    glMaterialfv(GL_FRONT, GL_EMISSION, noEmission);
-
-    glPopMatrix();
+    geomBegin(GL_TRIANGLES);
+    geomVertex3f(0.0f, size * 0.6f - borderWidth, 0.0f);
+    geomVertex3f(-size * 0.5f + borderWidth, -size * 0.4f + borderWidth, 0.0f);
+    geomVertex3f(size * 0.5f - borderWidth, -size * 0.4f + borderWidth, 0.0f);
+    geomEnd();
+
+    geomMaterialfv(GL_FRONT, GL_DIFFUSE, symbolColor);
+    geomMaterialfv(GL_FRONT, GL_AMBIENT, symbolColor);
+    geomMaterialfv(GL_FRONT, GL_EMISSION, emissionColor);
+
+    geomBegin(GL_QUADS);
+    geomVertex3f(-size * 0.05f, size * 0.2f, 0.0f);
+    geomVertex3f(size * 0.05f, size * 0.2f, 0.0f);
+    geomVertex3f(size * 0.05f, -size * 0.2f, 0.0f);
+    geomVertex3f(-size * 0.05f, -size * 0.2f, 0.0f);
+    geomEnd();
+
+    geomBegin(GL_QUADS);
+    geomVertex3f(-size * 0.05f, -size * 0.25f, 0.0f);
+    geomVertex3f(size * 0.05f, -size * 0.25f, 0.0f);
+    geomVertex3f(size * 0.05f, -size * 0.35f, 0.0f);
+    geomVertex3f(-size * 0.05f, -size * 0.35f, 0.0f);
+    geomEnd();
+
+    geomMaterialfv(GL_FRONT, GL_EMISSION, noEmission);
+
+    geomPopMatrix();
 }
 
 // Draw compartment labels (symbols) on the front face of the bin
 void drawCompartmentLabels() {
+    PROFILE_SCOPE("drawCompartmentLabels");
     float labelY = 2.1f;   // Centered vertically on the bin
     float labelZ = 3.2f;   // Slightly in front of the bin's front face
     float labelSize = 1.0f;
+    if (binDetail == BIN_DETAIL_LOW) return;
 
     drawRecycleSymbol(-4.0f, labelY, labelZ, labelSize);
     drawLeafSymbol(0.0f, labelY, labelZ, labelSize);
     drawHazardSymbol(4.0f, labelY, labelZ, labelSize);
 }
 
+// Print launch-to-first-frame time once, after the first frame has finished drawing
+void reportFirstFrame() {
+    static bool reported = false;
+    if (reported) return;
+    reported = true;
+    glFinish();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - launchTime;
+    printf("First frame %.1f ms after launch\n", elapsed.count());
+}
+
 // Main function
 int main(int argc, char** argv) {
+    // Command line:
+    //   --fleet N              start with N bins on screen
+    //   --load-fleet FILE      start with the bins in a fleet file instead of the grid
+    //   --save-fleet FILE      write the grid of --fleet N bins to a fleet file, then exit
+    //   --convert-layout IN OUT  write a CSV or JSON layout (IN) as fleet file OUT, then exit
+    //   --headless             render offscreen without a window, then exit
+    //   --pose yaw,pitch,dist  add a headless camera pose (repeatable)
+    //   --poses FILE           add poses from a file, one "yaw pitch distance [output]" per line
+    //   --output PATTERN       headless file names, '#' runs become the frame number (.png or .ppm)
+    //   --size WxH             headless image size
+    //   --mesh-cache FILE      bake recorded bin meshes to FILE and load them from it (default bin_meshes.cache)
+    //   --no-mesh-cache        record the bin meshes at every launch
+    //   --wall N               show N camera views at once (overview, districts, close-ups; default 9)
+    //   --capture FILE         record video from the first frame (.y4m, or raw RGB), also while benchmarking
+    //   --profile FILE         profile every frame and write FILE (.csv or .json) on exit
+    //   --benchmark [FILE]     time scripted orbits offscreen, optionally writing JSON results
+    //   --bench-sizes N,N,...  fleet sizes to benchmark (default 1,10,100,1000,10000,100000)
+    //   --bench-frames N       recorded frames per benchmark scenario
+    //   --sim [N]              drop waste items into the bin, N at a time (default 100000)
+    //   --sim-sync             step the simulation in each frame instead of on a worker thread
+    //   --classify-threads N   threads classifying arriving items (default one per core)
+    //   --bench-classify [N]   time the classifier on N items (default 1000000), then exit
+    //   --fill-reports         fleet bins report changing fill levels from the start
+    //   --lid-deposits         random fleet lids swing open and shut from the start
+    //   --bench-sim [N]        time the simulation kernels on N items (default 1000000), then exit
+    //   --bench-tables         time the curved-detail vertex math with and without geometry tables, then exit
+    //   --frame-budget MS      render at most one frame per MS (default: as fast as input arrives)
+    //   --pipeline fixed|glsl  lighting for retained meshes (default fixed)
+    //   --soft                 draw with the CPU rasterizer (also for --headless and --benchmark)
+    //   --soft-threads N       CPU rasterizer threads (default one per core)
+    //   --routes               show collection routes for full fleet compartments from the start
+    //   --trucks N             collection trucks across all compartments (default one per 150 stops)
+    //   --route-threshold F    fill level, 0..1, at which a compartment needs emptying (default 0.75)
+    //   --route-threads N      route planner threads (default one per core)
+    //   --bench-routes [N]     time route planning for N bins (default 50000, 200 trucks), then exit
+    //   --telemetry ADDR       apply fleet updates arriving on udp:PORT or unix:PATH (repeatable)
+    //   --telemetry-load ADDR [RATE]  send synthetic fleet updates to ADDR (default 1000000/s), then exit
+    //   --telemetry-seconds S  how long --telemetry-load and --bench-telemetry run (default 5, 0 for ever)
+    //   --bench-telemetry [RATE]  time telemetry ingestion into the fleet over local sockets, then exit
+    //   --no-culling, --no-lod, --no-instancing, --no-render-queue  disable a renderer feature (for comparisons)
+    bool startInFleet = false;
+    const char* saveFleetPath = NULL;
+    int simItemCount = 0;
+    int classifyThreadCount = 0;
+    bool headless = false;
+    std::vector<CameraPose> poses;
+    const char* outputPattern = "frame_####.png";
+    int headlessWidth = WIDTH, headlessHeight = HEIGHT;
+    bool benchmark = false;
+    const char* benchmarkPath = NULL;
+    int benchmarkSizeList[] = {1, 10, 100, 1000, 10000, 100000};
+    std::vector<int> benchmarkSizes(benchmarkSizeList, benchmarkSizeList + sizeof(benchmarkSizeList) / sizeof(int));
+    int benchmarkFrames = BENCHMARK_FRAMES;
+    std::vector<const char*> telemetryAddresses;
+    const char* telemetryLoadAddress = NULL;
+    int telemetryRate = TELEMETRY_DEFAULT_RATE;
+    float telemetrySeconds = 5.0f;
+    bool benchmarkTelemetryOnly = false;
+    int benchmarkRouteBins = 0;
+    int routeTruckCount = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fleet") == 0 && i + 1 < argc) {
+            fleetSize = atoi(argv[++i]);
+            if (fleetSize < 1) fleetSize = 1;
+            startInFleet = true;
+        } else if (strcmp(argv[i], "--load-fleet") == 0 && i + 1 < argc) {
+            fleetPath = argv[++i];
+            startInFleet = true;
+        } else if (strcmp(argv[i], "--save-fleet") == 0 && i + 1 < argc) {
+            saveFleetPath = argv[++i];
+        } else if (strcmp(argv[i], "--convert-layout") == 0 && i + 2 < argc) {
+            std::vector<BinInstance> bins;
+            const char* layoutPath = argv[++i];
+            const char* outputPath = argv[++i];
+            if (!loadFleetLayout(layoutPath, binLidColors, &bins)) return 1;
+            if (bins.empty()) {
+                printf("%s: no bins\n", layoutPath);
+                return 1;
+            }
+            bool saved = fleetFileWrite(outputPath, &bins[0], bins.size());
+            if (saved) printf("Wrote %lu bins from %s to %s\n", (unsigned long)bins.size(), layoutPath, outputPath);
+            return saved ? 0 : 1;
+        } else if (strcmp(argv[i], "--wall") == 0 && i + 1 < argc) {
+            wallViews = atoi(argv[++i]);
+            if (wallViews < 1) wallViews = 1;
+            if (wallViews > WALL_MAX_VIEWS) wallViews = WALL_MAX_VIEWS;
+            wallSetViewCount(wallViews);
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capturePath = argv[++i];
+            captureAtLaunch = true;
+        } else if (strcmp(argv[i], "--mesh-cache") == 0 && i + 1 < argc) {
+            meshCachePath = argv[++i];
+        } else if (strcmp(argv[i], "--no-mesh-cache") == 0) {
+            meshCachePath = NULL;
+        } else if (strcmp(argv[i], "--benchmark") == 0) {
+            benchmark = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') benchmarkPath = argv[++i];
+        } else if (strcmp(argv[i], "--bench-sizes") == 0 && i + 1 < argc) {
+            if (!parseBenchmarkSizes(argv[++i], &benchmarkSizes)) {
+                printf("Bad fleet sizes \"%s\", expected N,N,...\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--sim") == 0) {
+            simItemCount = SIM_DEFAULT_ITEMS;
+            if (i + 1 < argc && argv[i + 1][0] != '-') simItemCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fill-reports") == 0) {
+            fillReports = true;
+        } else if (strcmp(argv[i], "--lid-deposits") == 0) {
+            lidDeposits = true;
+        } else if (strcmp(argv[i], "--sim-sync") == 0) {
+            simUseWorker = false;
+        } else if (strcmp(argv[i], "--classify-threads") == 0 && i + 1 < argc) {
+            classifyThreadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-classify") == 0) {
+            benchmarkClassifier(i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[++i]) : 1000000);
+            return 0;
+        } else if (strcmp(argv[i], "--bench-sim") == 0) {
+            benchmarkSimulation(i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[++i]) : 1000000);
+            return 0;
+        } else if (strcmp(argv[i], "--bench-tables") == 0) {
+            benchmarkGeometryTables(BENCHMARK_TABLE_BINS);
+            return 0;
+        } else if (strcmp(argv[i], "--bench-frames") == 0 && i + 1 < argc) {
+            benchmarkFrames = atoi(argv[++i]);
+            if (benchmarkFrames < 1) benchmarkFrames = 1;
+        } else if (strcmp(argv[i], "--frame-budget") == 0 && i + 1 < argc) {
+            inputSetFrameBudget((float)atof(argv[++i]));
+        } else if (strcmp(argv[i], "--pipeline") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "glsl") == 0) {
+                renderPipeline = PIPELINE_GLSL;
+            } else if (strcmp(argv[i], "fixed") == 0) {
+                renderPipeline = PIPELINE_FIXED;
+            } else {
+                printf("Bad pipeline \"%s\", expected fixed or glsl\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-culling") == 0) {
+            useFrustumCulling = false;
+        } else if (strcmp(argv[i], "--no-lod") == 0) {
+            useLevelOfDetail = false;
+        } else if (strcmp(argv[i], "--no-instancing") == 0) {
+            useInstancing = false;
+        } else if (strcmp(argv[i], "--no-render-queue") == 0) {
+            useRenderQueue = false;
+            renderStateFiltering = false;
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (strcmp(argv[i], "--soft") == 0) {
+            useSoftRaster = true;
+        } else if (strcmp(argv[i], "--soft-threads") == 0 && i + 1 < argc) {
+            softThreadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--routes") == 0) {
+            showRoutes = true;
+        } else if (strcmp(argv[i], "--trucks") == 0 && i + 1 < argc) {
+            routeTruckCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--route-threshold") == 0 && i + 1 < argc) {
+            routesSetThreshold((float)atof(argv[++i]));
+        } else if (strcmp(argv[i], "--route-threads") == 0 && i + 1 < argc) {
+            routeThreadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-routes") == 0) {
+            benchmarkRouteBins = 50000;
+            if (i + 1 < argc && argv[i + 1][0] != '-') benchmarkRouteBins = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            telemetryAddresses.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--telemetry-load") == 0 && i + 1 < argc) {
+            telemetryLoadAddress = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') telemetryRate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--telemetry-seconds") == 0 && i + 1 < argc) {
+            telemetrySeconds = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-telemetry") == 0) {
+            benchmarkTelemetryOnly = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') telemetryRate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (strcmp(argv[i], "--pose") == 0 && i + 1 < argc) {
+            CameraPose pose;
+            if (!parseCameraPose(argv[++i], &pose)) {
+                printf("Bad pose \"%s\", expected yaw,pitch,distance\n", argv[i]);
+                return 1;
+            }
+            poses.push_back(pose);
+        } else if (strcmp(argv[i], "--poses") == 0 && i + 1 < argc) {
+            if (!loadCameraPoses(argv[++i], &poses)) return 1;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPattern = argv[++i];
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &headlessWidth, &headlessHeight) != 2 || headlessWidth < 1 ||
+                headlessHeight < 1) {
+                printf("Bad size \"%s\", expected WxH\n", argv[i]);
+                return 1;
+            }
+        }
+    }
+
+    if (saveFleetPath) {
+        std::vector<BinInstance> bins;
+        layoutFleet(fleetSize, &bins);
+        bool saved = fleetFileWrite(saveFleetPath, &bins[0], bins.size());
+        if (saved) printf("Wrote %d bins to %s\n", fleetSize, saveFleetPath);
+        return saved ? 0 : 1;
+    }
+    if (telemetryLoadAddress) {
+        return runTelemetryGenerator(telemetryLoadAddress, telemetryRate, telemetrySeconds, fleetSize);
+    }
+    if (benchmarkTelemetryOnly) return runTelemetryBenchmark(telemetryRate, telemetrySeconds);
+    profilerEnabled = profilePath != NULL;
+    classifyInit(classifyThreadCount);
+    routesInit(routeThreadCount);
+    routesSetTrucks(routeTruckCount);
+    if (benchmarkRouteBins > 0) {
+        std::vector<BinInstance> bins;
+        layoutFleet(benchmarkRouteBins, &bins);
+        benchmarkRoutes(bins, routeTruckCount > 0 ? routeTruckCount : ROUTE_BENCH_TRUCKS);
+        return 0;
+    }
+    if (useSoftRaster) setSoftRaster(true);
+    if (simItemCount > 0) {
+        simInit(simItemCount);
+        simSetEnabled(true);
+    }
+    if (benchmark) return runBenchmark(benchmarkSizes, benchmarkFrames, benchmarkPath, headlessWidth, headlessHeight);
+    if (headless) {
+        if (poses.empty()) {
+            CameraPose pose = {cameraYaw, cameraPitch, cameraDistance, ""};
+            poses.push_back(pose);
+        }
+        return runHeadless(poses, outputPattern, headlessWidth, headlessHeight, startInFleet);
+    }
+
+    for (size_t i = 0; i < telemetryAddresses.size(); i++) {
+        if (!telemetryListen(telemetryAddresses[i])) return 1;
+    }
+
     glutInit(&argc, argv);
+
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
     glutInitWindowSize(WIDTH, HEIGHT);
     glutCreateWindow("Smart Waste Management - Unified Sorting Bin (Mouse + Keyboard Zoom)");
 
     init();
+    if (startInFleet) setFleetMode(true);
+    if (captureAtLaunch) toggleCapture();
     glutDisplayFunc(display);
     glutReshapeFunc(reshape);
     glutMouseFunc(mouse);
     glutMotionFunc(motion);
+    glutPassiveMotionFunc(passiveMotion);
     glutKeyboardFunc(keyboard);
 
     printf("Controls:\n");
     printf("Left mouse drag: Orbit camera\n");
+    printf("Left click: Print the status of the bin under the cursor (hovered bins and lids are outlined)\n");
     printf("+: Zoom in\n");
     printf("-: Zoom out\n");
+    printf("R: Toggle retained/immediate drawing\n");
+    printf("T: Compare immediate vs retained frame time\n");
+    printf("F: Toggle fleet of bins (--fleet N sets the count, --load-fleet FILE the layout)\n");
+    printf("V: Toggle frustum culling\n");
+    printf("L: Toggle level of detail\n");
+    printf("M: Move some fleet bins\n");
+    printf("I: Print culling, draw and state change counters\n");
+    printf("Q: Toggle state-sorted render queue\n");
+    printf("S: Start/pause waste item simulation (--sim N sets the count)\n");
+    printf("W: Step the simulation on a worker thread or in-frame\n");
+    printf("G: Toggle fleet fill reports\n");
+    printf("B: Toggle the CPU rasterizer (--soft, --soft-threads N)\n");
+    printf("H: Toggle fleet lid deposits (left click on a fleet lid opens or shuts it)\n");
+    printf("U: Toggle collection routes for full fleet compartments (--trucks N, --route-threshold F)\n");
+    printf("C: Print primitive cache statistics\n");
+    if (telemetryActive()) printf("Telemetry updates the fleet; I prints its counters, left click a bin's faults\n");
+    printf("N: Toggle the monitoring wall of camera views (--wall N sets the count)\n");
+    printf("O: Start/stop video capture (--capture FILE sets the file, .y4m or raw RGB)\n");
+    printf("P: Toggle profiler overlay\n");
+    printf("D: Dump profiler samples (profile.csv/json, or the --profile file)\n");
     printf("ESC: Exit\n");
 
     glutMainLoop();
@@ -0,0 +1,67 @@
+#include "mappedfile.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool mapFile(const char* path, MappedFile* file) {
+    memset(file, 0, sizeof(*file));
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        printf("Cannot open %s\n", path);
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(handle, &size);
+    HANDLE mapping = size.QuadPart > 0 ? CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!data) {
+        printf("Cannot map %s\n", path);
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+    file->fileHandle = handle;
+    file->mappingHandle = mapping;
+    file->size = (size_t)size.QuadPart;
+#else
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) {
+        printf("Cannot open %s\n", path);
+        return false;
+    }
+    struct stat info;
+    void* data = fstat(descriptor, &info) == 0 && info.st_size > 0
+                     ? mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0)
+                     : MAP_FAILED;
+    if (data == MAP_FAILED) {
+        printf("Cannot map %s\n", path);
+        close(descriptor);
+        return false;
+    }
+    file->descriptor = descriptor;
+    file->size = (size_t)info.st_size;
+#endif
+    file->data = data;
+    return true;
+}
+
+void unmapFile(MappedFile* file) {
+    if (!file->data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(file->data);
+    CloseHandle((HANDLE)file->mappingHandle);
+    CloseHandle((HANDLE)file->fileHandle);
+#else
+    munmap((void*)file->data, file->size);
+    close(file->descriptor);
+#endif
+    memset(file, 0, sizeof(*file));
+}
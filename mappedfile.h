@@ -0,0 +1,22 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <stddef.h>
+
+// A whole file mapped read-only; data stays valid until unmapFile()
+struct MappedFile {
+    const void* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int descriptor;
+#endif
+};
+
+// Prints the reason and returns false if the file is missing or empty
+bool mapFile(const char* path, MappedFile* file);
+void unmapFile(MappedFile* file);
+
+#endif
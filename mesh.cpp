@@ -0,0 +1,538 @@
+#include "mesh.h"
+#include "gl_ext.h"
+#include "pipeline.h"
+#include "primitives.h"
+#include "renderqueue.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define MATRIX_STACK_DEPTH 32
+
+// Column-major 4x4 matrix, same layout as glLoadMatrixf
+struct Matrix4 {
+    GLfloat m[16];
+};
+
+// Recording state
+static Mesh* recordTarget = NULL;
+static Matrix4 matrixStack[MATRIX_STACK_DEPTH];
+static int matrixTop = 0;
+static GLfloat currentNormal[3] = {0.0f, 0.0f, 1.0f};
+static MeshMaterial currentMaterial;
+static GLfloat currentLineWidth = 1.0f;
+static GLenum primitiveMode = GL_TRIANGLES;
+static std::vector<MeshVertex> primitiveVertices;
+
+// Every distinct material seen by meshMaterialId()
+static std::vector<MeshMaterial> materialTable;
+
+static void setIdentity(Matrix4* matrix) {
+    memset(matrix->m, 0, sizeof(matrix->m));
+    matrix->m[0] = matrix->m[5] = matrix->m[10] = matrix->m[15] = 1.0f;
+}
+
+// top = top * rhs, matching how glTranslate/glRotate/glScale post-multiply
+static void multiplyTop(const Matrix4* rhs) {
+    const GLfloat* a = matrixStack[matrixTop].m;
+    const GLfloat* b = rhs->m;
+    Matrix4 result;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            result.m[col * 4 + row] = a[0 * 4 + row] * b[col * 4 + 0] + a[1 * 4 + row] * b[col * 4 + 1] +
+                                      a[2 * 4 + row] * b[col * 4 + 2] + a[3 * 4 + row] * b[col * 4 + 3];
+        }
+    }
+    matrixStack[matrixTop] = result;
+}
+
+// GL default front material
+static void resetMaterial(MeshMaterial* material) {
+    const GLfloat ambient[4] = {0.2f, 0.2f, 0.2f, 1.0f};
+    const GLfloat diffuse[4] = {0.8f, 0.8f, 0.8f, 1.0f};
+    const GLfloat black[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    memcpy(material->ambient, ambient, sizeof(ambient));
+    memcpy(material->diffuse, diffuse, sizeof(diffuse));
+    memcpy(material->specular, black, sizeof(black));
+    memcpy(material->emission, black, sizeof(black));
+    material->shininess = 0.0f;
+}
+
+// Find or add the current material in the target mesh
+static int internMaterial(Mesh* mesh) {
+    for (size_t i = 0; i < mesh->materials.size(); i++) {
+        if (memcmp(&mesh->materials[i], &currentMaterial, sizeof(MeshMaterial)) == 0) return (int)i;
+    }
+    mesh->materials.push_back(currentMaterial);
+    return (int)mesh->materials.size() - 1;
+}
+
+// Append indices to the last batch if state matches, otherwise start a new one
+static void appendIndices(GLenum mode, const GLuint* indices, size_t count) {
+    Mesh* mesh = recordTarget;
+    int material = internMaterial(mesh);
+    GLfloat lineWidth = mode == GL_LINES ? currentLineWidth : 1.0f;
+
+    if (mesh->batches.empty() || mesh->batches.back().mode != mode || mesh->batches.back().material != material ||
+        mesh->batches.back().lineWidth != lineWidth) {
+        MeshBatch batch;
+        batch.mode = mode;
+        batch.material = material;
+        batch.lineWidth = lineWidth;
+        batch.firstIndex = (GLuint)mesh->indices.size();
+        batch.indexCount = 0;
+        mesh->batches.push_back(batch);
+    }
+    mesh->indices.insert(mesh->indices.end(), indices, indices + count);
+    mesh->batches.back().indexCount += (GLuint)count;
+}
+
+// Convert the pending primitive into indexed triangles or lines
+static void flushPrimitive() {
+    size_t n = primitiveVertices.size();
+    if (n == 0) return;
+
+    GLuint base = (GLuint)recordTarget->vertices.size();
+    recordTarget->vertices.insert(recordTarget->vertices.end(), primitiveVertices.begin(), primitiveVertices.end());
+
+    std::vector<GLuint> indices;
+    GLenum mode = GL_TRIANGLES;
+    switch (primitiveMode) {
+        case GL_TRIANGLES:
+            for (size_t i = 0; i + 2 < n; i += 3) {
+                GLuint tri[3] = {base + (GLuint)i, base + (GLuint)i + 1, base + (GLuint)i + 2};
+                indices.insert(indices.end(), tri, tri + 3);
+            }
+            break;
+        case GL_QUADS:
+            for (size_t i = 0; i + 3 < n; i += 4) {
+                GLuint b = base + (GLuint)i;
+                GLuint tris[6] = {b, b + 1, b + 2, b, b + 2, b + 3};
+                indices.insert(indices.end(), tris, tris + 6);
+            }
+            break;
+        case GL_QUAD_STRIP:
+            for (size_t i = 0; i + 3 < n; i += 2) {
+                GLuint b = base + (GLuint)i;
+                GLuint tris[6] = {b, b + 1, b + 3, b, b + 3, b + 2};
+                indices.insert(indices.end(), tris, tris + 6);
+            }
+            break;
+        case GL_TRIANGLE_STRIP:
+            for (size_t i = 0; i + 2 < n; i++) {
+                GLuint b = base + (GLuint)i;
+                GLuint tri[3] = {b, b + 1, b + 2};
+                if (i & 1) { tri[0] = b + 1; tri[1] = b; }
+                indices.insert(indices.end(), tri, tri + 3);
+            }
+            break;
+        case GL_TRIANGLE_FAN:
+        case GL_POLYGON:
+            for (size_t i = 1; i + 1 < n; i++) {
+                GLuint tri[3] = {base, base + (GLuint)i, base + (GLuint)i + 1};
+                indices.insert(indices.end(), tri, tri + 3);
+            }
+            break;
+        case GL_LINES:
+            mode = GL_LINES;
+            for (size_t i = 0; i + 1 < n; i += 2) {
+                indices.push_back(base + (GLuint)i);
+                indices.push_back(base + (GLuint)i + 1);
+            }
+            break;
+        case GL_LINE_STRIP:
+        case GL_LINE_LOOP:
+            mode = GL_LINES;
+            for (size_t i = 0; i + 1 < n; i++) {
+                indices.push_back(base + (GLuint)i);
+                indices.push_back(base + (GLuint)i + 1);
+            }
+            if (primitiveMode == GL_LINE_LOOP && n > 2) {
+                indices.push_back(base + (GLuint)n - 1);
+                indices.push_back(base);
+            }
+            break;
+    }
+
+    if (!indices.empty()) appendIndices(mode, &indices[0], indices.size());
+    primitiveVertices.clear();
+}
+
+void geomBegin(GLenum mode) {
+    if (!recordTarget) {
+        glBegin(mode);
+        return;
+    }
+    primitiveMode = mode;
+    primitiveVertices.clear();
+}
+
+void geomEnd() {
+    if (!recordTarget) {
+        glEnd();
+        return;
+    }
+    flushPrimitive();
+}
+
+// Bake the current matrix into a position, and its inverse-transpose into a normal
+static MeshVertex transformVertex(const GLfloat* p, const GLfloat* n) {
+    const GLfloat* m = matrixStack[matrixTop].m;
+    MeshVertex vertex;
+    vertex.position[0] = m[0] * p[0] + m[4] * p[1] + m[8] * p[2] + m[12];
+    vertex.position[1] = m[1] * p[0] + m[5] * p[1] + m[9] * p[2] + m[13];
+    vertex.position[2] = m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14];
+
+    // Cofactor matrix of the upper 3x3 is the inverse-transpose up to scale
+    GLfloat c[9] = {
+        m[5] * m[10] - m[9] * m[6], m[9] * m[2] - m[1] * m[10], m[1] * m[6] - m[5] * m[2],
+        m[8] * m[6] - m[4] * m[10], m[0] * m[10] - m[8] * m[2], m[4] * m[2] - m[0] * m[6],
+        m[4] * m[9] - m[8] * m[5], m[8] * m[1] - m[0] * m[9], m[0] * m[5] - m[4] * m[1]
+    };
+    GLfloat nx = c[0] * n[0] + c[1] * n[1] + c[2] * n[2];
+    GLfloat ny = c[3] * n[0] + c[4] * n[1] + c[5] * n[2];
+    GLfloat nz = c[6] * n[0] + c[7] * n[1] + c[8] * n[2];
+    GLfloat length = sqrtf(nx * nx + ny * ny + nz * nz);
+    if (length > 0.0f) {
+        nx /= length;
+        ny /= length;
+        nz /= length;
+    }
+    vertex.normal[0] = nx;
+    vertex.normal[1] = ny;
+    vertex.normal[2] = nz;
+    return vertex;
+}
+
+void geomVertex3f(GLfloat x, GLfloat y, GLfloat z) {
+    if (!recordTarget) {
+        glVertex3f(x, y, z);
+        return;
+    }
+    GLfloat position[3] = {x, y, z};
+    primitiveVertices.push_back(transformVertex(position, currentNormal));
+}
+
+void geomNormal3f(GLfloat x, GLfloat y, GLfloat z) {
+    if (!recordTarget) {
+        glNormal3f(x, y, z);
+        return;
+    }
+    currentNormal[0] = x;
+    currentNormal[1] = y;
+    currentNormal[2] = z;
+}
+
+void geomMaterialfv(GLenum face, GLenum pname, const GLfloat* params) {
+    if (!recordTarget) {
+        if (face == GL_FRONT) {
+            renderStateMaterialfv(pname, params);
+        } else {
+            glMaterialfv(face, pname, params);
+        }
+        return;
+    }
+    switch (pname) {
+        case GL_AMBIENT:
+            memcpy(currentMaterial.ambient, params, 4 * sizeof(GLfloat));
+            break;
+        case GL_DIFFUSE:
+            memcpy(currentMaterial.diffuse, params, 4 * sizeof(GLfloat));
+            break;
+        case GL_AMBIENT_AND_DIFFUSE:
+            memcpy(currentMaterial.ambient, params, 4 * sizeof(GLfloat));
+            memcpy(currentMaterial.diffuse, params, 4 * sizeof(GLfloat));
+            break;
+        case GL_SPECULAR:
+            memcpy(currentMaterial.specular, params, 4 * sizeof(GLfloat));
+            break;
+        case GL_EMISSION:
+            memcpy(currentMaterial.emission, params, 4 * sizeof(GLfloat));
+            break;
+        case GL_SHININESS:
+            currentMaterial.shininess = params[0];
+            break;
+    }
+}
+
+void geomMaterialf(GLenum face, GLenum pname, GLfloat param) {
+    if (!recordTarget) {
+        if (face == GL_FRONT) {
+            renderStateMaterialf(pname, param);
+        } else {
+            glMaterialf(face, pname, param);
+        }
+        return;
+    }
+    if (pname == GL_SHININESS) currentMaterial.shininess = param;
+}
+
+void geomLineWidth(GLfloat width) {
+    if (!recordTarget) {
+        renderStateLineWidth(width);
+        return;
+    }
+    currentLineWidth = width;
+}
+
+void geomPushMatrix() {
+    if (!recordTarget) {
+        glPushMatrix();
+        return;
+    }
+    if (matrixTop + 1 < MATRIX_STACK_DEPTH) {
+        matrixStack[matrixTop + 1] = matrixStack[matrixTop];
+        matrixTop++;
+    }
+}
+
+void geomPopMatrix() {
+    if (!recordTarget) {
+        glPopMatrix();
+        return;
+    }
+    if (matrixTop > 0) matrixTop--;
+}
+
+void geomTranslatef(GLfloat x, GLfloat y, GLfloat z) {
+    if (!recordTarget) {
+        glTranslatef(x, y, z);
+        return;
+    }
+    Matrix4 t;
+    setIdentity(&t);
+    t.m[12] = x;
+    t.m[13] = y;
+    t.m[14] = z;
+    multiplyTop(&t);
+}
+
+void geomRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z) {
+    if (!recordTarget) {
+        glRotatef(angle, x, y, z);
+        return;
+    }
+    GLfloat length = sqrtf(x * x + y * y + z * z);
+    if (length == 0.0f) return;
+    x /= length;
+    y /= length;
+    z /= length;
+
+    GLfloat radians = angle * (GLfloat)M_PI / 180.0f;
+    GLfloat c = cosf(radians);
+    GLfloat s = sinf(radians);
+    GLfloat k = 1.0f - c;
+
+    Matrix4 r;
+    setIdentity(&r);
+    r.m[0] = x * x * k + c;     r.m[4] = x * y * k - z * s; r.m[8] = x * z * k + y * s;
+    r.m[1] = y * x * k + z * s; r.m[5] = y * y * k + c;     r.m[9] = y * z * k - x * s;
+    r.m[2] = x * z * k - y * s; r.m[6] = y * z * k + x * s; r.m[10] = z * z * k + c;
+    multiplyTop(&r);
+}
+
+void geomScalef(GLfloat x, GLfloat y, GLfloat z) {
+    if (!recordTarget) {
+        glScalef(x, y, z);
+        return;
+    }
+    Matrix4 s;
+    setIdentity(&s);
+    s.m[0] = x;
+    s.m[5] = y;
+    s.m[10] = z;
+    multiplyTop(&s);
+}
+
+// Same faces as glutSolidCube, emitted through the geom API so it can be recorded
+void geomSolidCube(GLfloat size) {
+    static const GLfloat normals[6][3] = {
+        {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f},
+        {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}
+    };
+    static const int faces[6][4] = {
+        {0, 1, 2, 3}, {3, 2, 6, 7}, {7, 6, 5, 4},
+        {4, 5, 1, 0}, {5, 6, 2, 1}, {7, 4, 0, 3}
+    };
+    GLfloat h = size / 2.0f;
+    GLfloat v[8][3] = {
+        {-h, -h, -h}, {-h, -h, h}, {-h, h, h}, {-h, h, -h},
+        {h, -h, -h}, {h, -h, h}, {h, h, h}, {h, h, -h}
+    };
+
+    geomBegin(GL_QUADS);
+    for (int i = 0; i < 6; i++) {
+        geomNormal3f(normals[i][0], normals[i][1], normals[i][2]);
+        for (int j = 0; j < 4; j++) {
+            const GLfloat* p = v[faces[i][j]];
+            geomVertex3f(p[0], p[1], p[2]);
+        }
+    }
+    geomEnd();
+}
+
+// Draw a cached primitive with the current matrix and material, then leave
+// the current normal where GLU would have left it
+void geomPrimitive(const Primitive* primitive) {
+    if (!recordTarget) {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glVertexPointer(3, GL_FLOAT, sizeof(MeshVertex), primitive->vertices[0].position);
+        glNormalPointer(GL_FLOAT, sizeof(MeshVertex), primitive->vertices[0].normal);
+        glDrawElements(GL_TRIANGLES, (GLsizei)primitive->indices.size(), GL_UNSIGNED_INT, &primitive->indices[0]);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glNormal3fv(primitive->lastNormal);
+        return;
+    }
+
+    GLuint base = (GLuint)recordTarget->vertices.size();
+    for (size_t i = 0; i < primitive->vertices.size(); i++) {
+        recordTarget->vertices.push_back(transformVertex(primitive->vertices[i].position, primitive->vertices[i].normal));
+    }
+    std::vector<GLuint> indices(primitive->indices.size());
+    for (size_t i = 0; i < indices.size(); i++) indices[i] = base + primitive->indices[i];
+    if (!indices.empty()) appendIndices(GL_TRIANGLES, &indices[0], indices.size());
+    geomNormal3f(primitive->lastNormal[0], primitive->lastNormal[1], primitive->lastNormal[2]);
+}
+
+void geomRecordBegin(Mesh* mesh) {
+    recordTarget = mesh;
+    matrixTop = 0;
+    setIdentity(&matrixStack[0]);
+    currentNormal[0] = 0.0f;
+    currentNormal[1] = 0.0f;
+    currentNormal[2] = 1.0f;
+    resetMaterial(&currentMaterial);
+    currentLineWidth = 1.0f;
+    primitiveVertices.clear();
+}
+
+// Keep matrix, normal and material state but send geometry to another mesh
+void geomRecordSwitch(Mesh* mesh) {
+    if (recordTarget) recordTarget = mesh;
+}
+
+void geomRecordEnd() {
+    recordTarget = NULL;
+}
+
+bool geomIsRecording() {
+    return recordTarget != NULL;
+}
+
+void meshApplyMaterial(const MeshMaterial* material) {
+    glMaterialfv(GL_FRONT, GL_AMBIENT, material->ambient);
+    glMaterialfv(GL_FRONT, GL_DIFFUSE, material->diffuse);
+    glMaterialfv(GL_FRONT, GL_SPECULAR, material->specular);
+    glMaterialfv(GL_FRONT, GL_EMISSION, material->emission);
+    glMaterialf(GL_FRONT, GL_SHININESS, material->shininess);
+}
+
+int meshMaterialId(const MeshMaterial* material) {
+    for (size_t i = 0; i < materialTable.size(); i++) {
+        if (memcmp(&materialTable[i], material, sizeof(MeshMaterial)) == 0) return (int)i;
+    }
+    materialTable.push_back(*material);
+    return (int)materialTable.size() - 1;
+}
+
+const std::vector<MeshMaterial>& meshMaterialTable() {
+    return materialTable;
+}
+
+// Move recorded geometry into a VBO pair, or compile it into a display list
+void meshUpload(Mesh* mesh) {
+    meshRelease(mesh);
+    mesh->materialIds.resize(mesh->materials.size());
+    for (size_t i = 0; i < mesh->materials.size(); i++) {
+        mesh->materialIds[i] = meshMaterialId(&mesh->materials[i]);
+    }
+    if (mesh->vertices.empty()) return;
+
+    if (glHasVertexBuffers) {
+        pglGenBuffers(1, &mesh->vertexBuffer);
+        pglBindBuffer(GL_ARRAY_BUFFER, mesh->vertexBuffer);
+        pglBufferData(GL_ARRAY_BUFFER, mesh->vertices.size() * sizeof(MeshVertex), &mesh->vertices[0], GL_STATIC_DRAW);
+
+        pglGenBuffers(1, &mesh->indexBuffer);
+        pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->indexBuffer);
+        pglBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->indices.size() * sizeof(GLuint), &mesh->indices[0], GL_STATIC_DRAW);
+
+        pglBindBuffer(GL_ARRAY_BUFFER, 0);
+        pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        return;
+    }
+
+    mesh->displayList = glGenLists(1);
+    glNewList(mesh->displayList, GL_COMPILE);
+    for (size_t b = 0; b < mesh->batches.size(); b++) {
+        const MeshBatch& batch = mesh->batches[b];
+        meshApplyMaterial(&mesh->materials[batch.material]);
+        if (batch.mode == GL_LINES) glLineWidth(batch.lineWidth);
+        glBegin(batch.mode);
+        for (GLuint i = 0; i < batch.indexCount; i++) {
+            const MeshVertex& v = mesh->vertices[mesh->indices[batch.firstIndex + i]];
+            glNormal3fv(v.normal);
+            glVertex3fv(v.position);
+        }
+        glEnd();
+    }
+    glEndList();
+}
+
+void meshDraw(const Mesh* mesh) {
+    if (mesh->displayList) {
+        glCallList(mesh->displayList);
+        renderStateReset();
+        return;
+    }
+    if (!mesh->vertexBuffer) return;
+
+    bool glsl = pipelineActive();
+    pglBindBuffer(GL_ARRAY_BUFFER, mesh->vertexBuffer);
+    pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->indexBuffer);
+    if (glsl) {
+        pipelineBegin();
+        pipelineSetVertexPointers();
+    } else {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glVertexPointer(3, GL_FLOAT, sizeof(MeshVertex), (const GLvoid*)0);
+        glNormalPointer(GL_FLOAT, sizeof(MeshVertex), (const GLvoid*)(3 * sizeof(GLfloat)));
+    }
+
+    for (size_t b = 0; b < mesh->batches.size(); b++) {
+        const MeshBatch& batch = mesh->batches[b];
+        if (glsl) {
+            pipelineSetMaterial(mesh->materialIds[batch.material]);
+        } else {
+            meshApplyMaterial(&mesh->materials[batch.material]);
+        }
+        if (batch.mode == GL_LINES) glLineWidth(batch.lineWidth);
+        glDrawElements(batch.mode, batch.indexCount, GL_UNSIGNED_INT,
+                       (const GLvoid*)(batch.firstIndex * sizeof(GLuint)));
+    }
+
+    if (glsl) {
+        pipelineEnd();
+    } else {
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_NORMAL_ARRAY);
+    }
+    pglBindBuffer(GL_ARRAY_BUFFER, 0);
+    pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    renderStateReset(); // Materials above bypassed the filter
+}
+
+void meshRelease(Mesh* mesh) {
+    if (mesh->vertexBuffer) pglDeleteBuffers(1, &mesh->vertexBuffer);
+    if (mesh->indexBuffer) pglDeleteBuffers(1, &mesh->indexBuffer);
+    if (mesh->displayList) glDeleteLists(mesh->displayList, 1);
+    mesh->vertexBuffer = 0;
+    mesh->indexBuffer = 0;
+    mesh->displayList = 0;
+}
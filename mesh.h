@@ -0,0 +1,87 @@
+#ifndef MESH_H
+#define MESH_H
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/glut.h>
+#include <vector>
+
+// Interleaved vertex layout shared by every retained mesh
+struct MeshVertex {
+    GLfloat position[3];
+    GLfloat normal[3];
+};
+
+// Front-face material state captured when a primitive was recorded
+struct MeshMaterial {
+    GLfloat ambient[4];
+    GLfloat diffuse[4];
+    GLfloat specular[4];
+    GLfloat emission[4];
+    GLfloat shininess;
+};
+
+// A run of indices drawn with one primitive type and one material
+struct MeshBatch {
+    GLenum mode;        // GL_TRIANGLES or GL_LINES
+    int material;       // Index into Mesh::materials
+    GLfloat lineWidth;
+    GLuint firstIndex;
+    GLuint indexCount;
+};
+
+// Geometry recorded once and drawn from GPU memory every frame
+struct Mesh {
+    std::vector<MeshVertex> vertices;
+    std::vector<GLuint> indices;
+    std::vector<MeshBatch> batches;
+    std::vector<MeshMaterial> materials;
+    std::vector<int> materialIds; // Global id of each material, see meshMaterialId()
+
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+    GLuint displayList;
+
+    Mesh() : vertexBuffer(0), indexBuffer(0), displayList(0) {}
+};
+
+struct Primitive;
+
+// Immediate-mode style drawing API. Calls go straight to OpenGL unless a
+// recording is active, in which case they are captured into a Mesh with the
+// current matrix and material baked in. Bump BIN_MESH_VERSION (meshcache.h)
+// when recording changes, so cached bin meshes are rebuilt.
+void geomBegin(GLenum mode);
+void geomEnd();
+void geomVertex3f(GLfloat x, GLfloat y, GLfloat z);
+void geomNormal3f(GLfloat x, GLfloat y, GLfloat z);
+void geomMaterialfv(GLenum face, GLenum pname, const GLfloat* params);
+void geomMaterialf(GLenum face, GLenum pname, GLfloat param);
+void geomLineWidth(GLfloat width);
+void geomPushMatrix();
+void geomPopMatrix();
+void geomTranslatef(GLfloat x, GLfloat y, GLfloat z);
+void geomRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z);
+void geomScalef(GLfloat x, GLfloat y, GLfloat z);
+void geomSolidCube(GLfloat size);
+void geomPrimitive(const Primitive* primitive);
+
+// Recording control
+void geomRecordBegin(Mesh* mesh);
+void geomRecordSwitch(Mesh* mesh);
+void geomRecordEnd();
+bool geomIsRecording();
+
+// GPU residency and drawing
+void meshUpload(Mesh* mesh);
+void meshDraw(const Mesh* mesh);
+void meshRelease(Mesh* mesh);
+void meshApplyMaterial(const MeshMaterial* material);
+
+// Equal materials share one id across all meshes, so draws can be sorted by material
+int meshMaterialId(const MeshMaterial* material);
+// Every material interned so far, indexed by id
+const std::vector<MeshMaterial>& meshMaterialTable();
+
+#endif
@@ -0,0 +1,169 @@
+#include "meshcache.h"
+#include "mappedfile.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MESH_CACHE_MAGIC      "BINMESH"
+#define MESH_CACHE_ENDIAN_TAG 0x01020304u
+#define MESH_CACHE_ALIGN      16 // Each array starts on this boundary
+
+struct MeshCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    uint64_t key;
+    uint32_t meshCount;
+    uint32_t vertexSize; // Record sizes, so a changed struct reads as a stale cache
+    uint32_t batchSize;
+    uint32_t materialSize;
+};
+
+// Where one mesh's arrays sit, as byte offsets from the start of the file
+struct MeshCacheEntry {
+    uint32_t vertexCount, indexCount, batchCount, materialCount;
+    uint64_t vertexOffset, indexOffset, batchOffset, materialOffset;
+};
+
+uint64_t meshCacheHash(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t alignOffset(uint64_t offset) {
+    return (offset + MESH_CACHE_ALIGN - 1) & ~(uint64_t)(MESH_CACHE_ALIGN - 1);
+}
+
+// Check an array lies inside the file and copy it out
+template <typename T>
+static bool readArray(const MappedFile* map, uint64_t offset, uint32_t count, std::vector<T>* out) {
+    if (offset > map->size || count > (map->size - offset) / sizeof(T)) return false;
+    const T* first = (const T*)((const char*)map->data + offset);
+    out->assign(first, first + count);
+    return true;
+}
+
+// Batches name existing materials and index ranges, and indices name existing vertices
+static bool meshConsistent(const Mesh* mesh) {
+    for (size_t b = 0; b < mesh->batches.size(); b++) {
+        const MeshBatch& batch = mesh->batches[b];
+        if ((batch.mode != GL_TRIANGLES && batch.mode != GL_LINES) || batch.material < 0 ||
+            (size_t)batch.material >= mesh->materials.size() || batch.firstIndex > mesh->indices.size() ||
+            batch.indexCount > mesh->indices.size() - batch.firstIndex) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < mesh->indices.size(); i++) {
+        if (mesh->indices[i] >= mesh->vertices.size()) return false;
+    }
+    return true;
+}
+
+bool meshCacheLoad(const char* path, uint64_t key, Mesh* const meshes[], int count) {
+    MappedFile map;
+    if (!mapFile(path, &map)) return false;
+
+    const MeshCacheHeader* header = (const MeshCacheHeader*)map.data;
+    const char* problem = NULL;
+    if (map.size < sizeof(MeshCacheHeader) || memcmp(header->magic, MESH_CACHE_MAGIC, 8) != 0 ||
+        header->version != MESH_CACHE_VERSION || header->endianTag != MESH_CACHE_ENDIAN_TAG ||
+        header->vertexSize != sizeof(MeshVertex) || header->batchSize != sizeof(MeshBatch) ||
+        header->materialSize != sizeof(MeshMaterial)) {
+        problem = "written by a different build";
+    } else if (header->key != key) {
+        problem = "geometry parameters changed";
+    } else if (header->meshCount != (uint32_t)count ||
+               map.size < sizeof(MeshCacheHeader) + count * sizeof(MeshCacheEntry)) {
+        problem = "unexpected mesh count";
+    }
+
+    const MeshCacheEntry* entries = (const MeshCacheEntry*)(header + 1);
+    for (int i = 0; !problem && i < count; i++) {
+        const MeshCacheEntry& entry = entries[i];
+        Mesh* mesh = meshes[i];
+        meshRelease(mesh);
+        *mesh = Mesh();
+        if (!readArray(&map, entry.vertexOffset, entry.vertexCount, &mesh->vertices) ||
+            !readArray(&map, entry.indexOffset, entry.indexCount, &mesh->indices) ||
+            !readArray(&map, entry.batchOffset, entry.batchCount, &mesh->batches) ||
+            !readArray(&map, entry.materialOffset, entry.materialCount, &mesh->materials)) {
+            problem = "truncated";
+        } else if (!meshConsistent(mesh)) {
+            problem = "damaged";
+        }
+    }
+    unmapFile(&map);
+
+    if (problem) {
+        printf("Mesh cache %s: %s\n", path, problem);
+        return false;
+    }
+    for (int i = 0; i < count; i++) meshUpload(meshes[i]);
+    return true;
+}
+
+// Pad the file from written up to offset, then write size bytes there
+static void writeAt(FILE* out, uint64_t* written, uint64_t offset, const void* data, size_t size, bool* ok) {
+    static const char padding[MESH_CACHE_ALIGN] = {0};
+    if (offset > *written) *ok = *ok && fwrite(padding, 1, (size_t)(offset - *written), out) == offset - *written;
+    if (size) *ok = *ok && fwrite(data, 1, size, out) == size;
+    *written = offset + size;
+}
+
+bool meshCacheSave(const char* path, uint64_t key, const Mesh* const meshes[], int count) {
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESH_CACHE_MAGIC, 8);
+    header.version = MESH_CACHE_VERSION;
+    header.endianTag = MESH_CACHE_ENDIAN_TAG;
+    header.key = key;
+    header.meshCount = count;
+    header.vertexSize = sizeof(MeshVertex);
+    header.batchSize = sizeof(MeshBatch);
+    header.materialSize = sizeof(MeshMaterial);
+
+    // Lay the arrays out after the entry table
+    std::vector<MeshCacheEntry> entries(count);
+    uint64_t offset = sizeof(header) + count * sizeof(MeshCacheEntry);
+    for (int i = 0; i < count; i++) {
+        const Mesh* mesh = meshes[i];
+        MeshCacheEntry& entry = entries[i];
+        entry.vertexCount = (uint32_t)mesh->vertices.size();
+        entry.indexCount = (uint32_t)mesh->indices.size();
+        entry.batchCount = (uint32_t)mesh->batches.size();
+        entry.materialCount = (uint32_t)mesh->materials.size();
+        entry.vertexOffset = offset = alignOffset(offset);
+        offset += entry.vertexCount * sizeof(MeshVertex);
+        entry.indexOffset = offset = alignOffset(offset);
+        offset += entry.indexCount * sizeof(GLuint);
+        entry.batchOffset = offset = alignOffset(offset);
+        offset += entry.batchCount * sizeof(MeshBatch);
+        entry.materialOffset = offset = alignOffset(offset);
+        offset += entry.materialCount * sizeof(MeshMaterial);
+    }
+
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        printf("Cannot write mesh cache %s\n", path);
+        return false;
+    }
+    uint64_t written = 0;
+    bool ok = true;
+    writeAt(out, &written, 0, &header, sizeof(header), &ok);
+    writeAt(out, &written, written, &entries[0], count * sizeof(MeshCacheEntry), &ok);
+    for (int i = 0; i < count; i++) {
+        const Mesh* mesh = meshes[i];
+        const MeshCacheEntry& entry = entries[i];
+        writeAt(out, &written, entry.vertexOffset, mesh->vertices.data(), entry.vertexCount * sizeof(MeshVertex), &ok);
+        writeAt(out, &written, entry.indexOffset, mesh->indices.data(), entry.indexCount * sizeof(GLuint), &ok);
+        writeAt(out, &written, entry.batchOffset, mesh->batches.data(), entry.batchCount * sizeof(MeshBatch), &ok);
+        writeAt(out, &written, entry.materialOffset, mesh->materials.data(), entry.materialCount * sizeof(MeshMaterial),
+                &ok);
+    }
+    ok = fclose(out) == 0 && ok;
+    if (!ok) printf("Error writing mesh cache %s\n", path);
+    return ok;
+}
@@ -0,0 +1,25 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include "mesh.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Baked meshes: recorded vertex, index, batch and material arrays written
+// as they sit in memory, so loading is a mapping, a copy and an upload.
+// The key should hash everything the recording depends on; a file with any
+// other key is ignored and rewritten.
+#define MESH_CACHE_PATH      "bin_meshes.cache"
+#define MESH_CACHE_VERSION   1 // Bump when the file layout changes
+#define BIN_MESH_VERSION     1 // Bump when the bin draw code, mesh recording or primitive tessellation changes
+#define MESH_CACHE_HASH_SEED 14695981039346656037ull
+
+// FNV-1a; pass the previous result as hash to chain several blocks
+uint64_t meshCacheHash(const void* data, size_t size, uint64_t hash = MESH_CACHE_HASH_SEED);
+
+// Replaces and uploads count meshes from the cache. Returns false, saying why,
+// if the file is missing, damaged, for another key or holds a different number of meshes.
+bool meshCacheLoad(const char* path, uint64_t key, Mesh* const meshes[], int count);
+bool meshCacheSave(const char* path, uint64_t key, const Mesh* const meshes[], int count);
+
+#endif
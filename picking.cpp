@@ -0,0 +1,97 @@
+#include "picking.h"
+#include "geomtables.h"
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define PICK_LID_GRIP 0.2f // Grip edge along each lid's front, proud of the body like the labels
+
+static void normalize(float v[3]) {
+    float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (length > 0.0f) {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+}
+
+static void cross(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+void pickRayFromCamera(const Camera* camera, int x, int y, int width, int height, PickRay* ray) {
+    // Same basis gluLookAt builds
+    float forward[3], side[3], up[3];
+    for (int k = 0; k < 3; k++) forward[k] = camera->target[k] - camera->eye[k];
+    normalize(forward);
+    cross(forward, camera->up, side);
+    normalize(side);
+    cross(side, forward, up);
+
+    // Pixel centers to normalized device coordinates, scaled to the view plane at distance 1
+    float tanHalf = tanf(camera->fovY * 0.5f * (float)M_PI / 180.0f);
+    float px = (2.0f * (x + 0.5f) / width - 1.0f) * tanHalf * camera->aspect;
+    float py = (1.0f - 2.0f * (y + 0.5f) / height) * tanHalf;
+    for (int k = 0; k < 3; k++) {
+        ray->origin[k] = camera->eye[k];
+        ray->direction[k] = forward[k] + side[k] * px + up[k] * py;
+    }
+    normalize(ray->direction);
+}
+
+void binBodyBox(Aabb* box) {
+    // Body and feet, out to the lid grips and labels at the front
+    box->min[0] = -BIN_TOTAL_WIDTH * 0.5f * 1.05f;
+    box->max[0] = BIN_TOTAL_WIDTH * 0.5f * 1.05f;
+    box->min[1] = 0.0f;
+    box->max[1] = BIN_LID_Y + LID_CURVE;
+    box->min[2] = -BIN_FRONT_Z;
+    box->max[2] = BIN_DEPTH * 0.5f + PICK_LID_GRIP;
+}
+
+void binLidBox(int compartment, Aabb* box) {
+    float center = BIN_COMPARTMENT_CENTER(compartment);
+    box->min[0] = center - BIN_COMPARTMENT_WIDTH * 0.5f;
+    box->max[0] = center + BIN_COMPARTMENT_WIDTH * 0.5f;
+    box->min[1] = BIN_LID_Y - LID_THICKNESS;
+    box->max[1] = BIN_LID_Y + LID_CURVE;
+    box->min[2] = -BIN_DEPTH * 0.5f;
+    box->max[2] = BIN_DEPTH * 0.5f + PICK_LID_GRIP;
+}
+
+float pickBin(const PickRay* ray, const float position[3], float yaw, int* lid) {
+    static Aabb body, lids[BIN_COMPARTMENT_COUNT];
+    static bool boxesReady = false;
+    if (!boxesReady) {
+        binBodyBox(&body);
+        for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) binLidBox(c, &lids[c]);
+        boxesReady = true;
+    }
+
+    // Into bin space: undo the translation, then the rotation about +Y
+    float radians = yaw * (float)M_PI / 180.0f;
+    float c = cosf(radians), s = sinf(radians);
+    float dx = ray->origin[0] - position[0];
+    float dz = ray->origin[2] - position[2];
+    float origin[3] = {c * dx - s * dz, ray->origin[1] - position[1], s * dx + c * dz};
+    float direction[3] = {c * ray->direction[0] - s * ray->direction[2], ray->direction[1],
+                          s * ray->direction[0] + c * ray->direction[2]};
+    float inverse[3] = {1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2]};
+
+    *lid = -1;
+    float distance;
+    if (!rayHitAabb(origin, inverse, &body, INFINITY, &distance)) return -1.0f;
+    float lidDistance = INFINITY;
+    for (int i = 0; i < BIN_COMPARTMENT_COUNT; i++) {
+        float hit;
+        if (rayHitAabb(origin, inverse, &lids[i], lidDistance, &hit) && hit < lidDistance) {
+            lidDistance = hit;
+            *lid = i;
+        }
+    }
+    return distance;
+}
@@ -0,0 +1,39 @@
+#ifndef PICKING_H
+#define PICKING_H
+
+#include "bin.h"
+#include "camera.h"
+#include "culling.h"
+
+// Ray picking on the CPU: the cursor is unprojected through the camera the
+// frame was drawn with, then tested against bin boxes and per-lid boxes.
+
+struct PickRay {
+    float origin[3];
+    float direction[3]; // Unit length
+};
+
+struct PickResult {
+    int bin;        // Fleet index (0 for the single bin), -1 when nothing is under the cursor
+    int lid;        // BinCompartment whose lid was hit, -1 for the rest of the bin
+    float distance; // Along the ray
+};
+
+struct PickStats {
+    unsigned long picks;
+    unsigned long nodesTested; // Hierarchy nodes visited by the last pick
+    double lastUs, maxUs;
+};
+
+// Ray through window pixel (x, y), y down as GLUT reports it
+void pickRayFromCamera(const Camera* camera, int x, int y, int width, int height, PickRay* ray);
+
+// Boxes in bin space, from the constants the bin is drawn with. Lids are closed.
+void binBodyBox(Aabb* box);
+void binLidBox(int compartment, Aabb* box);
+
+// Ray against one bin placed at position with yaw degrees about +Y. Returns the
+// hit distance, or -1 for a miss, with the lid hit (or -1) in *lid.
+float pickBin(const PickRay* ray, const float position[3], float yaw, int* lid);
+
+#endif
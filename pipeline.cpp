@@ -0,0 +1,160 @@
+#include "pipeline.h"
+#include "shader.h"
+#include <stdio.h>
+
+int renderPipeline = PIPELINE_FIXED;
+
+// Scene ambient, then position, ambient, diffuse and specular for each light
+#define LIGHT_VECTORS (1 + 4 * PIPELINE_LIGHT_COUNT)
+
+enum {
+    ATTRIB_POSITION,
+    ATTRIB_NORMAL
+};
+
+// Same lighting equation as shaderLightingSource, with every input coming from
+// uniform arrays that are uploaded once instead of per draw
+static const char* pipelineVertexSource =
+    "attribute vec3 position;\n"
+    "attribute vec3 normal;\n"
+    "uniform vec4 lights[LIGHT_VECTORS];\n"
+    "uniform vec4 materials[4 * MAX_MATERIALS];\n"
+    "uniform int material;\n"
+    "varying vec4 color;\n"
+    "void main() {\n"
+    "    vec4 eyePosition = gl_ModelViewMatrix * vec4(position, 1.0);\n"
+    "    // Recorded normals are unit length and the modelview is rigid, so no normalize()\n"
+    "    vec3 eyeNormal = gl_NormalMatrix * normal;\n"
+    "    vec4 ambient = materials[4 * material];\n"
+    "    vec4 diffuse = materials[4 * material + 1];\n"
+    "    vec4 specular = materials[4 * material + 2];\n"
+    "    vec4 emission = vec4(materials[4 * material + 3].rgb, 0.0);\n"
+    "    float shininess = materials[4 * material + 3].a;\n"
+    "    vec4 result = emission + lights[0] * ambient;\n"
+    "    for (int i = 0; i < LIGHT_COUNT; i++) {\n"
+    "        vec4 lightPosition = lights[1 + 4 * i];\n"
+    "        vec3 L = normalize(lightPosition.w == 0.0 ? lightPosition.xyz : lightPosition.xyz - eyePosition.xyz);\n"
+    "        float NdotL = max(dot(eyeNormal, L), 0.0);\n"
+    "        result += lights[2 + 4 * i] * ambient + NdotL * lights[3 + 4 * i] * diffuse;\n"
+    "        if (NdotL > 0.0) {\n"
+    "            vec3 H = normalize(L + vec3(0.0, 0.0, 1.0));\n"
+    "            result += pow(max(dot(eyeNormal, H), 1e-4), shininess) * lights[4 + 4 * i] * specular;\n"
+    "        }\n"
+    "    }\n"
+    "    color = vec4(clamp(result.rgb, 0.0, 1.0), diffuse.a);\n"
+    "    gl_Position = gl_ProjectionMatrix * eyePosition;\n"
+    "}\n";
+
+static const char* pipelineFragmentSource =
+    "varying vec4 color;\n"
+    "void main() {\n"
+    "    gl_FragColor = color;\n"
+    "}\n";
+
+static GLuint program = 0;
+static GLint uniformLights, uniformMaterials, uniformMaterial;
+static size_t uploadedMaterials = 0; // Table entries already in the uniform array
+static int currentMaterial = -1;
+
+bool pipelineInit() {
+    if (renderPipeline != PIPELINE_GLSL) return false;
+
+    char header[128];
+    snprintf(header, sizeof(header),
+             "#version 120\n#define LIGHT_COUNT %d\n#define LIGHT_VECTORS %d\n#define MAX_MATERIALS %d\n",
+             PIPELINE_LIGHT_COUNT, LIGHT_VECTORS, PIPELINE_MAX_MATERIALS);
+    const char* vertexSources[2] = {header, pipelineVertexSource};
+    const char* fragmentSources[2] = {"#version 120\n", pipelineFragmentSource};
+    const char* attributes[3] = {"position", "normal", NULL};
+    program = buildShaderProgram("Pipeline", vertexSources, 2, fragmentSources, 2, attributes);
+    if (!program) {
+        printf("GLSL pipeline unavailable, using fixed-function lighting\n");
+        renderPipeline = PIPELINE_FIXED;
+        return false;
+    }
+    uniformLights = pglGetUniformLocation(program, "lights");
+    uniformMaterials = pglGetUniformLocation(program, "materials");
+    uniformMaterial = pglGetUniformLocation(program, "material");
+
+    // Light positions come back in eye space, as transformed when they were set
+    GLfloat lights[LIGHT_VECTORS][4];
+    glGetFloatv(GL_LIGHT_MODEL_AMBIENT, lights[0]);
+    for (int i = 0; i < PIPELINE_LIGHT_COUNT; i++) {
+        GLenum light = GL_LIGHT0 + i;
+        glGetLightfv(light, GL_POSITION, lights[1 + 4 * i]);
+        glGetLightfv(light, GL_AMBIENT, lights[2 + 4 * i]);
+        glGetLightfv(light, GL_DIFFUSE, lights[3 + 4 * i]);
+        glGetLightfv(light, GL_SPECULAR, lights[4 + 4 * i]);
+        if (!glIsEnabled(light)) {
+            for (int k = 2; k <= 4; k++) lights[k + 4 * i][0] = lights[k + 4 * i][1] = lights[k + 4 * i][2] = 0.0f;
+        }
+    }
+    pglUseProgram(program);
+    pglUniform4fv(uniformLights, LIGHT_VECTORS, lights[0]);
+    pglUseProgram(0);
+    uploadedMaterials = 0;
+
+    printf("Lighting pipeline: GLSL, %d lights, up to %d materials\n", PIPELINE_LIGHT_COUNT, PIPELINE_MAX_MATERIALS);
+    return true;
+}
+
+void pipelineRelease() {
+    if (program) pglDeleteProgram(program);
+    program = 0;
+}
+
+const char* pipelineName() {
+    return renderPipeline == PIPELINE_GLSL ? "glsl" : "fixed";
+}
+
+bool pipelineActive() {
+    if (renderPipeline != PIPELINE_GLSL || !program) return false;
+    if (meshMaterialTable().size() > PIPELINE_MAX_MATERIALS) {
+        printf("GLSL pipeline: more than %d materials, using fixed-function lighting\n", PIPELINE_MAX_MATERIALS);
+        renderPipeline = PIPELINE_FIXED;
+        glEnable(GL_NORMALIZE);
+        return false;
+    }
+    return true;
+}
+
+void pipelineBegin() {
+    pglUseProgram(program);
+    const std::vector<MeshMaterial>& table = meshMaterialTable();
+    if (table.size() > uploadedMaterials) {
+        // The table only grows while meshes are recorded, so resending all of it is rare
+        std::vector<GLfloat> packed(16 * table.size());
+        for (size_t i = 0; i < table.size(); i++) {
+            const MeshMaterial& material = table[i];
+            GLfloat* out = &packed[16 * i];
+            for (int k = 0; k < 4; k++) out[k] = material.ambient[k];
+            for (int k = 0; k < 4; k++) out[4 + k] = material.diffuse[k];
+            for (int k = 0; k < 4; k++) out[8 + k] = material.specular[k];
+            for (int k = 0; k < 3; k++) out[12 + k] = material.emission[k];
+            out[15] = material.shininess;
+        }
+        pglUniform4fv(uniformMaterials, (GLsizei)(4 * table.size()), &packed[0]);
+        uploadedMaterials = table.size();
+    }
+    currentMaterial = -1;
+    pglEnableVertexAttribArray(ATTRIB_POSITION);
+    pglEnableVertexAttribArray(ATTRIB_NORMAL);
+}
+
+void pipelineEnd() {
+    pglDisableVertexAttribArray(ATTRIB_POSITION);
+    pglDisableVertexAttribArray(ATTRIB_NORMAL);
+    pglUseProgram(0);
+}
+
+void pipelineSetVertexPointers() {
+    pglVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (const GLvoid*)0);
+    pglVertexAttribPointer(ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (const GLvoid*)(3 * sizeof(GLfloat)));
+}
+
+bool pipelineSetMaterial(int id) {
+    if (id == currentMaterial) return false;
+    pglUniform1i(uniformMaterial, id);
+    currentMaterial = id;
+    return true;
+}
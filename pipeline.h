@@ -0,0 +1,35 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "mesh.h"
+
+#define PIPELINE_LIGHT_COUNT   2  // GL_LIGHT0 and GL_LIGHT1, as set up in init()
+#define PIPELINE_MAX_MATERIALS 24 // Size of the shader's material table, four vec4 each
+
+// How retained meshes are transformed and lit
+enum RenderPipeline {
+    PIPELINE_FIXED, // Fixed-function lighting, normals renormalized by GL_NORMALIZE
+    PIPELINE_GLSL   // Shader reading lights and materials from uniform arrays
+};
+
+// Chosen at startup (--pipeline); falls back to PIPELINE_FIXED without shaders
+extern int renderPipeline;
+
+// Call once the lights are set up. Light parameters are copied into the
+// shader here, so later glLight calls are not seen by the GLSL pipeline.
+bool pipelineInit();
+void pipelineRelease();
+const char* pipelineName();
+
+// True when retained meshes should be drawn with the GLSL program
+bool pipelineActive();
+
+// Bracket GLSL draws; begin binds the program and uploads newly interned materials
+void pipelineBegin();
+void pipelineEnd();
+// Point the shader attributes at the bound mesh vertex buffer
+void pipelineSetVertexPointers();
+// Select a material by meshMaterialId(); returns false when it was already current
+bool pipelineSetMaterial(int id);
+
+#endif
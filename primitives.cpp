@@ -0,0 +1,144 @@
+#include "primitives.h"
+#include <math.h>
+#include <stdio.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+enum PrimitiveKind {
+    PRIMITIVE_CYLINDER,
+    PRIMITIVE_PARTIAL_DISK
+};
+
+struct PrimitiveKey {
+    int kind;
+    float radius;
+    float height;
+    int segments;
+    float sweep;
+};
+
+struct PrimitiveEntry {
+    PrimitiveKey key;
+    Primitive* primitive;
+};
+
+// Only a handful of distinct shapes exist, so a linear scan beats hashing
+static std::vector<PrimitiveEntry> cache;
+static PrimitiveCacheStats stats = {0, 0, 0};
+
+static void addVertex(Primitive* primitive, float px, float py, float pz, float nx, float ny, float nz) {
+    MeshVertex vertex;
+    vertex.position[0] = px;
+    vertex.position[1] = py;
+    vertex.position[2] = pz;
+    vertex.normal[0] = nx;
+    vertex.normal[1] = ny;
+    vertex.normal[2] = nz;
+    primitive->vertices.push_back(vertex);
+}
+
+static Primitive* tessellateCylinder(float radius, float height, int segments) {
+    Primitive* primitive = new Primitive();
+    for (int i = 0; i <= segments; i++) {
+        float angle = 2.0f * (float)M_PI * (i == segments ? 0 : i) / segments;
+        float s = sinf(angle);
+        float c = cosf(angle);
+        addVertex(primitive, radius * s, radius * c, 0.0f, s, c, 0.0f);
+        addVertex(primitive, radius * s, radius * c, height, s, c, 0.0f);
+    }
+    for (int i = 0; i < segments; i++) {
+        GLuint b = (GLuint)(2 * i);
+        GLuint quad[6] = {b, b + 1, b + 3, b, b + 3, b + 2};
+        primitive->indices.insert(primitive->indices.end(), quad, quad + 6);
+    }
+    // GLU's last normal is the final ring vertex, which is back at angle zero
+    primitive->lastNormal[0] = 0.0f;
+    primitive->lastNormal[1] = 1.0f;
+    primitive->lastNormal[2] = 0.0f;
+    return primitive;
+}
+
+static Primitive* tessellatePartialDisk(float radius, int segments, float sweep) {
+    Primitive* primitive = new Primitive();
+    addVertex(primitive, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+
+    // Walk the sweep backwards so triangles wind counter-clockwise seen from +Z
+    for (int i = segments; i >= 0; i--) {
+        float angle = sweep * i / segments * (float)M_PI / 180.0f;
+        addVertex(primitive, radius * sinf(angle), radius * cosf(angle), 0.0f, 0.0f, 0.0f, 1.0f);
+    }
+    for (int i = 1; i <= segments; i++) {
+        GLuint tri[3] = {0, (GLuint)i, (GLuint)i + 1};
+        primitive->indices.insert(primitive->indices.end(), tri, tri + 3);
+    }
+    primitive->lastNormal[0] = 0.0f;
+    primitive->lastNormal[1] = 0.0f;
+    primitive->lastNormal[2] = 1.0f;
+    return primitive;
+}
+
+static const Primitive* lookup(int kind, float radius, float height, int segments, float sweep) {
+    stats.lookups++;
+    for (size_t i = 0; i < cache.size(); i++) {
+        const PrimitiveKey& key = cache[i].key;
+        if (key.kind == kind && key.radius == radius && key.height == height && key.segments == segments &&
+            key.sweep == sweep) {
+            return cache[i].primitive;
+        }
+    }
+
+    PrimitiveEntry entry;
+    entry.key.kind = kind;
+    entry.key.radius = radius;
+    entry.key.height = height;
+    entry.key.segments = segments;
+    entry.key.sweep = sweep;
+    if (kind == PRIMITIVE_CYLINDER) {
+        entry.primitive = tessellateCylinder(radius, height, segments);
+    } else {
+        entry.primitive = tessellatePartialDisk(radius, segments, sweep);
+    }
+    cache.push_back(entry);
+    stats.tessellations++;
+    return entry.primitive;
+}
+
+const Primitive* primitiveCylinder(float radius, float height, int segments) {
+    return lookup(PRIMITIVE_CYLINDER, radius, height, segments, 360.0f);
+}
+
+const Primitive* primitivePartialDisk(float radius, int segments, float sweep) {
+    return lookup(PRIMITIVE_PARTIAL_DISK, radius, 0.0f, segments, sweep);
+}
+
+const Primitive* primitiveDisk(float radius, int segments) {
+    return lookup(PRIMITIVE_PARTIAL_DISK, radius, 0.0f, segments, 360.0f);
+}
+
+void primitiveCountQuadricAvoided() {
+    stats.quadricsAvoided++;
+}
+
+const PrimitiveCacheStats* primitiveCacheStats() {
+    return &stats;
+}
+
+void printPrimitiveCacheStats() {
+    size_t bytes = 0;
+    for (size_t i = 0; i < cache.size(); i++) {
+        bytes += cache[i].primitive->vertices.size() * sizeof(MeshVertex);
+        bytes += cache[i].primitive->indices.size() * sizeof(GLuint);
+    }
+    printf("Primitive cache: %u shapes (%u bytes)\n", (unsigned)cache.size(), (unsigned)bytes);
+    printf("  Lookups:                %lu\n", stats.lookups);
+    printf("  Tessellations:          %lu\n", stats.tessellations);
+    printf("  Tessellations avoided:  %lu\n", stats.lookups - stats.tessellations);
+    printf("  Quadric allocs avoided: %lu\n", stats.quadricsAvoided);
+}
+
+void clearPrimitiveCache() {
+    for (size_t i = 0; i < cache.size(); i++) delete cache[i].primitive;
+    cache.clear();
+}
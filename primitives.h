@@ -0,0 +1,31 @@
+#ifndef PRIMITIVES_H
+#define PRIMITIVES_H
+
+#include "mesh.h"
+
+// Pre-tessellated quadric shape, generated once and shared by every caller.
+// Bin meshes are cached on disk: bump BIN_MESH_VERSION when tessellation changes.
+struct Primitive {
+    std::vector<MeshVertex> vertices;
+    std::vector<GLuint> indices;  // GL_TRIANGLES
+    GLfloat lastNormal[3];        // Current normal GLU would leave behind after drawing
+};
+
+struct PrimitiveCacheStats {
+    unsigned long lookups;         // Primitives requested by draw code
+    unsigned long tessellations;   // Primitives actually generated
+    unsigned long quadricsAvoided; // gluNewQuadric/gluDeleteQuadric pairs no longer made
+};
+
+// Open cylinder side along +Z, smooth normals (gluCylinder layout)
+const Primitive* primitiveCylinder(float radius, float height, int segments);
+// Disk sector in the XY plane facing +Z, sweep in degrees from +Y towards +X (gluPartialDisk layout)
+const Primitive* primitivePartialDisk(float radius, int segments, float sweep);
+const Primitive* primitiveDisk(float radius, int segments);
+
+void primitiveCountQuadricAvoided();
+const PrimitiveCacheStats* primitiveCacheStats();
+void printPrimitiveCacheStats();
+void clearPrimitiveCache();
+
+#endif
@@ -0,0 +1,432 @@
+#include "profiler.h"
+#include "gl_ext.h"
+#include <GL/glut.h>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+bool profilerEnabled = false;
+
+struct ProfileSample {
+    float cpuMs;
+    float gpuMs;
+    unsigned calls;
+};
+
+struct ProfileFrame {
+    unsigned long index;
+    float frameMs;
+    bool hasGpu;
+    ProfileSample scopes[PROFILE_MAX_SCOPES];
+};
+
+// GPU queries issued during one frame, waiting for their results
+struct QuerySlot {
+    std::vector<GLuint> queries;
+    std::vector<unsigned> masks; // Scopes open while each query ran; its time counts toward all of them
+    size_t used;
+    bool pending;
+    ProfileFrame frame;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static const char* scopeNames[PROFILE_MAX_SCOPES];
+static int scopeCount = 0;
+
+static std::vector<ProfileFrame> history; // Ring of finished frames, oldest at historyStart
+static size_t historyStart = 0;
+static unsigned long frameNumber = 0;
+
+static QuerySlot slots[PROFILE_QUERY_LATENCY];
+static bool useGpuTimers = false;
+static bool inFrame = false;
+static ProfileFrame current;
+static Clock::time_point frameStart;
+
+// Open scopes
+static int stack[PROFILE_MAX_SCOPES];
+static Clock::time_point stackStart[PROFILE_MAX_SCOPES];
+static int depth = 0;
+static bool queryOpen = false;
+
+void profilerInit() {
+    useGpuTimers = glHasTimerQueries;
+    for (int i = 0; i < PROFILE_QUERY_LATENCY; i++) {
+        slots[i].used = 0;
+        slots[i].pending = false;
+    }
+}
+
+void profilerSetEnabled(bool enabled) {
+    profilerEnabled = enabled;
+    printf("Profiler: %s (%s)\n", enabled ? "on" : "off", useGpuTimers ? "CPU and GPU times" : "CPU times only");
+}
+
+void profilerRelease() {
+    for (int i = 0; i < PROFILE_QUERY_LATENCY; i++) {
+        if (!slots[i].queries.empty()) pglDeleteQueries((GLsizei)slots[i].queries.size(), &slots[i].queries[0]);
+        slots[i].queries.clear();
+        slots[i].masks.clear();
+        slots[i].pending = false;
+    }
+    history.clear();
+    historyStart = 0;
+}
+
+int profilerRegisterScope(const char* name) {
+    for (int i = 0; i < scopeCount; i++) {
+        if (strcmp(scopeNames[i], name) == 0) return i;
+    }
+    if (scopeCount == PROFILE_MAX_SCOPES) {
+        printf("Profiler: too many scopes, ignoring %s\n", name);
+        return -1;
+    }
+    scopeNames[scopeCount] = name;
+    return scopeCount++;
+}
+
+static void storeFrame(const ProfileFrame& frame) {
+    if (history.size() < PROFILE_HISTORY) {
+        history.push_back(frame);
+    } else {
+        history[historyStart] = frame;
+        historyStart = (historyStart + 1) % PROFILE_HISTORY;
+    }
+}
+
+static const ProfileFrame& historyFrame(size_t i) {
+    return history[(historyStart + i) % history.size()];
+}
+
+// Read back a slot's queries if the last one has finished (queries complete in order).
+// With wait set, block instead; with drop set, give up on the GPU times.
+static bool collectSlot(QuerySlot* slot, bool wait, bool drop) {
+    if (!slot->pending) return true;
+
+    if (!drop && slot->used > 0) {
+        GLint available = 0;
+        if (!wait) pglGetQueryObjectiv(slot->queries[slot->used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available || wait) {
+            for (size_t q = 0; q < slot->used; q++) {
+                GLuint64 nanoseconds = 0;
+                pglGetQueryObjectui64v(slot->queries[q], GL_QUERY_RESULT, &nanoseconds);
+                for (int id = 0; id < scopeCount; id++) {
+                    if (slot->masks[q] & (1u << id)) slot->frame.scopes[id].gpuMs += nanoseconds * 1e-6f;
+                }
+            }
+            slot->frame.hasGpu = true;
+        } else {
+            return false;
+        }
+    }
+
+    storeFrame(slot->frame);
+    slot->pending = false;
+    return true;
+}
+
+// Finish frames oldest first so history stays in order
+static void collectFinished(bool wait) {
+    for (int i = 0; i < PROFILE_QUERY_LATENCY; i++) {
+        QuerySlot* slot = &slots[(frameNumber + i) % PROFILE_QUERY_LATENCY];
+        if (!collectSlot(slot, wait, false)) {
+            if (i > 0) return;
+            collectSlot(slot, false, true); // The slot is needed now: keep its CPU times only
+        }
+    }
+}
+
+// GL_TIME_ELAPSED queries cannot nest, so each scope boundary ends the running
+// query and starts another tagged with the scopes now open
+static void closeQuery() {
+    if (!queryOpen) return;
+    pglEndQuery(GL_TIME_ELAPSED);
+    queryOpen = false;
+}
+
+static void openQuery() {
+    QuerySlot* slot = &slots[frameNumber % PROFILE_QUERY_LATENCY];
+    if (slot->used == slot->queries.size()) {
+        GLuint query;
+        pglGenQueries(1, &query);
+        slot->queries.push_back(query);
+        slot->masks.push_back(0);
+    }
+    unsigned mask = 0;
+    for (int i = 0; i < depth; i++) mask |= 1u << stack[i];
+    slot->masks[slot->used] = mask;
+    pglBeginQuery(GL_TIME_ELAPSED, slot->queries[slot->used]);
+    slot->used++;
+    queryOpen = true;
+}
+
+void profilerBeginFrame() {
+    if (!profilerEnabled) return;
+    if (useGpuTimers) collectFinished(false);
+
+    memset(&current, 0, sizeof(current));
+    current.index = frameNumber;
+    slots[frameNumber % PROFILE_QUERY_LATENCY].used = 0;
+    depth = 0;
+    inFrame = true;
+    frameStart = Clock::now();
+}
+
+void profilerEndFrame() {
+    if (!inFrame) return;
+    inFrame = false;
+
+    std::chrono::duration<float, std::milli> elapsed = Clock::now() - frameStart;
+    current.frameMs = elapsed.count();
+
+    QuerySlot* slot = &slots[frameNumber % PROFILE_QUERY_LATENCY];
+    if (useGpuTimers && slot->used > 0) {
+        slot->frame = current;
+        slot->pending = true;
+    } else {
+        storeFrame(current);
+    }
+    frameNumber++;
+}
+
+void profilerBeginScope(int id) {
+    if (!inFrame || id < 0 || depth == PROFILE_MAX_SCOPES) return;
+    if (useGpuTimers) closeQuery();
+    stack[depth] = id;
+    stackStart[depth] = Clock::now();
+    depth++;
+    current.scopes[id].calls++;
+    if (useGpuTimers) openQuery();
+}
+
+void profilerEndScope(int id) {
+    if (!inFrame || depth == 0 || stack[depth - 1] != id) return;
+    depth--;
+    std::chrono::duration<float, std::milli> elapsed = Clock::now() - stackStart[depth];
+    current.scopes[id].cpuMs += elapsed.count();
+    if (useGpuTimers) {
+        closeQuery();
+        if (depth > 0) openQuery(); // The rest belongs to the enclosing scopes
+    }
+}
+
+// Nearest-rank percentile of an unsorted copy
+static float percentile(std::vector<float> values, float fraction) {
+    if (values.empty()) return 0.0f;
+    size_t rank = (size_t)ceilf(fraction * values.size());
+    if (rank > 0) rank--;
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+static void drawText(int x, int y, const char* text) {
+    glRasterPos2i(x, y);
+    for (const char* c = text; *c; c++) glutBitmapCharacter(GLUT_BITMAP_8_BY_13, *c);
+}
+
+void profilerDrawOverlay(int windowWidth, int windowHeight) {
+    size_t count = history.size() < PROFILE_OVERLAY_FRAMES ? history.size() : PROFILE_OVERLAY_FRAMES;
+    if (count == 0) return;
+
+    // Averages over the newest frames; GPU columns only cover frames whose queries came back
+    float frameMs = 0.0f;
+    float cpuMs[PROFILE_MAX_SCOPES] = {0}, gpuMs[PROFILE_MAX_SCOPES] = {0};
+    float calls[PROFILE_MAX_SCOPES] = {0};
+    int gpuFrames = 0;
+    for (size_t i = history.size() - count; i < history.size(); i++) {
+        const ProfileFrame& frame = historyFrame(i);
+        frameMs += frame.frameMs;
+        if (frame.hasGpu) gpuFrames++;
+        for (int id = 0; id < scopeCount; id++) {
+            cpuMs[id] += frame.scopes[id].cpuMs;
+            gpuMs[id] += frame.scopes[id].gpuMs;
+            calls[id] += frame.scopes[id].calls;
+        }
+    }
+
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0, windowWidth, 0, windowHeight, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    char line[128];
+    int y = windowHeight - 18;
+    glColor3f(0.0f, 0.0f, 0.0f);
+    snprintf(line, sizeof(line), "Frame %.2f ms (%.0f fps), last %u frames", frameMs / count,
+             frameMs > 0.0f ? 1000.0f * count / frameMs : 0.0f, (unsigned)count);
+    drawText(10, y, line);
+    y -= 16;
+    drawText(10, y, "Scope                      calls   CPU ms   GPU ms");
+    for (int id = 0; id < scopeCount; id++) {
+        if (calls[id] == 0.0f) continue;
+        y -= 14;
+        if (gpuFrames > 0) {
+            snprintf(line, sizeof(line), "%-24s %7.1f %8.3f %8.3f", scopeNames[id], calls[id] / count,
+                     cpuMs[id] / count, gpuMs[id] / gpuFrames);
+        } else {
+            snprintf(line, sizeof(line), "%-24s %7.1f %8.3f      n/a", scopeNames[id], calls[id] / count,
+                     cpuMs[id] / count);
+        }
+        drawText(10, y, line);
+    }
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+}
+
+struct ScopeSummary {
+    float mean, p50, p90, p99, max;
+};
+
+static ScopeSummary summarize(const std::vector<float>& values) {
+    ScopeSummary summary = {0, 0, 0, 0, 0};
+    if (values.empty()) return summary;
+    double sum = 0.0;
+    for (size_t i = 0; i < values.size(); i++) {
+        sum += values[i];
+        if (values[i] > summary.max) summary.max = values[i];
+    }
+    summary.mean = (float)(sum / values.size());
+    summary.p50 = percentile(values, 0.50f);
+    summary.p90 = percentile(values, 0.90f);
+    summary.p99 = percentile(values, 0.99f);
+    return summary;
+}
+
+// Frame time plus each scope's CPU and GPU time, across recorded frames where the scope ran
+static void collectSeries(int id, bool gpu, std::vector<float>* values) {
+    values->clear();
+    for (size_t i = 0; i < history.size(); i++) {
+        const ProfileFrame& frame = historyFrame(i);
+        if (id < 0) {
+            values->push_back(frame.frameMs);
+        } else if (frame.scopes[id].calls > 0 && (!gpu || frame.hasGpu)) {
+            values->push_back(gpu ? frame.scopes[id].gpuMs : frame.scopes[id].cpuMs);
+        }
+    }
+}
+
+static void writeSummaryJson(FILE* file, const char* name, const ScopeSummary& s, size_t count) {
+    fprintf(file, "\"%s\": {\"samples\": %u, \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f}",
+            name, (unsigned)count, s.mean, s.p50, s.p90, s.p99, s.max);
+}
+
+static bool dumpJson(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    std::vector<float> values;
+    fprintf(file, "{\n  \"frames\": %u,\n  \"gpu_timers\": %s,\n", (unsigned)history.size(),
+            useGpuTimers ? "true" : "false");
+    collectSeries(-1, false, &values);
+    fprintf(file, "  ");
+    writeSummaryJson(file, "frame_ms", summarize(values), values.size());
+    fprintf(file, ",\n  \"scopes\": [\n");
+    for (int id = 0; id < scopeCount; id++) {
+        fprintf(file, "    {\"name\": \"%s\", ", scopeNames[id]);
+        collectSeries(id, false, &values);
+        writeSummaryJson(file, "cpu_ms", summarize(values), values.size());
+        fprintf(file, ", ");
+        collectSeries(id, true, &values);
+        writeSummaryJson(file, "gpu_ms", summarize(values), values.size());
+        fprintf(file, "}%s\n", id + 1 < scopeCount ? "," : "");
+    }
+    fprintf(file, "  ],\n  \"samples\": [\n");
+    for (size_t i = 0; i < history.size(); i++) {
+        const ProfileFrame& frame = historyFrame(i);
+        fprintf(file, "    {\"frame\": %lu, \"frame_ms\": %.4f, \"scopes\": {", frame.index, frame.frameMs);
+        bool first = true;
+        for (int id = 0; id < scopeCount; id++) {
+            const ProfileSample& sample = frame.scopes[id];
+            if (sample.calls == 0) continue;
+            fprintf(file, "%s\"%s\": {\"calls\": %u, \"cpu_ms\": %.4f", first ? "" : ", ", scopeNames[id], sample.calls,
+                    sample.cpuMs);
+            if (frame.hasGpu) fprintf(file, ", \"gpu_ms\": %.4f", sample.gpuMs);
+            fprintf(file, "}");
+            first = false;
+        }
+        fprintf(file, "}}%s\n", i + 1 < history.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+// Samples go to path; the percentile table goes next to it as <name>_summary.csv
+static bool dumpCsv(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "frame,frame_ms,scope,calls,cpu_ms,gpu_ms\n");
+    for (size_t i = 0; i < history.size(); i++) {
+        const ProfileFrame& frame = historyFrame(i);
+        for (int id = 0; id < scopeCount; id++) {
+            const ProfileSample& sample = frame.scopes[id];
+            if (sample.calls == 0) continue;
+            fprintf(file, "%lu,%.4f,%s,%u,%.4f,", frame.index, frame.frameMs, scopeNames[id], sample.calls,
+                    sample.cpuMs);
+            if (frame.hasGpu) fprintf(file, "%.4f", sample.gpuMs);
+            fprintf(file, "\n");
+        }
+    }
+    if (fclose(file) != 0) return false;
+
+    std::string summaryPath = path;
+    size_t dot = summaryPath.rfind('.');
+    if (dot == std::string::npos || summaryPath.find_first_of("/\\", dot) != std::string::npos) dot = summaryPath.size();
+    summaryPath.insert(dot, "_summary");
+    file = fopen(summaryPath.c_str(), "w");
+    if (!file) return false;
+
+    std::vector<float> values;
+    fprintf(file, "scope,clock,samples,mean_ms,p50_ms,p90_ms,p99_ms,max_ms\n");
+    collectSeries(-1, false, &values);
+    ScopeSummary s = summarize(values);
+    fprintf(file, "frame,cpu,%u,%.4f,%.4f,%.4f,%.4f,%.4f\n", (unsigned)values.size(), s.mean, s.p50, s.p90, s.p99,
+            s.max);
+    for (int id = 0; id < scopeCount; id++) {
+        for (int gpu = 0; gpu < 2; gpu++) {
+            collectSeries(id, gpu != 0, &values);
+            if (values.empty()) continue;
+            s = summarize(values);
+            fprintf(file, "%s,%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f\n", scopeNames[id], gpu ? "gpu" : "cpu",
+                    (unsigned)values.size(), s.mean, s.p50, s.p90, s.p99, s.max);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+bool profilerDump(const char* path) {
+    if (useGpuTimers) collectFinished(true);
+    if (history.empty()) {
+        printf("Profiler: no frames recorded\n");
+        return false;
+    }
+
+    const char* extension = strrchr(path, '.');
+    bool json = extension && strcmp(extension, ".json") == 0;
+    bool ok = json ? dumpJson(path) : dumpCsv(path);
+    if (!ok) {
+        printf("Profiler: failed to write %s\n", path);
+        return false;
+    }
+
+    std::vector<float> values;
+    collectSeries(-1, false, &values);
+    ScopeSummary s = summarize(values);
+    printf("Profiler: wrote %u frames to %s (frame p50 %.3f ms, p99 %.3f ms)\n", (unsigned)history.size(), path, s.p50,
+           s.p99);
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#define PROFILE_MAX_SCOPES     32
+#define PROFILE_QUERY_LATENCY  4     // Frames a GPU timer result may take before it is dropped
+#define PROFILE_HISTORY        10000 // Frames kept for dumps
+#define PROFILE_OVERLAY_FRAMES 60    // Frames averaged by the overlay
+
+// Set through profilerSetEnabled(); scopes cost one branch while false
+extern bool profilerEnabled;
+
+// Call once a GL context exists (GPU times need glHasTimerQueries)
+void profilerInit();
+void profilerSetEnabled(bool enabled);
+void profilerRelease();
+
+// Scopes only record between these; anything outside a frame (mesh recording,
+// benchmarks) is ignored
+void profilerBeginFrame();
+void profilerEndFrame();
+
+int profilerRegisterScope(const char* name);
+void profilerBeginScope(int id);
+void profilerEndScope(int id);
+
+// Times the enclosing block under name; nested scopes report inclusive times
+struct ProfileScope {
+    int id;
+    explicit ProfileScope(int scopeId) : id(profilerEnabled ? scopeId : -1) {
+        if (id >= 0) profilerBeginScope(id);
+    }
+    ~ProfileScope() {
+        if (id >= 0) profilerEndScope(id);
+    }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name)                                                                  \
+    static const int PROFILE_CONCAT(profileScopeId, __LINE__) = profilerRegisterScope(name); \
+    ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profileScopeId, __LINE__))
+
+// Per-scope averages over the last PROFILE_OVERLAY_FRAMES frames, drawn in
+// window coordinates with GLUT bitmap fonts
+void profilerDrawOverlay(int windowWidth, int windowHeight);
+
+// Per-frame samples and p50/p90/p99 summaries; the format follows the extension (.json or CSV)
+bool profilerDump(const char* path);
+
+#endif
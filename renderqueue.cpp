@@ -0,0 +1,252 @@
+#include "renderqueue.h"
+#include "camera.h"
+#include "gl_ext.h"
+#include "pipeline.h"
+#include "profiler.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+bool renderStateFiltering = true;
+
+// What GL currently holds, as far as calls made through here know
+static struct {
+    bool valid[5]; // Ambient, diffuse, specular, emission, shininess
+    GLfloat material[4][4];
+    GLfloat shininess;
+    bool lineWidthValid;
+    GLfloat lineWidth;
+} state;
+
+static RenderStats stats;
+
+// One mesh batch waiting in the queue
+struct RenderItem {
+    GLenum mode;
+    GLfloat lineWidth;
+    int material; // Global id from meshMaterialId()
+    const Mesh* mesh;
+    int batch;
+    int transform;
+};
+
+static std::vector<RenderItem> items;
+static std::vector<GLfloat> transforms; // 16 floats per submitted mesh
+static std::vector<const Mesh*> listMeshes; // Display-list meshes, drawn unsorted
+static std::vector<int> listTransforms;
+
+void renderStateReset() {
+    memset(&state, 0, sizeof(state));
+}
+
+static int materialSlot(GLenum pname) {
+    switch (pname) {
+        case GL_AMBIENT: return 0;
+        case GL_DIFFUSE: return 1;
+        case GL_SPECULAR: return 2;
+        case GL_EMISSION: return 3;
+        default: return -1;
+    }
+}
+
+void renderStateMaterialfv(GLenum pname, const GLfloat* params) {
+    stats.materialCallsNaive++;
+    if (pname == GL_SHININESS) {
+        renderStateMaterialf(pname, params[0]);
+        stats.materialCallsNaive--;
+        return;
+    }
+    int slot = materialSlot(pname);
+    if (slot < 0) { // GL_AMBIENT_AND_DIFFUSE and friends: pass through, forget the affected slots
+        glMaterialfv(GL_FRONT, pname, params);
+        stats.materialCalls++;
+        state.valid[0] = state.valid[1] = false;
+        return;
+    }
+    if (renderStateFiltering && state.valid[slot] && memcmp(state.material[slot], params, 4 * sizeof(GLfloat)) == 0) {
+        return;
+    }
+    glMaterialfv(GL_FRONT, pname, params);
+    stats.materialCalls++;
+    memcpy(state.material[slot], params, 4 * sizeof(GLfloat));
+    state.valid[slot] = true;
+}
+
+void renderStateMaterialf(GLenum pname, GLfloat param) {
+    stats.materialCallsNaive++;
+    if (pname != GL_SHININESS) {
+        glMaterialf(GL_FRONT, pname, param);
+        stats.materialCalls++;
+        return;
+    }
+    if (renderStateFiltering && state.valid[4] && state.shininess == param) return;
+    glMaterialf(GL_FRONT, GL_SHININESS, param);
+    stats.materialCalls++;
+    state.shininess = param;
+    state.valid[4] = true;
+}
+
+void renderStateApplyMaterial(const MeshMaterial* material) {
+    renderStateMaterialfv(GL_AMBIENT, material->ambient);
+    renderStateMaterialfv(GL_DIFFUSE, material->diffuse);
+    renderStateMaterialfv(GL_SPECULAR, material->specular);
+    renderStateMaterialfv(GL_EMISSION, material->emission);
+    renderStateMaterialf(GL_SHININESS, material->shininess);
+}
+
+void renderStateLineWidth(GLfloat width) {
+    stats.lineWidthCallsNaive++;
+    if (renderStateFiltering && state.lineWidthValid && state.lineWidth == width) return;
+    glLineWidth(width);
+    stats.lineWidthCalls++;
+    state.lineWidth = width;
+    state.lineWidthValid = true;
+}
+
+void renderQueueBegin() {
+    items.clear();
+    transforms.clear();
+    listMeshes.clear();
+    listTransforms.clear();
+}
+
+void renderQueueSubmit(const Mesh* mesh, const GLfloat transform[16]) {
+    // Parts of one object usually share a transform; keep a single copy so they sort together
+    int transformIndex = (int)(transforms.size() / 16) - 1;
+    if (transformIndex < 0 || memcmp(&transforms[transformIndex * 16], transform, 16 * sizeof(GLfloat)) != 0) {
+        transforms.insert(transforms.end(), transform, transform + 16);
+        transformIndex++;
+    }
+    stats.matrixCallsNaive += 3;
+
+    if (!mesh->vertexBuffer) {
+        if (mesh->displayList) {
+            listMeshes.push_back(mesh);
+            listTransforms.push_back(transformIndex);
+        }
+        return;
+    }
+
+    stats.bufferBindsNaive += 4; // Bind and unbind both buffers
+    for (size_t b = 0; b < mesh->batches.size(); b++) {
+        const MeshBatch& batch = mesh->batches[b];
+        RenderItem item;
+        item.mode = batch.mode;
+        item.lineWidth = batch.mode == GL_LINES ? batch.lineWidth : 0.0f;
+        item.material = mesh->materialIds[batch.material];
+        item.mesh = mesh;
+        item.batch = (int)b;
+        item.transform = transformIndex;
+        items.push_back(item);
+    }
+}
+
+// Filled geometry first, then lines by width; within each, group by material, then mesh, then transform
+static bool itemLess(const RenderItem& a, const RenderItem& b) {
+    if (a.mode != b.mode) return a.mode > b.mode; // GL_TRIANGLES (4) before GL_LINES (1)
+    if (a.lineWidth != b.lineWidth) return a.lineWidth < b.lineWidth;
+    if (a.material != b.material) return a.material < b.material;
+    if (a.mesh != b.mesh) return a.mesh < b.mesh;
+    return a.transform < b.transform;
+}
+
+void renderQueueFlush() {
+    PROFILE_SCOPE("renderQueueFlush");
+    float view[16], modelView[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, view);
+    glPushMatrix();
+
+    std::sort(items.begin(), items.end(), itemLess);
+
+    bool glsl = pipelineActive() && !items.empty();
+    if (glsl) pipelineBegin();
+
+    const Mesh* boundMesh = NULL;
+    int loadedTransform = -1;
+    for (size_t i = 0; i < items.size(); i++) {
+        const RenderItem& item = items[i];
+        const Mesh* mesh = item.mesh;
+        const MeshBatch& batch = mesh->batches[item.batch];
+        stats.items++;
+
+        if (mesh != boundMesh) {
+            if (!boundMesh && !glsl) {
+                glEnableClientState(GL_VERTEX_ARRAY);
+                glEnableClientState(GL_NORMAL_ARRAY);
+            }
+            pglBindBuffer(GL_ARRAY_BUFFER, mesh->vertexBuffer);
+            pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->indexBuffer);
+            if (glsl) {
+                pipelineSetVertexPointers();
+            } else {
+                glVertexPointer(3, GL_FLOAT, sizeof(MeshVertex), (const GLvoid*)0);
+                glNormalPointer(GL_FLOAT, sizeof(MeshVertex), (const GLvoid*)(3 * sizeof(GLfloat)));
+            }
+            stats.bufferBinds += 2;
+            boundMesh = mesh;
+        }
+        if (item.transform != loadedTransform) {
+            multiplyMatrices(view, &transforms[item.transform * 16], modelView);
+            glLoadMatrixf(modelView);
+            stats.matrixLoads++;
+            loadedTransform = item.transform;
+        }
+
+        if (glsl) {
+            // One uniform selects the whole material from the shader's table
+            stats.materialCallsNaive += 5;
+            if (pipelineSetMaterial(item.material)) stats.materialCalls++;
+        } else {
+            renderStateApplyMaterial(&mesh->materials[batch.material]);
+        }
+        if (batch.mode == GL_LINES) renderStateLineWidth(batch.lineWidth);
+        glDrawElements(batch.mode, batch.indexCount, GL_UNSIGNED_INT, (const GLvoid*)(batch.firstIndex * sizeof(GLuint)));
+    }
+    if (glsl) {
+        pipelineEnd();
+    } else if (boundMesh) {
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_NORMAL_ARRAY);
+    }
+    if (boundMesh) {
+        pglBindBuffer(GL_ARRAY_BUFFER, 0);
+        pglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        stats.bufferBinds += 2;
+    }
+
+    // Display lists set their own materials, so the cache cannot follow them
+    for (size_t i = 0; i < listMeshes.size(); i++) {
+        multiplyMatrices(view, &transforms[listTransforms[i] * 16], modelView);
+        glLoadMatrixf(modelView);
+        stats.matrixLoads++;
+        glCallList(listMeshes[i]->displayList);
+    }
+    if (!listMeshes.empty()) renderStateReset();
+
+    glPopMatrix();
+    renderQueueBegin();
+}
+
+void renderStatsReset() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+const RenderStats* renderStats() {
+    return &stats;
+}
+
+void printRenderStats() {
+    if (!renderStateFiltering) {
+        printf("Render queue: off\n");
+        return;
+    }
+    printf("Render queue:\n");
+    printf("  Batches drawn:   %lu\n", stats.items);
+    printf("  Material calls:  %lu of %lu (%lu eliminated)\n", stats.materialCalls, stats.materialCallsNaive,
+           stats.materialCallsNaive - stats.materialCalls);
+    printf("  Buffer binds:    %lu of %lu (%lu eliminated)\n", stats.bufferBinds, stats.bufferBindsNaive,
+           stats.bufferBindsNaive > stats.bufferBinds ? stats.bufferBindsNaive - stats.bufferBinds : 0);
+    printf("  Matrix calls:    %lu of %lu (%lu eliminated)\n", stats.matrixLoads, stats.matrixCallsNaive,
+           stats.matrixCallsNaive > stats.matrixLoads ? stats.matrixCallsNaive - stats.matrixLoads : 0);
+    printf("  Line width calls: %lu of %lu\n", stats.lineWidthCalls, stats.lineWidthCallsNaive);
+}
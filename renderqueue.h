@@ -0,0 +1,41 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "mesh.h"
+
+// Counters since the last renderStatsReset(). "Naive" counts are what drawing
+// each mesh with meshDraw() inside its own push/transform/pop would have issued.
+struct RenderStats {
+    unsigned long items;              // Mesh batches drawn from the queue
+    unsigned long materialCalls;      // glMaterial* calls issued
+    unsigned long materialCallsNaive;
+    unsigned long bufferBinds;        // glBindBuffer calls issued
+    unsigned long bufferBindsNaive;
+    unsigned long matrixLoads;        // glLoadMatrixf calls issued
+    unsigned long matrixCallsNaive;   // Push, load and pop per submitted mesh
+    unsigned long lineWidthCalls;
+    unsigned long lineWidthCallsNaive;
+};
+
+// Redundant-state filter. GL material and line width calls made through these
+// are skipped when GL already holds the value.
+extern bool renderStateFiltering;
+// Forget the cached state; call after code that sets GL state directly
+void renderStateReset();
+void renderStateMaterialfv(GLenum pname, const GLfloat* params);
+void renderStateMaterialf(GLenum pname, GLfloat param);
+void renderStateApplyMaterial(const MeshMaterial* material);
+void renderStateLineWidth(GLfloat width);
+
+// Meshes submitted between begin and flush are split into batches, sorted by
+// primitive type, material, mesh and transform, and issued with redundant state
+// filtered out. Transforms are model matrices relative to the modelview at flush.
+void renderQueueBegin();
+void renderQueueSubmit(const Mesh* mesh, const GLfloat transform[16]);
+void renderQueueFlush();
+
+void renderStatsReset();
+const RenderStats* renderStats();
+void printRenderStats();
+
+#endif
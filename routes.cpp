@@ -0,0 +1,576 @@
+#include "routes.h"
+#include "workers.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <math.h>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Work stealing: each thread owns a queue of task numbers, takes from its
+// back and, once it is empty, from the front of the others'
+struct TaskQueue {
+    std::mutex mutex;
+    std::deque<unsigned> tasks;
+};
+
+// Every thread runs tasks until all the queues are empty
+static WorkerPool pool;
+static TaskQueue* queues = NULL;
+static int queueCount = 0;
+static void (*jobTask)(unsigned task) = NULL;
+static std::atomic<unsigned long> steals(0);
+
+static std::vector<Route> plan;
+static std::vector<int> routeOf[BIN_COMPARTMENT_COUNT]; // Route visiting each bin's compartment, or -1
+static std::vector<float> plannedPosition;              // x, z of each bin when it was routed
+static int truckCount = 0;
+static float fillThreshold = ROUTE_DEFAULT_THRESHOLD;
+static bool planStale = true; // Trucks or threshold changed since the last plan
+static bool improveRoutes = true;
+static RouteStats stats;
+
+// Inputs of the running job
+static const std::vector<BinInstance>* jobBins = NULL;
+static std::vector<unsigned> sweepStops[BIN_COMPARTMENT_COUNT];
+static std::vector<unsigned> jobRoutes; // Route per task
+static bool jobBuild = false;           // Build routes from scratch rather than improve them
+static std::atomic<unsigned long> twoOptMoves(0), orOptMoves(0);
+
+static bool takeTask(int self, unsigned* task) {
+    {
+        TaskQueue& own = queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            *task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (int k = 1; k < queueCount; k++) {
+        TaskQueue& victim = queues[(self + k) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            *task = victim.tasks.front();
+            victim.tasks.pop_front();
+            steals++;
+            return true;
+        }
+    }
+    return false; // Nothing is added while a job runs, so no work is left anywhere
+}
+
+static void runQueue(int self) {
+    unsigned task;
+    while (takeTask(self, &task)) jobTask(task);
+}
+
+// Run task(0..count-1) on every thread, each starting on its own contiguous share
+static void runTasks(unsigned count, void (*task)(unsigned)) {
+    jobTask = task;
+    for (int q = 0; q < queueCount; q++) {
+        for (unsigned t = count * q / queueCount; t < count * (q + 1) / queueCount; t++) queues[q].tasks.push_back(t);
+    }
+    workersRun(&pool, runQueue, count > 1);
+}
+
+void routesInit(int threads) {
+    routesRelease();
+    releaseAtExit(routesRelease);
+    workersStart(&pool, threads);
+    queueCount = workersCount(&pool);
+    queues = new TaskQueue[queueCount];
+}
+
+void routesRelease() {
+    workersStop(&pool);
+    delete[] queues;
+    queues = NULL;
+    queueCount = 0;
+}
+
+int routesThreads() {
+    return queueCount > 0 ? queueCount : 1;
+}
+
+void routesSetTrucks(int trucks) {
+    truckCount = trucks > 0 ? trucks : 0;
+    planStale = true;
+}
+
+void routesSetThreshold(float threshold) {
+    fillThreshold = threshold;
+    planStale = true;
+}
+
+const std::vector<Route>& routes() {
+    return plan;
+}
+
+void routesClear() {
+    plan.clear();
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) routeOf[c].clear();
+    plannedPosition.clear();
+}
+
+const RouteStats* routeStats() {
+    return &stats;
+}
+
+static inline float distance(const float* a, const float* b) {
+    float dx = a[0] - b[0];
+    float dz = a[1] - b[1];
+    return sqrtf(dx * dx + dz * dz);
+}
+
+// Tours below are over points[], x and z pairs with the depot as point 0; a
+// tour starts at the depot and returns to it after its last entry
+static float tourLength(const std::vector<float>& points, const std::vector<unsigned>& tour) {
+    float length = 0.0f;
+    for (size_t i = 0; i < tour.size(); i++) {
+        length += distance(&points[2 * tour[i]], &points[2 * tour[(i + 1) % tour.size()]]);
+    }
+    return length;
+}
+
+static void nearestNeighbourTour(const std::vector<float>& points, std::vector<unsigned>* tour) {
+    unsigned n = (unsigned)points.size() / 2;
+    std::vector<bool> visited(n, false);
+    tour->assign(1, 0);
+    visited[0] = true;
+    for (unsigned k = 1; k < n; k++) {
+        const float* from = &points[2 * tour->back()];
+        unsigned best = 0;
+        float bestDistance = 0.0f;
+        for (unsigned p = 1; p < n; p++) {
+            if (visited[p]) continue;
+            float d = distance(from, &points[2 * p]);
+            if (best == 0 || d < bestDistance) {
+                best = p;
+                bestDistance = d;
+            }
+        }
+        visited[best] = true;
+        tour->push_back(best);
+    }
+}
+
+// First-improvement 2-opt: reverse the run between two edges when reconnecting them is shorter
+static bool twoOpt(const std::vector<float>& points, std::vector<unsigned>* tour) {
+    std::vector<unsigned>& t = *tour;
+    size_t n = t.size();
+    bool improved = false;
+    for (size_t i = 0; i + 2 < n; i++) {
+        for (size_t j = i + 2; j < n; j++) {
+            if (i == 0 && j == n - 1) continue; // Same two edges
+            const float* a = &points[2 * t[i]];
+            const float* b = &points[2 * t[i + 1]];
+            const float* c = &points[2 * t[j]];
+            const float* d = &points[2 * t[(j + 1) % n]];
+            if (distance(a, c) + distance(b, d) < distance(a, b) + distance(c, d) - 1e-4f) {
+                std::reverse(t.begin() + i + 1, t.begin() + j + 1);
+                twoOptMoves++;
+                improved = true;
+            }
+        }
+    }
+    return improved;
+}
+
+// Or-opt: move runs of up to ROUTE_OR_SEGMENT stops, either way round, to where they cost least
+static bool orOpt(const std::vector<float>& points, std::vector<unsigned>* tour) {
+    std::vector<unsigned>& t = *tour;
+    size_t n = t.size();
+    bool improved = false;
+    for (size_t length = 1; length <= ROUTE_OR_SEGMENT; length++) {
+        for (size_t i = 1; i + length <= n && n > length + 2; i++) {
+            const float* prev = &points[2 * t[i - 1]];
+            const float* first = &points[2 * t[i]];
+            const float* last = &points[2 * t[i + length - 1]];
+            const float* next = &points[2 * t[(i + length) % n]];
+            float removed = distance(prev, first) + distance(last, next) - distance(prev, next);
+            size_t bestAfter = n;
+            bool bestReversed = false;
+            float bestAdded = removed - 1e-4f;
+            for (size_t p = 0; p < n; p++) {
+                if (p + 1 >= i && p < i + length) continue; // Edges touching the run
+                const float* u = &points[2 * t[p]];
+                const float* v = &points[2 * t[(p + 1) % n]];
+                float base = distance(u, v);
+                float forward = distance(u, first) + distance(last, v) - base;
+                float backward = distance(u, last) + distance(first, v) - base;
+                if (forward < bestAdded) {
+                    bestAdded = forward;
+                    bestAfter = p;
+                    bestReversed = false;
+                }
+                if (backward < bestAdded) {
+                    bestAdded = backward;
+                    bestAfter = p;
+                    bestReversed = true;
+                }
+            }
+            if (bestAfter == n) continue;
+            std::vector<unsigned> run(t.begin() + i, t.begin() + i + length);
+            if (bestReversed) std::reverse(run.begin(), run.end());
+            t.erase(t.begin() + i, t.begin() + i + length);
+            size_t after = bestAfter > i ? bestAfter - length : bestAfter;
+            t.insert(t.begin() + after + 1, run.begin(), run.end());
+            orOptMoves++;
+            improved = true;
+        }
+    }
+    return improved;
+}
+
+// Task: build (or improve) one route, keeping the depot first
+static void routeTask(unsigned task) {
+    Route& route = plan[jobRoutes[task]];
+    const std::vector<BinInstance>& bins = *jobBins;
+    std::vector<float> points(2 * (route.stops.size() + 1));
+    points[0] = ROUTE_DEPOT_X;
+    points[1] = ROUTE_DEPOT_Z;
+    for (size_t i = 0; i < route.stops.size(); i++) {
+        points[2 * i + 2] = bins[route.stops[i]].position[0];
+        points[2 * i + 3] = bins[route.stops[i]].position[2];
+    }
+    std::vector<unsigned> tour;
+    if (jobBuild) {
+        nearestNeighbourTour(points, &tour);
+    } else {
+        tour.resize(route.stops.size() + 1);
+        for (size_t i = 0; i < tour.size(); i++) tour[i] = (unsigned)i;
+    }
+    for (int pass = 0; improveRoutes && pass < ROUTE_MAX_PASSES; pass++) {
+        bool improved = twoOpt(points, &tour);
+        if (orOpt(points, &tour)) improved = true;
+        if (!improved) break;
+    }
+    route.length = tourLength(points, tour);
+    std::vector<unsigned> stops(tour.size() - 1);
+    for (size_t i = 1; i < tour.size(); i++) stops[i - 1] = route.stops[tour[i] - 1];
+    route.stops.swap(stops);
+}
+
+// Task: order one compartment's stops by bearing from the depot, for the sweep
+static void sweepTask(unsigned compartment) {
+    const std::vector<BinInstance>& bins = *jobBins;
+    std::vector<unsigned>& stops = sweepStops[compartment];
+    std::vector<std::pair<float, unsigned> > bearings(stops.size());
+    for (size_t i = 0; i < stops.size(); i++) {
+        const BinInstance& bin = bins[stops[i]];
+        bearings[i].first = atan2f(bin.position[2] - ROUTE_DEPOT_Z, bin.position[0] - ROUTE_DEPOT_X);
+        bearings[i].second = stops[i];
+    }
+    std::sort(bearings.begin(), bearings.end());
+    for (size_t i = 0; i < stops.size(); i++) stops[i] = bearings[i].second;
+}
+
+static void startPlan() {
+    if (queueCount == 0) routesInit(1);
+    twoOptMoves = 0;
+    orOptMoves = 0;
+    steals = 0;
+}
+
+static void finishPlan(std::chrono::steady_clock::time_point start) {
+    stats.stops = 0;
+    stats.routes = (unsigned)plan.size();
+    stats.length = 0.0f;
+    for (size_t r = 0; r < plan.size(); r++) {
+        stats.stops += (unsigned)plan[r].stops.size();
+        stats.length += plan[r].length;
+    }
+    stats.twoOptMoves = twoOptMoves;
+    stats.orOptMoves = orOptMoves;
+    stats.steals = steals;
+    stats.threads = routesThreads();
+    stats.totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Trucks in proportion to each compartment's stops, by largest remainder so
+// they add up to trucks. Every compartment with stops gets at least one while
+// there are enough trucks to go round, and none gets more trucks than stops.
+static void apportionTrucks(int trucks, unsigned total, size_t shares[BIN_COMPARTMENT_COUNT]) {
+    double remainders[BIN_COMPARTMENT_COUNT];
+    size_t assigned = 0;
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        double quota = total > 0 ? (double)trucks * sweepStops[c].size() / total : 0.0;
+        shares[c] = (size_t)quota;
+        remainders[c] = quota - shares[c];
+        assigned += shares[c];
+    }
+    for (; assigned < (size_t)trucks && total > 0; assigned++) {
+        int best = 0;
+        for (int c = 1; c < BIN_COMPARTMENT_COUNT; c++) {
+            if (remainders[c] > remainders[best]) best = c;
+        }
+        shares[best]++;
+        remainders[best] = -1.0;
+    }
+    if (trucks >= BIN_COMPARTMENT_COUNT) {
+        for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+            if (shares[c] > 0 || sweepStops[c].empty()) continue;
+            int largest = 0;
+            for (int k = 1; k < BIN_COMPARTMENT_COUNT; k++) {
+                if (shares[k] > shares[largest]) largest = k;
+            }
+            shares[largest]--;
+            shares[c] = 1;
+        }
+    }
+    // Trucks beyond a compartment's stops go where each truck has the most stops
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        while (shares[c] > sweepStops[c].size()) {
+            int best = -1;
+            for (int k = 0; k < BIN_COMPARTMENT_COUNT; k++) {
+                if (shares[k] >= sweepStops[k].size()) continue;
+                if (best < 0 || sweepStops[k].size() * (shares[best] + 1) > sweepStops[best].size() * (shares[k] + 1)) {
+                    best = k;
+                }
+            }
+            shares[c]--;
+            if (best >= 0) shares[best]++;
+        }
+    }
+}
+
+static void planFromScratch(const std::vector<BinInstance>& bins) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    startPlan();
+    jobBins = &bins;
+    unsigned total = 0;
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        sweepStops[c].clear();
+        for (unsigned i = 0; i < bins.size(); i++) {
+            if (bins[i].fill[c] >= fillThreshold) sweepStops[c].push_back(i);
+        }
+        total += (unsigned)sweepStops[c].size();
+    }
+    runTasks(BIN_COMPARTMENT_COUNT, sweepTask);
+
+    int trucks = truckCount > 0 ? truckCount : (int)(total + ROUTE_STOPS_PER_TRUCK - 1) / ROUTE_STOPS_PER_TRUCK;
+    size_t shares[BIN_COMPARTMENT_COUNT];
+    apportionTrucks(trucks, total, shares);
+    plan.clear();
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        const std::vector<unsigned>& stops = sweepStops[c];
+        size_t share = shares[c];
+        routeOf[c].assign(bins.size(), -1);
+        for (size_t k = 0; k < share; k++) {
+            Route route;
+            route.compartment = c;
+            size_t first = stops.size() * k / share, last = stops.size() * (k + 1) / share;
+            route.stops.assign(stops.begin() + first, stops.begin() + last);
+            route.length = 0.0f;
+            for (size_t i = 0; i < route.stops.size(); i++) routeOf[c][route.stops[i]] = (int)plan.size();
+            plan.push_back(route);
+        }
+    }
+    plannedPosition.resize(2 * bins.size());
+    for (size_t i = 0; i < bins.size(); i++) {
+        plannedPosition[2 * i] = bins[i].position[0];
+        plannedPosition[2 * i + 1] = bins[i].position[2];
+    }
+    std::chrono::steady_clock::time_point clustered = std::chrono::steady_clock::now();
+
+    // Longest routes first, so the last tasks left to steal are short ones
+    jobRoutes.resize(plan.size());
+    for (size_t r = 0; r < plan.size(); r++) jobRoutes[r] = (unsigned)r;
+    std::sort(jobRoutes.begin(), jobRoutes.end(),
+              [](unsigned a, unsigned b) { return plan[a].stops.size() > plan[b].stops.size(); });
+    jobBuild = true;
+    runTasks((unsigned)jobRoutes.size(), routeTask);
+
+    planStale = false;
+    stats.incremental = false;
+    stats.changedBins = 0;
+    stats.routesImproved = (unsigned)plan.size();
+    stats.clusterMs = std::chrono::duration<double, std::milli>(clustered - start).count();
+    stats.routeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - clustered).count();
+    finishPlan(start);
+}
+
+// Where inserting bin into one of the compartment's routes adds the least distance
+static void cheapestInsertion(const std::vector<BinInstance>& bins, int compartment, unsigned bin, int* bestRoute,
+                              size_t* bestPosition) {
+    static const float depot[2] = {ROUTE_DEPOT_X, ROUTE_DEPOT_Z};
+    float point[2] = {bins[bin].position[0], bins[bin].position[2]};
+    float bestAdded = 0.0f;
+    *bestRoute = -1;
+    for (size_t r = 0; r < plan.size(); r++) {
+        if (plan[r].compartment != compartment) continue;
+        const std::vector<unsigned>& stops = plan[r].stops;
+        float u[2] = {depot[0], depot[1]};
+        for (size_t i = 0; i <= stops.size(); i++) {
+            float v[2] = {depot[0], depot[1]};
+            if (i < stops.size()) {
+                v[0] = bins[stops[i]].position[0];
+                v[1] = bins[stops[i]].position[2];
+            }
+            float added = distance(u, point) + distance(point, v) - distance(u, v);
+            if (*bestRoute < 0 || added < bestAdded) {
+                bestAdded = added;
+                *bestRoute = (int)r;
+                *bestPosition = i;
+            }
+            u[0] = v[0];
+            u[1] = v[1];
+        }
+    }
+}
+
+void routesPlan(const std::vector<BinInstance>& bins, bool incremental) {
+    if (!incremental || planStale || plan.empty() || plannedPosition.size() != 2 * bins.size()) {
+        planFromScratch(bins);
+        return;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Bins whose compartments crossed the threshold or that moved since they were routed
+    std::vector<std::pair<unsigned, int> > removals, insertions; // Bin, compartment
+    unsigned changed = 0, stops = 0;
+    for (unsigned i = 0; i < bins.size(); i++) {
+        bool moved = plannedPosition[2 * i] != bins[i].position[0] || plannedPosition[2 * i + 1] != bins[i].position[2];
+        bool any = false;
+        for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+            bool routed = routeOf[c][i] >= 0;
+            bool due = bins[i].fill[c] >= fillThreshold;
+            stops += routed;
+            if (routed && (!due || moved)) removals.push_back(std::make_pair(i, c));
+            if (due && (!routed || moved)) insertions.push_back(std::make_pair(i, c));
+            any = any || (routed != due) || (routed && moved);
+        }
+        changed += any;
+    }
+    bool missingRoute = false;
+    for (size_t k = 0; k < insertions.size(); k++) {
+        int c = insertions[k].second;
+        bool found = false;
+        for (size_t r = 0; r < plan.size() && !found; r++) found = plan[r].compartment == c;
+        missingRoute = missingRoute || !found;
+    }
+    if (missingRoute || changed > ROUTE_REPLAN_SHARE * stops) {
+        planFromScratch(bins);
+        return;
+    }
+    if (changed == 0) return;
+
+    startPlan();
+    jobBins = &bins;
+    std::vector<bool> touched(plan.size(), false);
+    for (size_t k = 0; k < removals.size(); k++) {
+        unsigned bin = removals[k].first;
+        int c = removals[k].second;
+        std::vector<unsigned>& routeStops = plan[routeOf[c][bin]].stops;
+        routeStops.erase(std::find(routeStops.begin(), routeStops.end(), bin));
+        touched[routeOf[c][bin]] = true;
+        routeOf[c][bin] = -1;
+    }
+    for (size_t k = 0; k < insertions.size(); k++) {
+        unsigned bin = insertions[k].first;
+        int c = insertions[k].second;
+        int route;
+        size_t position = 0;
+        cheapestInsertion(bins, c, bin, &route, &position);
+        plan[route].stops.insert(plan[route].stops.begin() + position, bin);
+        touched[route] = true;
+        routeOf[c][bin] = route;
+    }
+    for (size_t i = 0; i < bins.size(); i++) {
+        plannedPosition[2 * i] = bins[i].position[0];
+        plannedPosition[2 * i + 1] = bins[i].position[2];
+    }
+    std::chrono::steady_clock::time_point patched = std::chrono::steady_clock::now();
+
+    jobRoutes.clear();
+    for (size_t r = 0; r < plan.size(); r++) {
+        if (touched[r]) jobRoutes.push_back((unsigned)r);
+    }
+    jobBuild = false;
+    runTasks((unsigned)jobRoutes.size(), routeTask);
+
+    stats.incremental = true;
+    stats.changedBins = changed;
+    stats.routesImproved = (unsigned)jobRoutes.size();
+    stats.clusterMs = std::chrono::duration<double, std::milli>(patched - start).count();
+    stats.routeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - patched).count();
+    finishPlan(start);
+}
+
+void printRouteStats() {
+    const RouteStats* s = &stats;
+    if (s->incremental) {
+        printf("Routes: %u trucks, %u stops, %.0f m in all; replanned %u changed bins, improving %u routes\n",
+               s->routes, s->stops, s->length, s->changedBins, s->routesImproved);
+    } else {
+        printf("Routes: %u trucks, %u stops, %.0f m in all, planned from scratch\n", s->routes, s->stops, s->length);
+    }
+    printf("  %.2f ms (%s %.2f ms, routing %.2f ms) on %d threads, %lu tasks stolen\n", s->totalMs,
+           s->incremental ? "patching" : "clustering", s->clusterMs, s->routeMs, s->threads, s->steals);
+    printf("  Moves: %lu 2-opt, %lu Or-opt\n", s->twoOptMoves, s->orOptMoves);
+}
+
+static unsigned nextRandom(unsigned* state) {
+    // xorshift32, as in the simulation
+    unsigned v = *state;
+    v ^= v << 13;
+    v ^= v >> 17;
+    v ^= v << 5;
+    *state = v;
+    return v;
+}
+
+void benchmarkRoutes(const std::vector<BinInstance>& bins, int trucks) {
+    int threads = routesThreads();
+    int previousTrucks = truckCount;
+    routesSetTrucks(trucks);
+    printf("Route benchmark: %u bins, %d trucks, threshold %.0f%%\n", (unsigned)bins.size(), trucks,
+           fillThreshold * 100.0f);
+
+    improveRoutes = false;
+    planFromScratch(bins);
+    float nearestLength = stats.length;
+    improveRoutes = true;
+    printf("  Nearest neighbour only: %u stops, %.0f m, %.1f ms\n", stats.stops, nearestLength, stats.totalMs);
+
+    int threadCounts[2] = {1, threads};
+    for (int k = 0; k < (threads > 1 ? 2 : 1); k++) {
+        routesInit(threadCounts[k]);
+        planFromScratch(bins);
+        printf("  %2d threads: %.0f m (%.1f%% shorter), %.1f ms (clustering %.1f ms, routing %.1f ms), "
+               "%lu 2-opt and %lu Or-opt moves, %lu tasks stolen\n",
+               stats.threads, stats.length, 100.0f * (1.0f - stats.length / nearestLength), stats.totalMs,
+               stats.clusterMs, stats.routeMs, stats.twoOptMoves, stats.orOptMoves, stats.steals);
+    }
+
+    // A few bins fill up or get emptied between replans
+    std::vector<BinInstance> changed = bins;
+    unsigned seed = 7u;
+    int counts[3] = {10, 100, 1000};
+    for (int k = 0; k < 3; k++) {
+        for (int i = 0; i < counts[k] && !changed.empty(); i++) {
+            BinInstance& bin = changed[nextRandom(&seed) % changed.size()];
+            int c = nextRandom(&seed) % BIN_COMPARTMENT_COUNT;
+            bin.fill[c] = bin.fill[c] >= fillThreshold ? 0.0f : 1.0f;
+        }
+        routesPlan(changed, true);
+        double incrementalMs = stats.totalMs;
+        float incrementalLength = stats.length;
+        bool patched = stats.incremental;
+        unsigned improved = stats.routesImproved;
+        planFromScratch(changed);
+        if (patched) {
+            printf("  %4d changes: incremental %.2f ms (%u routes), %.0f m; from scratch %.1f ms, %.0f m\n",
+                   counts[k], incrementalMs, improved, incrementalLength, stats.totalMs, stats.length);
+        } else {
+            printf("  %4d changes: over %.0f%% of stops, planned from scratch in %.1f ms, %.0f m\n", counts[k],
+                   ROUTE_REPLAN_SHARE * 100.0f, stats.totalMs, stats.length);
+        }
+    }
+    routesSetTrucks(previousTrucks);
+    routesClear();
+}
@@ -0,0 +1,62 @@
+#ifndef ROUTES_H
+#define ROUTES_H
+
+#include "fleet.h"
+#include <vector>
+
+// Collection routes for the bins whose compartments have filled past a
+// threshold. Each compartment gets its own trucks (hazardous waste cannot
+// ride with the rest). Its bins are split among them by a sweep around the
+// depot, then each route is built nearest neighbour first and improved with
+// 2-opt and Or-opt moves. Routes are planned as tasks on a pool of threads
+// that steal from each other's queues. Nothing here calls OpenGL.
+#define ROUTE_DEFAULT_THRESHOLD 0.75f // Fill level at which a compartment needs emptying
+#define ROUTE_STOPS_PER_TRUCK   150   // Truck count when none is set: one per this many stops
+#define ROUTE_BENCH_TRUCKS      200
+#define ROUTE_MAX_PASSES        50    // Improvement rounds per route at most
+#define ROUTE_OR_SEGMENT        3     // Longest run of stops an Or-opt move relocates
+#define ROUTE_REPLAN_SHARE      0.05f // Replan from scratch when more than this share of stops changed
+#define ROUTE_DEPOT_X           0.0f  // Trucks leave from and return to here, on the ground
+#define ROUTE_DEPOT_Z           0.0f
+
+struct Route {
+    int compartment;             // BinCompartment this truck empties
+    std::vector<unsigned> stops; // Fleet bin indices in visiting order, from and back to the depot
+    float length;
+};
+
+struct RouteStats {
+    unsigned stops, routes;
+    float length;              // All routes together
+    bool incremental;          // Last plan patched the previous one
+    unsigned changedBins;      // Bins inserted into or removed from routes by the last incremental plan
+    unsigned routesImproved;   // Routes built or improved by the last plan
+    unsigned long twoOptMoves, orOptMoves;
+    unsigned long steals;      // Tasks a thread took from another thread's queue
+    double clusterMs, routeMs, totalMs;
+    int threads;
+};
+
+// Starts threads - 1 helper threads (0 = one per core, counting the caller)
+void routesInit(int threads);
+void routesRelease();
+int routesThreads();
+
+// Trucks across all compartments (0: one per ROUTE_STOPS_PER_TRUCK stops); the next plan starts over
+void routesSetTrucks(int trucks);
+void routesSetThreshold(float threshold);
+
+// Plan routes for bins. With incremental set, a previous plan for the same
+// bins is patched: bins that emptied or moved leave their routes, new ones are
+// inserted where they add the least distance, and only those routes are improved.
+void routesPlan(const std::vector<BinInstance>& bins, bool incremental);
+const std::vector<Route>& routes();
+void routesClear();
+
+const RouteStats* routeStats();
+void printRouteStats();
+
+// Full plans on one thread and on all of them, then incremental replans after a few fill changes
+void benchmarkRoutes(const std::vector<BinInstance>& bins, int trucks);
+
+#endif
@@ -0,0 +1,138 @@
+#include "scenegraph.h"
+#include "camera.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+void sceneClear(SceneGraph* graph) {
+    graph->nodes.clear();
+    graph->dirtyNodes.clear();
+    graph->freeNodes.clear();
+    graph->nodesUpdated = 0;
+    graph->liveNodes = 0;
+}
+
+int sceneCreateNode(SceneGraph* graph, int parent, const float local[16]) {
+    int node;
+    if (!graph->freeNodes.empty()) {
+        node = graph->freeNodes.back();
+        graph->freeNodes.pop_back();
+    } else {
+        node = (int)graph->nodes.size();
+        graph->nodes.push_back(SceneNode());
+    }
+    SceneNode& n = graph->nodes[node];
+    memcpy(n.local, local, sizeof(n.local));
+    n.parent = parent;
+    n.firstChild = -1;
+    n.nextSibling = -1;
+    if (parent >= 0) {
+        n.nextSibling = graph->nodes[parent].firstChild;
+        graph->nodes[parent].firstChild = node;
+    }
+    n.dirty = true;
+    graph->dirtyNodes.push_back(node);
+    graph->liveNodes++;
+    return node;
+}
+
+static void freeSubtree(SceneGraph* graph, int node) {
+    for (int child = graph->nodes[node].firstChild; child >= 0; child = graph->nodes[child].nextSibling) {
+        freeSubtree(graph, child);
+    }
+    graph->nodes[node].dirty = false; // Drops it from a pending update
+    graph->nodes[node].parent = -1;
+    graph->freeNodes.push_back(node);
+    graph->liveNodes--;
+}
+
+void sceneRemove(SceneGraph* graph, int node) {
+    int parent = graph->nodes[node].parent;
+    if (parent >= 0) {
+        int* link = &graph->nodes[parent].firstChild;
+        while (*link != node) link = &graph->nodes[*link].nextSibling;
+        *link = graph->nodes[node].nextSibling;
+    }
+    freeSubtree(graph, node);
+}
+
+void sceneSetLocal(SceneGraph* graph, int node, const float local[16]) {
+    SceneNode& n = graph->nodes[node];
+    memcpy(n.local, local, sizeof(n.local));
+    if (!n.dirty) {
+        n.dirty = true;
+        graph->dirtyNodes.push_back(node);
+    }
+}
+
+static void updateSubtree(SceneGraph* graph, int node) {
+    SceneNode& n = graph->nodes[node];
+    if (n.parent >= 0) {
+        multiplyMatrices(graph->nodes[n.parent].world, n.local, n.world);
+    } else {
+        memcpy(n.world, n.local, sizeof(n.world));
+    }
+    n.dirty = false;
+    graph->nodesUpdated++;
+    for (int child = n.firstChild; child >= 0; child = graph->nodes[child].nextSibling) updateSubtree(graph, child);
+}
+
+void sceneUpdate(SceneGraph* graph) {
+    graph->nodesUpdated = 0;
+    for (size_t i = 0; i < graph->dirtyNodes.size(); i++) {
+        int node = graph->dirtyNodes[i];
+        // Already done with a flagged ancestor, removed, or waiting for an ancestor further down the list
+        if (!graph->nodes[node].dirty) continue;
+        bool ancestorDirty = false;
+        for (int p = graph->nodes[node].parent; p >= 0 && !ancestorDirty; p = graph->nodes[p].parent) {
+            ancestorDirty = graph->nodes[p].dirty;
+        }
+        if (!ancestorDirty) updateSubtree(graph, node);
+    }
+    graph->dirtyNodes.clear();
+}
+
+const float* sceneWorld(const SceneGraph* graph, int node) {
+    return graph->nodes[node].world;
+}
+
+void sceneAddBin(SceneGraph* graph, int parent, const float placement[16], BinNodes* nodes) {
+    nodes->root = sceneCreateNode(graph, parent, placement);
+    for (int part = 0; part < BIN_PART_COUNT; part++) {
+        int lid = part - BIN_PART_RECYCLABLE_LID;
+        if (lid >= 0 && lid < BIN_COMPARTMENT_COUNT) {
+            float hinge[16];
+            binHingeMatrix(0.0f, hinge);
+            nodes->hinges[lid] = sceneCreateNode(graph, nodes->root, hinge);
+            nodes->parts[part] = sceneCreateNode(graph, nodes->hinges[lid], identity);
+        } else {
+            // The part meshes are recorded in bin space
+            nodes->parts[part] = sceneCreateNode(graph, nodes->root, identity);
+        }
+    }
+}
+
+void binPlacementMatrix(const float position[3], float yaw, float matrix[16]) {
+    float angle = yaw * (float)M_PI / 180.0f;
+    float c = cosf(angle), s = sinf(angle);
+    float placement[16] = {c, 0.0f, -s, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                           s, 0.0f, c,  0.0f, position[0], position[1], position[2], 1.0f};
+    memcpy(matrix, placement, sizeof(placement));
+}
+
+void binHingeMatrix(float angle, float matrix[16]) {
+    float radians = -angle * (float)M_PI / 180.0f;
+    float c = cosf(radians), s = sinf(radians);
+    float hingeY = BIN_LID_Y;
+    float hingeZ = -BIN_DEPTH / 2.0f;
+    float hinge[16] = {1.0f, 0.0f, 0.0f, 0.0f,
+                       0.0f, c, s, 0.0f,
+                       0.0f, -s, c, 0.0f,
+                       0.0f, hingeY - (c * hingeY - s * hingeZ), hingeZ - (s * hingeY + c * hingeZ), 1.0f};
+    memcpy(matrix, hinge, sizeof(hinge));
+}
@@ -0,0 +1,51 @@
+#ifndef SCENEGRAPH_H
+#define SCENEGRAPH_H
+
+#include "bin.h"
+#include <vector>
+
+// Transform hierarchy with cached world matrices. Changing a node's local
+// matrix only flags it; sceneUpdate() then recomputes the world matrices of
+// flagged nodes and everything below them, leaving the rest of the graph alone.
+// Matrices are column-major, as glLoadMatrixf takes them.
+
+struct SceneNode {
+    float local[16];
+    float world[16]; // parent world * local, as of the last sceneUpdate()
+    int parent;      // -1 for roots
+    int firstChild, nextSibling;
+    bool dirty;      // local changed since world was computed
+};
+
+struct SceneGraph {
+    std::vector<SceneNode> nodes;
+    std::vector<int> dirtyNodes; // Flagged nodes, in the order they changed
+    std::vector<int> freeNodes;  // Removed slots, reused by sceneCreateNode()
+    unsigned long nodesUpdated;  // World matrices computed by the last sceneUpdate()
+    unsigned long liveNodes;
+};
+
+// Node handles for one bin: body, dividers and labels under the root, each lid under its hinge
+struct BinNodes {
+    int root;
+    int parts[BIN_PART_COUNT];
+    int hinges[BIN_COMPARTMENT_COUNT];
+};
+
+void sceneClear(SceneGraph* graph);
+// New node under parent (-1 for a root), flagged so its world matrix is computed on the next update
+int sceneCreateNode(SceneGraph* graph, int parent, const float local[16]);
+// Remove a node and its subtree; their slots are reused by later nodes
+void sceneRemove(SceneGraph* graph, int node);
+void sceneSetLocal(SceneGraph* graph, int node, const float local[16]);
+void sceneUpdate(SceneGraph* graph);
+const float* sceneWorld(const SceneGraph* graph, int node);
+
+// A bin's subtree under parent, placed by placement, lids closed
+void sceneAddBin(SceneGraph* graph, int parent, const float placement[16], BinNodes* nodes);
+// Translate to position, then turn yaw degrees about +Y, like the fleet shader
+void binPlacementMatrix(const float position[3], float yaw, float matrix[16]);
+// Lid swung up by angle degrees about the hinge along its back edge
+void binHingeMatrix(float angle, float matrix[16]);
+
+#endif
@@ -0,0 +1,72 @@
+#include "shader.h"
+#include <stdio.h>
+
+const char* shaderLightingSource =
+    "vec4 fixedFunctionLighting(vec3 eyePosition, vec3 eyeNormal, vec4 ambient, vec4 diffuse,\n"
+    "                           vec4 specular, vec4 emission, float shininess) {\n"
+    "    vec4 color = emission + gl_LightModel.ambient * ambient;\n"
+    "    for (int i = 0; i < 2; i++) {\n"
+    "        vec4 lightPosition = gl_LightSource[i].position;\n"
+    "        vec3 L = normalize(lightPosition.w == 0.0 ? lightPosition.xyz : lightPosition.xyz - eyePosition);\n"
+    "        float NdotL = max(dot(eyeNormal, L), 0.0);\n"
+    "        color += gl_LightSource[i].ambient * ambient + NdotL * gl_LightSource[i].diffuse * diffuse;\n"
+    "        if (NdotL > 0.0) {\n"
+    "            vec3 H = normalize(L + vec3(0.0, 0.0, 1.0));\n"
+    "            color += pow(max(dot(eyeNormal, H), 1e-4), shininess) * gl_LightSource[i].specular * specular;\n"
+    "        }\n"
+    "    }\n"
+    "    return vec4(clamp(color.rgb, 0.0, 1.0), diffuse.a);\n"
+    "}\n";
+
+static GLuint compileStage(const char* name, GLenum stage, const char* const* sources, int count) {
+    GLuint shader = pglCreateShader(stage);
+    pglShaderSource(shader, count, (const GLchar**)sources, NULL);
+    pglCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    pglGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[2048];
+        pglGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        printf("%s %s shader failed to compile:\n%s\n", name, stage == GL_VERTEX_SHADER ? "vertex" : "fragment", log);
+        pglDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint buildShaderProgram(const char* name, const char* const* vertexSources, int vertexCount,
+                          const char* const* fragmentSources, int fragmentCount, const char* const* attributes) {
+    if (!glHasShaders) return 0;
+
+    GLuint vertexShader = compileStage(name, GL_VERTEX_SHADER, vertexSources, vertexCount);
+    GLuint fragmentShader = compileStage(name, GL_FRAGMENT_SHADER, fragmentSources, fragmentCount);
+    if (!vertexShader || !fragmentShader) {
+        if (vertexShader) pglDeleteShader(vertexShader);
+        if (fragmentShader) pglDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    GLuint program = pglCreateProgram();
+    pglAttachShader(program, vertexShader);
+    pglAttachShader(program, fragmentShader);
+    for (GLuint i = 0; attributes && attributes[i]; i++) {
+        pglBindAttribLocation(program, i, attributes[i]);
+    }
+    pglLinkProgram(program);
+
+    // The program keeps the stages alive until it is deleted
+    pglDeleteShader(vertexShader);
+    pglDeleteShader(fragmentShader);
+
+    GLint status = GL_FALSE;
+    pglGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[2048];
+        pglGetProgramInfoLog(program, sizeof(log), NULL, log);
+        printf("%s program failed to link:\n%s\n", name, log);
+        pglDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
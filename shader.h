@@ -0,0 +1,18 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+#include "gl_ext.h"
+
+// GLSL 1.20 function reproducing the fixed-function lighting set up in init():
+//   vec4 fixedFunctionLighting(vec3 eyePosition, vec3 eyeNormal, vec4 ambient,
+//                              vec4 diffuse, vec4 specular, vec4 emission, float shininess)
+// It reads both lights from gl_LightSource, so shaders stay in sync with init().
+extern const char* shaderLightingSource;
+
+// Compile and link a program from several source strings per stage. Attribute
+// names in the NULL-terminated list are bound to locations 0, 1, 2, ...
+// Returns 0 and prints the info log on failure.
+GLuint buildShaderProgram(const char* name, const char* const* vertexSources, int vertexCount,
+                          const char* const* fragmentSources, int fragmentCount, const char* const* attributes);
+
+#endif
@@ -0,0 +1,525 @@
+#include "sim.h"
+#include "gl_ext.h"
+#include "lanes.h"
+#include "profiler.h"
+#include "workers.h"
+#include <GL/glut.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define SIM_BENCHMARK_STEPS 60
+#define SNAPSHOT_COUNT      3 // Back, front and the published one waiting in between
+#define SNAPSHOT_FRESH      4 // Flag on publishedSnapshot until the renderer takes it
+
+// Collision geometry in world space, from the constants drawGarbageBin() uses
+static const float halfWidth = BIN_TOTAL_WIDTH * 0.5f;
+static const float halfDepth = BIN_DEPTH * 0.5f;
+static const float floorY = BIN_FLOOR_Y;
+static const float lidTop = BIN_LID_Y;
+static const float compartmentPitch = 2.0f * BIN_DIVIDER_X; // Dividers split the body evenly
+static const float wallMargin = BIN_DIVIDER_THICKNESS * 0.5f + SIM_ITEM_RADIUS;
+static const float lidTraffic = 0.75f; // Items this close above or below their lid hold it open
+static const float sortGain = 1.25f; // Sideways speed per unit of distance after bouncing off the wrong lid
+
+static SimItems items;
+static size_t capacity = 0;
+static size_t count = 0;     // Live items, at most capacity
+static size_t nextSlot = 0;  // Where the next spawn goes once the pool is full
+static float spawnRate = 0.0f;
+static float spawnCarry = 0.0f;
+static float timeCarry = 0.0f;
+static std::atomic<bool> enabled(false);
+static unsigned rng = 12345u;
+static SensorBatch arrivals;
+static std::vector<float> arrivalCategory;
+
+// What the renderer sees of the simulation. Items are grouped by category so
+// drawing is one glDrawArrays per color.
+struct SimSnapshot {
+    std::vector<GLfloat> positions;
+    size_t first[BIN_COMPARTMENT_COUNT + 1]; // Category c is items [first[c], first[c + 1])
+    SimStats stats;
+    SimThreadStats timing; // Worker side filled in at publish
+    std::chrono::steady_clock::time_point publishedAt;
+};
+
+// Triple buffer: the stepping side packs into its back snapshot and swaps it
+// with the published one in a single exchange; the renderer swaps its front
+// snapshot with the published one when that is fresh. Neither side ever waits.
+static SimSnapshot snapshots[SNAPSHOT_COUNT];
+static int backSnapshot = 0;  // Owned by whichever thread steps
+static int frontSnapshot = 1; // Owned by the render thread
+static std::atomic<int> publishedSnapshot(2);
+
+bool simUseWorker = true;
+static std::thread worker;
+static std::atomic<bool> workerRunning(false);
+static SimThreadStats workerTiming; // Written only by the stepping side
+static SimThreadStats renderTiming; // Written only by the render thread
+static unsigned long lastDrawnStep = 0;
+static double snapshotAgeTotalMs = 0.0;
+
+static void startWorker();
+static void stopWorker();
+
+// One step for items [begin, end), end - begin a multiple of L::width.
+// Above the lids items fall inside a chute the width of the bin. A lid opens
+// for items of its own category; any other lid bounces the item sideways
+// towards the right one. Below the lids items are kept inside their
+// compartment until they settle on the floor.
+template <typename L>
+static void integrateRange(SimItems* s, size_t begin, size_t end, float dt) {
+    typedef typename L::V V;
+    typedef typename L::M M;
+    const V zero = L::set(0.0f);
+    const V step = L::set(dt);
+    const V fall = L::set(SIM_GRAVITY * dt);
+    const V restitution = L::set(SIM_RESTITUTION);
+    const V friction = L::set(SIM_FRICTION);
+    const V restSpeed2 = L::set(SIM_REST_SPEED * SIM_REST_SPEED);
+    const V lid = L::set(lidTop);
+    const V ceiling = L::set(lidTop - SIM_ITEM_RADIUS);
+    const V floor = L::set(floorY + SIM_ITEM_RADIUS);
+    const V chuteMin = L::set(-halfWidth + SIM_ITEM_RADIUS);
+    const V chuteMax = L::set(halfWidth - SIM_ITEM_RADIUS);
+    const V depthMin = L::set(-halfDepth + SIM_ITEM_RADIUS);
+    const V depthMax = L::set(halfDepth - SIM_ITEM_RADIUS);
+    const V pitch = L::set(compartmentPitch);
+    const V firstMin = L::set(-halfWidth + wallMargin);
+    const V firstCenter = L::set(-halfWidth + compartmentPitch * 0.5f);
+    const V openHalfWidth = L::set(BIN_COMPARTMENT_WIDTH * 0.5f - SIM_ITEM_RADIUS);
+    const V innerWidth = L::set(compartmentPitch - 2.0f * wallMargin);
+    const V gain = L::set(sortGain);
+
+    for (size_t i = begin; i < end; i += L::width) {
+        V x = L::load(&s->x[i]), y = L::load(&s->y[i]), z = L::load(&s->z[i]);
+        V vx = L::load(&s->vx[i]), vy = L::load(&s->vy[i]), vz = L::load(&s->vz[i]);
+        V category = L::load(&s->category[i]);
+        V active = L::load(&s->active[i]);
+
+        M inside = L::less(y, lid);
+        vy = L::sub(vy, L::mul(fall, active));
+        x = L::add(x, L::mul(vx, step));
+        y = L::add(y, L::mul(vy, step));
+        z = L::add(z, L::mul(vz, step));
+
+        // Side walls: the chute above the lids, the item's own compartment below
+        V center = L::add(firstCenter, L::mul(category, pitch));
+        V compartmentMin = L::add(firstMin, L::mul(category, pitch));
+        V xMin = L::select(inside, compartmentMin, chuteMin);
+        V xMax = L::select(inside, L::add(compartmentMin, innerWidth), chuteMax);
+        M hitMin = L::less(x, xMin);
+        M hitMax = L::less(xMax, x);
+        x = L::min(L::max(x, xMin), xMax);
+        vx = L::select(hitMin, L::mul(L::abs(vx), restitution), vx);
+        vx = L::select(hitMax, L::sub(zero, L::mul(L::abs(vx), restitution)), vx);
+        hitMin = L::less(z, depthMin);
+        hitMax = L::less(depthMax, z);
+        z = L::min(L::max(z, depthMin), depthMax);
+        vz = L::select(hitMin, L::mul(L::abs(vz), restitution), vz);
+        vz = L::select(hitMax, L::sub(zero, L::mul(L::abs(vz), restitution)), vz);
+
+        // Lids: crossing one that is not the item's own bounces it towards the right compartment
+        M crossing = L::butNot(L::less(y, lid), inside);
+        M overOwnLid = L::less(L::abs(L::sub(x, center)), openHalfWidth);
+        M bounce = L::butNot(crossing, overOwnLid);
+        y = L::select(bounce, lid, y);
+        vy = L::select(bounce, L::mul(L::abs(vy), restitution), vy);
+        vx = L::select(bounce, L::mul(L::sub(center, x), gain), vx);
+
+        // Closed lids from below, then the floor
+        M underLid = L::both(L::both(inside, L::less(ceiling, y)), L::less(zero, vy));
+        y = L::select(underLid, ceiling, y);
+        vy = L::select(underLid, L::sub(zero, L::mul(vy, restitution)), vy);
+        M onFloor = L::less(y, floor);
+        y = L::max(y, floor);
+        vy = L::select(onFloor, L::mul(L::abs(vy), restitution), vy);
+        vx = L::select(onFloor, L::mul(vx, friction), vx);
+        vz = L::select(onFloor, L::mul(vz, friction), vz);
+
+        // Settle slow items on the floor so they stop moving
+        V speed2 = L::add(L::add(L::mul(vx, vx), L::mul(vy, vy)), L::mul(vz, vz));
+        M settle = L::both(onFloor, L::less(speed2, restSpeed2));
+        vx = L::select(settle, zero, vx);
+        vy = L::select(settle, zero, vy);
+        vz = L::select(settle, zero, vz);
+        active = L::select(settle, zero, active);
+
+        L::store(&s->x[i], x);
+        L::store(&s->y[i], y);
+        L::store(&s->z[i], z);
+        L::store(&s->vx[i], vx);
+        L::store(&s->vy[i], vy);
+        L::store(&s->vz[i], vz);
+        L::store(&s->active[i], active);
+    }
+}
+
+void simIntegrate(SimItems* s, size_t n, float dt, int kernel) {
+    size_t vectorEnd = 0;
+    switch (kernel) {
+#ifdef __AVX__
+        case LANE_KERNEL_AVX:
+            vectorEnd = n - n % AvxLanes::width;
+            integrateRange<AvxLanes>(s, 0, vectorEnd, dt);
+            break;
+#endif
+        case LANE_KERNEL_SSE:
+            vectorEnd = n - n % SseLanes::width;
+            integrateRange<SseLanes>(s, 0, vectorEnd, dt);
+            break;
+    }
+    integrateRange<ScalarLanes>(s, vectorEnd, n, dt);
+}
+
+static unsigned nextRandom(unsigned* state) {
+    // xorshift32: rand() is too slow for a million items
+    unsigned v = *state;
+    v ^= v << 13;
+    v ^= v >> 17;
+    v ^= v << 5;
+    *state = v;
+    return v;
+}
+
+static float randomRange(unsigned* state, float low, float high) {
+    return low + (high - low) * (float)(nextRandom(state) >> 8) / (float)(1 << 24);
+}
+
+static void resizeItems(SimItems* s, size_t n) {
+    s->x.resize(n);
+    s->y.resize(n);
+    s->z.resize(n);
+    s->vx.resize(n);
+    s->vy.resize(n);
+    s->vz.resize(n);
+    s->category.resize(n);
+    s->active.resize(n);
+}
+
+static void spawnItem(SimItems* s, size_t i, float category, unsigned* state) {
+    s->category[i] = category;
+    s->x[i] = randomRange(state, -halfWidth + SIM_ITEM_RADIUS, halfWidth - SIM_ITEM_RADIUS);
+    s->y[i] = randomRange(state, SIM_SPAWN_HEIGHT, SIM_SPAWN_HEIGHT + 3.0f);
+    s->z[i] = randomRange(state, -halfDepth * 0.8f, halfDepth * 0.8f);
+    s->vx[i] = randomRange(state, -0.5f, 0.5f);
+    s->vy[i] = 0.0f;
+    s->vz[i] = randomRange(state, -0.5f, 0.5f);
+    s->active[i] = 1.0f;
+}
+
+void simScatter(SimItems* s, size_t n, unsigned seed) {
+    resizeItems(s, n);
+    unsigned state = seed ? seed : 1u;
+    for (size_t i = 0; i < n; i++) {
+        spawnItem(s, i, (float)(nextRandom(&state) % BIN_COMPARTMENT_COUNT), &state);
+        // Half start lower with some speed, so every code path is exercised from the first step
+        if (i & 1) {
+            s->y[i] = randomRange(&state, floorY + 0.5f, lidTop + 3.0f);
+            s->vy[i] = randomRange(&state, -6.0f, 0.0f);
+        }
+    }
+}
+
+void simInit(int newCapacity) {
+    stopWorker();
+    classifyStatsReset();
+    capacity = newCapacity > 0 ? (size_t)newCapacity : 0;
+    resizeItems(&items, capacity);
+    count = 0;
+    nextSlot = 0;
+    spawnRate = capacity / SIM_FILL_SECONDS;
+    spawnCarry = 0.0f;
+    timeCarry = 0.0f;
+    for (int i = 0; i < SNAPSHOT_COUNT; i++) {
+        snapshots[i].positions.clear();
+        memset(snapshots[i].first, 0, sizeof(snapshots[i].first));
+        memset(&snapshots[i].stats, 0, sizeof(snapshots[i].stats));
+        memset(&snapshots[i].timing, 0, sizeof(snapshots[i].timing));
+    }
+    memset(&workerTiming, 0, sizeof(workerTiming));
+    memset(&renderTiming, 0, sizeof(renderTiming));
+    lastDrawnStep = 0;
+    snapshotAgeTotalMs = 0.0;
+}
+
+void simRelease() {
+    simInit(0);
+    items = SimItems();
+    for (int i = 0; i < SNAPSHOT_COUNT; i++) snapshots[i].positions = std::vector<GLfloat>();
+    enabled = false;
+}
+
+void simSetEnabled(bool on) {
+    stopWorker();
+    enabled = on && capacity > 0;
+    timeCarry = 0.0f;
+    if (enabled && simUseWorker) startWorker();
+}
+
+bool simEnabled() {
+    return enabled;
+}
+
+void simSetThreaded(bool threaded) {
+    simUseWorker = threaded;
+    simSetEnabled(enabled);
+}
+
+bool simThreaded() {
+    return workerRunning;
+}
+
+// One fixed step: spawn what is due, then integrate every live item
+static void advance(int kernel) {
+    // Items arriving this step are sensed and classified as one batch; the
+    // classifier's pick is the lid they will be let through
+    spawnCarry += spawnRate * SIM_STEP;
+    size_t due = (size_t)spawnCarry;
+    spawnCarry -= due;
+    if (due > 0) {
+        sensorGenerate(&arrivals, due, &rng);
+        arrivalCategory.resize(due);
+        classifyBatch(&arrivals, &arrivalCategory[0], kernel);
+        for (size_t k = 0; k < due; k++) {
+            if (count < capacity) {
+                spawnItem(&items, count++, arrivalCategory[k], &rng);
+            } else {
+                spawnItem(&items, nextSlot, arrivalCategory[k], &rng);
+                nextSlot = (nextSlot + 1) % capacity;
+            }
+        }
+    }
+    simIntegrate(&items, count, SIM_STEP, kernel);
+    workerTiming.steps++;
+}
+
+// Pack positions grouped by category into the back snapshot, counting resting
+// items on the way, then make it the published one
+static void publish() {
+    SimSnapshot* snapshot = &snapshots[backSnapshot];
+    SimStats* s = &snapshot->stats;
+    size_t perCategory[BIN_COMPARTMENT_COUNT] = {0};
+    for (size_t i = 0; i < count; i++) perCategory[(int)items.category[i]]++;
+    snapshot->first[0] = 0;
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) snapshot->first[c + 1] = snapshot->first[c] + perCategory[c];
+
+    snapshot->positions.resize(count * 3);
+    size_t next[BIN_COMPARTMENT_COUNT];
+    memcpy(next, snapshot->first, sizeof(next));
+    s->items = count;
+    s->resting = 0;
+    s->misplaced = 0;
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) s->restingIn[c] = s->passing[c] = 0;
+    for (size_t i = 0; i < count; i++) {
+        int category = (int)items.category[i];
+        GLfloat* p = &snapshot->positions[3 * next[category]++];
+        p[0] = items.x[i];
+        p[1] = items.y[i];
+        p[2] = items.z[i];
+        if (items.active[i] != 0.0f) {
+            float center = BIN_COMPARTMENT_CENTER(category);
+            if (fabsf(items.y[i] - lidTop) < lidTraffic && fabsf(items.x[i] - center) < BIN_COMPARTMENT_WIDTH * 0.5f) {
+                s->passing[category]++;
+            }
+            continue;
+        }
+        int compartment = (int)((items.x[i] + halfWidth) / compartmentPitch);
+        if (compartment < 0) compartment = 0;
+        if (compartment >= BIN_COMPARTMENT_COUNT) compartment = BIN_COMPARTMENT_COUNT - 1;
+        s->resting++;
+        s->restingIn[compartment]++;
+        if (compartment != category) s->misplaced++;
+    }
+    s->stepMs = workerTiming.stepMs;
+    s->classify = *classifyStats();
+
+    workerTiming.published++;
+    snapshot->timing = workerTiming;
+    snapshot->publishedAt = std::chrono::steady_clock::now();
+    backSnapshot = publishedSnapshot.exchange(backSnapshot | SNAPSHOT_FRESH, std::memory_order_acq_rel) & ~SNAPSHOT_FRESH;
+}
+
+// Render thread: switch to the newest published snapshot if there is one
+static const SimSnapshot* currentSnapshot() {
+    if (publishedSnapshot.load(std::memory_order_relaxed) & SNAPSHOT_FRESH) {
+        frontSnapshot = publishedSnapshot.exchange(frontSnapshot, std::memory_order_acq_rel) & ~SNAPSHOT_FRESH;
+    }
+    return &snapshots[frontSnapshot];
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Worker loop: fixed steps on a wall clock schedule, catching up by at most
+// SIM_MAX_STEPS per wakeup, publishing after each wakeup
+static void workerLoop() {
+    const std::chrono::steady_clock::duration period =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(SIM_STEP));
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point next = started;
+    double busyMs = 0.0;
+    int kernel = laneBestKernel();
+    while (workerRunning.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_until(next);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int steps = 0; next <= start && steps < SIM_MAX_STEPS; steps++) {
+            advance(kernel);
+            next += period;
+        }
+        if (next <= start) {
+            workerTiming.late++;
+            next = start + period; // Fall behind rather than spiral
+        }
+        workerTiming.stepMs = millisecondsSince(start);
+        if (workerTiming.stepMs > workerTiming.stepMaxMs) workerTiming.stepMaxMs = workerTiming.stepMs;
+        publish();
+        busyMs += millisecondsSince(start);
+        workerTiming.busy = busyMs / millisecondsSince(started);
+    }
+}
+
+static void startWorker() {
+    releaseAtExit(stopWorker);
+    workerRunning = true;
+    worker = std::thread(workerLoop);
+}
+
+static void stopWorker() {
+    if (!workerRunning) return;
+    workerRunning = false;
+    worker.join();
+}
+
+void simStep(float elapsed) {
+    if (!enabled || workerRunning) return;
+    PROFILE_SCOPE("simStep");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    timeCarry += elapsed;
+    int steps = (int)(timeCarry / SIM_STEP);
+    if (steps > SIM_MAX_STEPS) {
+        steps = SIM_MAX_STEPS;
+        timeCarry = 0.0f; // Fall behind rather than spiral
+        workerTiming.late++;
+    } else {
+        timeCarry -= steps * SIM_STEP;
+    }
+    if (steps == 0) return;
+
+    int kernel = laneBestKernel();
+    for (int i = 0; i < steps; i++) advance(kernel);
+    workerTiming.stepMs = millisecondsSince(start);
+    if (workerTiming.stepMs > workerTiming.stepMaxMs) workerTiming.stepMaxMs = workerTiming.stepMs;
+    publish();
+}
+
+const SimItems* simItems() {
+    return &items;
+}
+
+size_t simCount() {
+    return currentSnapshot()->stats.items;
+}
+
+const SimStats* simStats() {
+    return &currentSnapshot()->stats;
+}
+
+void simFillLevels(float fill[BIN_COMPARTMENT_COUNT]) {
+    // Items settle loosely, so each takes more room than its sphere
+    const float itemVolume = 4.0f / 3.0f * (float)M_PI * SIM_ITEM_RADIUS * SIM_ITEM_RADIUS * SIM_ITEM_RADIUS / SIM_PACKING;
+    const float compartmentVolume = (compartmentPitch - 2.0f * wallMargin) * (BIN_DEPTH - 2.0f * SIM_ITEM_RADIUS) *
+                                    (lidTop - floorY);
+    const SimStats* s = simStats();
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        float level = s->restingIn[c] * itemVolume / compartmentVolume;
+        fill[c] = level < 1.0f ? level : 1.0f;
+    }
+}
+
+const SimThreadStats* simThreadStats() {
+    const SimSnapshot* snapshot = currentSnapshot();
+    SimThreadStats* t = &renderTiming;
+    t->threaded = workerRunning;
+    t->steps = snapshot->timing.steps;
+    t->published = snapshot->timing.published;
+    t->late = snapshot->timing.late;
+    t->stepMs = snapshot->timing.stepMs;
+    t->stepMaxMs = snapshot->timing.stepMaxMs;
+    t->busy = snapshot->timing.busy;
+    t->snapshotAgeMs = t->frames > 0 ? snapshotAgeTotalMs / t->frames : 0.0;
+    return t;
+}
+
+void simDraw(const GLfloat* const colors[BIN_COMPARTMENT_COUNT]) {
+    const SimSnapshot* snapshot = currentSnapshot();
+    if (snapshot->stats.items == 0) return;
+    PROFILE_SCOPE("simDraw");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    glPushAttrib(GL_ENABLE_BIT | GL_POINT_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_COLOR_MATERIAL); // Otherwise the point colors end up in the bin's materials
+    glPointSize(3.0f);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, &snapshot->positions[0]);
+    for (int c = 0; c < BIN_COMPARTMENT_COUNT; c++) {
+        if (snapshot->first[c + 1] == snapshot->first[c]) continue;
+        glColor3fv(colors[c]);
+        glDrawArrays(GL_POINTS, (GLint)snapshot->first[c], (GLsizei)(snapshot->first[c + 1] - snapshot->first[c]));
+    }
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glPopAttrib();
+
+    // Frames that redraw a snapshot already shown mean the simulation is not keeping up with the display
+    renderTiming.frames++;
+    if (snapshot->timing.published == lastDrawnStep) renderTiming.staleFrames++;
+    lastDrawnStep = snapshot->timing.published;
+    snapshotAgeTotalMs += std::chrono::duration<double, std::milli>(start - snapshot->publishedAt).count();
+    renderTiming.drawMs = millisecondsSince(start);
+}
+
+void printSimStats() {
+    const SimStats* s = simStats();
+    printf("Simulation: %lu items, %lu at rest (%lu / %lu / %lu by compartment), %lu misplaced, last step %.2f ms (%s)\n",
+           s->items, s->resting, s->restingIn[BIN_RECYCLABLE], s->restingIn[BIN_ORGANIC], s->restingIn[BIN_HAZARDOUS],
+           s->misplaced, s->stepMs, laneKernelName(laneBestKernel()));
+    if (s->classify.batches > 0) printClassifyStats(&s->classify);
+    const SimThreadStats* t = simThreadStats();
+    printf("  %s: %lu steps, %lu snapshots, %lu late, step %.2f ms (max %.2f)", t->threaded ? "Worker thread" : "In-frame",
+           t->steps, t->published, t->late, t->stepMs, t->stepMaxMs);
+    if (t->threaded) printf(", busy %.1f%%", t->busy * 100.0);
+    printf("\n");
+    printf("  Render thread: %lu frames, %lu stale, snapshot age %.2f ms, draw %.2f ms\n", t->frames, t->staleFrames,
+           t->snapshotAgeMs, t->drawMs);
+}
+
+void benchmarkSimulation(int n) {
+    printf("Simulation benchmark: %d items, %d steps of %.4f s\n", n, SIM_BENCHMARK_STEPS, SIM_STEP);
+    for (int kernel = LANE_KERNEL_SCALAR; kernel <= laneBestKernel(); kernel++) {
+        SimItems bench;
+        simScatter(&bench, (size_t)n, 99u);
+        simIntegrate(&bench, (size_t)n, SIM_STEP, kernel); // Warm caches
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int step = 0; step < SIM_BENCHMARK_STEPS; step++) simIntegrate(&bench, (size_t)n, SIM_STEP, kernel);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t resting = 0;
+        for (int i = 0; i < n; i++) resting += bench.active[i] == 0.0f;
+        printf("  %-6s %8.2f M items/s, %7.2f ms per step, %lu at rest\n", laneKernelName(kernel),
+               (double)n * SIM_BENCHMARK_STEPS / seconds / 1e6, seconds * 1000.0 / SIM_BENCHMARK_STEPS,
+               (unsigned long)resting);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "bin.h"
+#include "classify.h"
+#include <stddef.h>
+#include <vector>
+
+#define SIM_STEP          (1.0f / 120.0f) // Fixed integration step in seconds
+#define SIM_MAX_STEPS     4               // Steps per frame before the simulation falls behind real time
+#define SIM_GRAVITY       9.81f
+#define SIM_ITEM_RADIUS   0.08f
+#define SIM_RESTITUTION   0.35f
+#define SIM_FRICTION      0.8f  // Horizontal speed kept per floor contact
+#define SIM_REST_SPEED    0.05f // Items on the floor slower than this stop being integrated
+#define SIM_SPAWN_HEIGHT  9.0f  // Items appear between this height and 3 units above it
+#define SIM_DEFAULT_ITEMS 100000
+#define SIM_FILL_SECONDS  10.0f // Spawn rate fills the pool in this long
+#define SIM_PACKING       0.6f  // Share of a compartment resting items can fill
+
+// Waste items in structure-of-arrays form, one entry per item in each array.
+// Category and active are floats so every field loads into the same SIMD lanes.
+struct SimItems {
+    std::vector<float> x, y, z;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> category; // BinCompartment the classifier picked
+    std::vector<float> active;   // 1 while falling or bouncing, 0 at rest
+};
+
+struct SimStats {
+    unsigned long items;
+    unsigned long resting;
+    unsigned long restingIn[BIN_COMPARTMENT_COUNT];
+    unsigned long misplaced; // At rest in a compartment other than its category
+    unsigned long passing[BIN_COMPARTMENT_COUNT]; // Falling through each lid, which holds it open
+    double stepMs;           // Duration of the last batch of steps
+    ClassifyStats classify;  // Classification of arriving items, which picks their lid
+};
+
+// Timing of the stepping side (worker thread or in-frame) as of the snapshot
+// being drawn, and of the render thread drawing it
+struct SimThreadStats {
+    bool threaded;
+    unsigned long steps;     // Fixed steps taken
+    unsigned long published; // Snapshots handed to the renderer
+    unsigned long late;      // Times stepping fell more than SIM_MAX_STEPS behind and skipped ahead
+    double stepMs;           // Last batch of steps plus publishing
+    double stepMaxMs;
+    double busy;             // Fraction of its lifetime the worker spent working
+    unsigned long frames;      // Frames that drew items
+    unsigned long staleFrames; // Frames that drew a snapshot already shown
+    double snapshotAgeMs;      // Mean time from publish to draw
+    double drawMs;             // Last simDraw()
+};
+
+// Step on a worker thread while enabled (default), or in simStep() on the
+// render thread when false; set through simSetThreaded() once running
+extern bool simUseWorker;
+
+// Pool of capacity items, spawned fast enough to fill it in SIM_FILL_SECONDS;
+// once full, spawning reuses the oldest slots so the stream never stops
+void simInit(int capacity);
+void simRelease();
+void simSetEnabled(bool enabled);
+bool simEnabled();
+// Restarts stepping on the worker thread or in-frame
+void simSetThreaded(bool threaded);
+// True while the worker thread is stepping
+bool simThreaded();
+
+// Advance by elapsed seconds in fixed SIM_STEP steps and publish a snapshot;
+// does nothing while the worker thread steps instead
+void simStep(float elapsed);
+// Integrate every item by dt with the given LaneKernel
+void simIntegrate(SimItems* items, size_t count, float dt, int kernel);
+// Fill with count items scattered above the bin, half of them mid-flight
+void simScatter(SimItems* items, size_t count, unsigned seed);
+
+// Live item state; only safe to read while the worker thread is stopped
+const SimItems* simItems();
+// Render thread only: these read the newest published snapshot
+size_t simCount();
+const SimStats* simStats();
+const SimThreadStats* simThreadStats();
+// Share of each compartment's volume taken by items at rest, 0..1
+void simFillLevels(float fill[BIN_COMPARTMENT_COUNT]);
+void printSimStats();
+
+// Items of the newest snapshot as points colored by category; call with the
+// bin's modelview current
+void simDraw(const float* const colors[BIN_COMPARTMENT_COUNT]);
+
+// Items integrated per second for each available kernel on count items
+void benchmarkSimulation(int count);
+
+#endif
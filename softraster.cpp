@@ -0,0 +1,472 @@
+#include "softraster.h"
+#include "lanes.h"
+#include "workers.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct SoftDraw {
+    const Mesh* mesh;
+    float model[16];
+};
+
+struct ClipVertex {
+    float clip[4];
+    float color[3];
+};
+
+// Screen-space triangle ready to fill. Every attribute is a plane a + b x + c y over pixel
+// coordinates; colors are divided by w so they interpolate with perspective, as in GL.
+struct SoftTriangle {
+    float edge[3][3];   // Inside where edge . (x, y, 1) > edgeBias
+    float edgeBias[3];  // Slightly below 0 on top-left edges, so shared edges are filled once
+    float depth[3];
+    float invW[3];
+    float color[3][3];
+    int minX, minY, maxX, maxY; // Pixel bounds, max exclusive
+};
+
+// A contiguous range of draws, transformed and binned by one thread. Tiles
+// read the chunks in order, so triangles are filled in submission order.
+struct SoftChunk {
+    size_t firstDraw, lastDraw;
+    std::vector<SoftTriangle> triangles;
+    std::vector<std::vector<unsigned> > tiles; // Triangle indices overlapping each tile
+
+    // Per-vertex scratch for the draw being transformed
+    std::vector<float> eye;    // Position and normal, 6 floats per vertex
+    std::vector<float> clip;   // 4 per vertex
+    std::vector<float> lit;    // Color for litBatch, 3 per vertex
+    std::vector<int> litBatch; // Batch the vertex was last lit for, -1 for none
+
+    unsigned long triangleCount, culled, clipped, entries;
+};
+
+// Every thread takes chunks or tiles until none are left
+static WorkerPool pool;
+static std::atomic<size_t> nextItem(0);
+
+// The frame being drawn
+static SoftFramebuffer* frame = NULL;
+static unsigned clearPixel = 0;
+static float viewMatrix[16], projectionMatrix[16];
+static std::vector<SoftDraw> draws;
+static std::vector<SoftChunk> chunks;
+static size_t chunkCount = 0;
+static int tilesX = 0, tilesY = 0;
+static std::atomic<unsigned long> pixelsWritten(0);
+static int fillKernel = laneBestKernel();
+
+static SoftLight lights[SOFT_MAX_LIGHTS];
+static int lightCount = 0;
+static float sceneAmbient[4] = {0.2f, 0.2f, 0.2f, 1.0f}; // GL_LIGHT_MODEL_AMBIENT default
+
+static SoftStats stats;
+
+// Run work on every thread, the caller included, and wait for all of them
+static void runJob(void (*work)(int worker)) {
+    nextItem = 0;
+    workersRun(&pool, work, true);
+}
+
+void softInit(int threads) {
+    releaseAtExit(softRelease);
+    workersStart(&pool, threads);
+}
+
+void softRelease() {
+    workersStop(&pool);
+}
+
+int softThreads() {
+    return workersCount(&pool);
+}
+
+void softSetKernel(int kernel) {
+    fillKernel = kernel > laneBestKernel() ? laneBestKernel() : kernel;
+}
+
+int softKernel() {
+    return fillKernel;
+}
+
+void softSetLights(const SoftLight* source, int count, const float ambient[4]) {
+    lightCount = count < SOFT_MAX_LIGHTS ? count : SOFT_MAX_LIGHTS;
+    memcpy(lights, source, lightCount * sizeof(SoftLight));
+    memcpy(sceneAmbient, ambient, sizeof(sceneAmbient));
+}
+
+// Fixed-function lighting with a non-local viewer, as fixedFunctionLighting() in shader.cpp
+static void lightVertex(const float* eye, const MeshMaterial& material, float out[3]) {
+    const float* n = eye + 3;
+    for (int k = 0; k < 3; k++) out[k] = material.emission[k] + sceneAmbient[k] * material.ambient[k];
+    for (int i = 0; i < lightCount; i++) {
+        const SoftLight& light = lights[i];
+        float L[3];
+        for (int k = 0; k < 3; k++) L[k] = light.position[3] == 0.0f ? light.position[k] : light.position[k] - eye[k];
+        float length = sqrtf(L[0] * L[0] + L[1] * L[1] + L[2] * L[2]);
+        if (length > 0.0f) {
+            for (int k = 0; k < 3; k++) L[k] /= length;
+        }
+        float NdotL = n[0] * L[0] + n[1] * L[1] + n[2] * L[2];
+        if (NdotL < 0.0f) NdotL = 0.0f;
+        for (int k = 0; k < 3; k++) {
+            out[k] += light.ambient[k] * material.ambient[k] + NdotL * light.diffuse[k] * material.diffuse[k];
+        }
+        if (NdotL > 0.0f) {
+            float H[3] = {L[0], L[1], L[2] + 1.0f};
+            float h = sqrtf(H[0] * H[0] + H[1] * H[1] + H[2] * H[2]);
+            float NdotH = (n[0] * H[0] + n[1] * H[1] + n[2] * H[2]) / h;
+            float specular = powf(NdotH > 1e-4f ? NdotH : 1e-4f, material.shininess);
+            for (int k = 0; k < 3; k++) out[k] += specular * light.specular[k] * material.specular[k];
+        }
+    }
+    for (int k = 0; k < 3; k++) out[k] = out[k] < 0.0f ? 0.0f : (out[k] > 1.0f ? 1.0f : out[k]);
+}
+
+// Plane through three values at three screen points; area is twice the signed triangle area
+static void attributePlane(const float x[3], const float y[3], float f0, float f1, float f2, float area,
+                           float plane[3]) {
+    float dx = ((f1 - f0) * (y[2] - y[0]) - (f2 - f0) * (y[1] - y[0])) / area;
+    float dy = ((f2 - f0) * (x[1] - x[0]) - (f1 - f0) * (x[2] - x[0])) / area;
+    plane[0] = f0 - dx * x[0] - dy * y[0];
+    plane[1] = dx;
+    plane[2] = dy;
+}
+
+// Project a clipped triangle, set up its planes and add it to the tiles it touches
+static void binTriangle(SoftChunk* chunk, const ClipVertex* a, const ClipVertex* b, const ClipVertex* c) {
+    const ClipVertex* v[3] = {a, b, c};
+    float x[3], y[3], z[3], invW[3];
+    for (int i = 0; i < 3; i++) {
+        invW[i] = 1.0f / v[i]->clip[3];
+        x[i] = (v[i]->clip[0] * invW[i] * 0.5f + 0.5f) * frame->width;
+        y[i] = (v[i]->clip[1] * invW[i] * 0.5f + 0.5f) * frame->height;
+        z[i] = v[i]->clip[2] * invW[i] * 0.5f + 0.5f;
+    }
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (!(fabsf(area) > 1e-8f)) {
+        chunk->culled++;
+        return;
+    }
+    if (area < 0.0f) {
+        // Counter-clockwise from here on; both windings are drawn, as GL_CULL_FACE is off
+        std::swap(v[1], v[2]);
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        std::swap(invW[1], invW[2]);
+        area = -area;
+    }
+
+    SoftTriangle t;
+    t.minX = std::max(0, (int)floorf(std::min(x[0], std::min(x[1], x[2]))));
+    t.minY = std::max(0, (int)floorf(std::min(y[0], std::min(y[1], y[2]))));
+    t.maxX = std::min(frame->width, (int)ceilf(std::max(x[0], std::max(x[1], x[2]))));
+    t.maxY = std::min(frame->height, (int)ceilf(std::max(y[0], std::max(y[1], y[2]))));
+    if (t.minX >= t.maxX || t.minY >= t.maxY) {
+        chunk->culled++;
+        return;
+    }
+    for (int e = 0; e < 3; e++) {
+        int i = e, j = (e + 1) % 3;
+        float A = y[i] - y[j], B = x[j] - x[i];
+        t.edge[e][0] = A;
+        t.edge[e][1] = B;
+        t.edge[e][2] = x[i] * y[j] - y[i] * x[j];
+        t.edgeBias[e] = A > 0.0f || (A == 0.0f && B < 0.0f) ? -1e-6f : 0.0f;
+    }
+    attributePlane(x, y, z[0], z[1], z[2], area, t.depth);
+    attributePlane(x, y, invW[0], invW[1], invW[2], area, t.invW);
+    for (int k = 0; k < 3; k++) {
+        attributePlane(x, y, v[0]->color[k] * invW[0], v[1]->color[k] * invW[1], v[2]->color[k] * invW[2], area,
+                       t.color[k]);
+    }
+
+    unsigned index = (unsigned)chunk->triangles.size();
+    chunk->triangles.push_back(t);
+    for (int ty = t.minY / SOFT_TILE_SIZE; ty <= (t.maxY - 1) / SOFT_TILE_SIZE; ty++) {
+        for (int tx = t.minX / SOFT_TILE_SIZE; tx <= (t.maxX - 1) / SOFT_TILE_SIZE; tx++) {
+            chunk->tiles[ty * tilesX + tx].push_back(index);
+            chunk->entries++;
+        }
+    }
+}
+
+// Cut a triangle by the near plane (z = -w), which leaves zero, one or two triangles
+static void clipTriangle(SoftChunk* chunk, const ClipVertex* corners[3]) {
+    // Anything entirely beyond one side of the view volume is dropped outright
+    for (int axis = 0; axis < 3; axis++) {
+        bool allBelow = true, allAbove = true;
+        for (int i = 0; i < 3; i++) {
+            const float* p = corners[i]->clip;
+            allBelow = allBelow && p[axis] < -p[3];
+            allAbove = allAbove && p[axis] > p[3];
+        }
+        if (allBelow || allAbove) {
+            chunk->culled++;
+            return;
+        }
+    }
+    bool inside[3];
+    int insideCount = 0;
+    for (int i = 0; i < 3; i++) {
+        inside[i] = corners[i]->clip[2] >= -corners[i]->clip[3];
+        insideCount += inside[i];
+    }
+    if (insideCount == 3) {
+        binTriangle(chunk, corners[0], corners[1], corners[2]);
+        return;
+    }
+
+    ClipVertex polygon[4];
+    int count = 0;
+    for (int i = 0; i < 3; i++) {
+        const ClipVertex* a = corners[i];
+        const ClipVertex* b = corners[(i + 1) % 3];
+        if (inside[i]) polygon[count++] = *a;
+        if (inside[i] != inside[(i + 1) % 3]) {
+            float da = a->clip[2] + a->clip[3], db = b->clip[2] + b->clip[3];
+            float s = da / (da - db);
+            ClipVertex& p = polygon[count++];
+            for (int k = 0; k < 4; k++) p.clip[k] = a->clip[k] + s * (b->clip[k] - a->clip[k]);
+            for (int k = 0; k < 3; k++) p.color[k] = a->color[k] + s * (b->color[k] - a->color[k]);
+        }
+    }
+    chunk->clipped++;
+    for (int i = 1; i + 1 < count; i++) binTriangle(chunk, &polygon[0], &polygon[i], &polygon[i + 1]);
+}
+
+static void transformDraw(SoftChunk* chunk, const SoftDraw& draw) {
+    const Mesh& mesh = *draw.mesh;
+    float modelView[16];
+    multiplyMatrices(viewMatrix, draw.model, modelView);
+    const float* m = modelView;
+    const float* p = projectionMatrix;
+
+    size_t vertexCount = mesh.vertices.size();
+    chunk->eye.resize(vertexCount * 6);
+    chunk->clip.resize(vertexCount * 4);
+    chunk->lit.resize(vertexCount * 3);
+    chunk->litBatch.assign(vertexCount, -1);
+    for (size_t i = 0; i < vertexCount; i++) {
+        const MeshVertex& vertex = mesh.vertices[i];
+        const float* v = vertex.position;
+        const float* n = vertex.normal;
+        float* eye = &chunk->eye[i * 6];
+        for (int k = 0; k < 3; k++) {
+            eye[k] = m[k] * v[0] + m[4 + k] * v[1] + m[8 + k] * v[2] + m[12 + k];
+            eye[3 + k] = m[k] * n[0] + m[4 + k] * n[1] + m[8 + k] * n[2];
+        }
+        float length = sqrtf(eye[3] * eye[3] + eye[4] * eye[4] + eye[5] * eye[5]);
+        if (length > 0.0f) {
+            for (int k = 3; k < 6; k++) eye[k] /= length;
+        }
+        float* clip = &chunk->clip[i * 4];
+        for (int k = 0; k < 4; k++) clip[k] = p[k] * eye[0] + p[4 + k] * eye[1] + p[8 + k] * eye[2] + p[12 + k];
+    }
+
+    for (size_t b = 0; b < mesh.batches.size(); b++) {
+        const MeshBatch& batch = mesh.batches[b];
+        if (batch.mode != GL_TRIANGLES) continue;
+        const MeshMaterial& material = mesh.materials[batch.material];
+        for (GLuint i = 0; i + 2 < batch.indexCount; i += 3) {
+            ClipVertex corners[3];
+            const ClipVertex* pointers[3];
+            for (int c = 0; c < 3; c++) {
+                GLuint index = mesh.indices[batch.firstIndex + i + c];
+                // Vertices shared within a batch are lit once
+                if (chunk->litBatch[index] != (int)b) {
+                    lightVertex(&chunk->eye[index * 6], material, &chunk->lit[index * 3]);
+                    chunk->litBatch[index] = (int)b;
+                }
+                memcpy(corners[c].clip, &chunk->clip[index * 4], sizeof(corners[c].clip));
+                memcpy(corners[c].color, &chunk->lit[index * 3], sizeof(corners[c].color));
+                pointers[c] = &corners[c];
+            }
+            chunk->triangleCount++;
+            clipTriangle(chunk, pointers);
+        }
+    }
+}
+
+static void vertexStage(int) {
+    for (size_t c = nextItem++; c < chunkCount; c = nextItem++) {
+        SoftChunk& chunk = chunks[c];
+        chunk.triangles.clear();
+        chunk.tiles.resize(tilesX * tilesY);
+        for (size_t t = 0; t < chunk.tiles.size(); t++) chunk.tiles[t].clear();
+        chunk.triangleCount = chunk.culled = chunk.clipped = chunk.entries = 0;
+        for (size_t d = chunk.firstDraw; d < chunk.lastDraw; d++) transformDraw(&chunk, draws[d]);
+    }
+}
+
+static unsigned packColor(float r, float g, float b) {
+    return (unsigned)(r * 255.0f + 0.5f) | (unsigned)(g * 255.0f + 0.5f) << 8 | (unsigned)(b * 255.0f + 0.5f) << 16 |
+           0xff000000u;
+}
+
+// Fill the part of t inside [x0, x1) x [y0, y1), x0 a multiple of L::width; returns pixels written
+template <typename L>
+static unsigned long fillTriangle(const SoftTriangle& t, int x0, int y0, int x1, int y1) {
+    typedef typename L::V V;
+    typedef typename L::M M;
+    static const float laneOffsets[8] = {0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f}; // Pixel centers
+    const V offsets = L::load(laneOffsets);
+    const V zero = L::set(0.0f);
+    const V one = L::set(1.0f);
+    V bias[3], edgeX[3];
+    for (int e = 0; e < 3; e++) {
+        bias[e] = L::set(t.edgeBias[e]);
+        edgeX[e] = L::set(t.edge[e][0]);
+    }
+    const V depthX = L::set(t.depth[1]), invWX = L::set(t.invW[1]);
+    const V colorX[3] = {L::set(t.color[0][1]), L::set(t.color[1][1]), L::set(t.color[2][1])};
+
+    float red[8], green[8], blue[8], written[8];
+    unsigned long count = 0;
+    for (int y = y0; y < y1; y++) {
+        float py = y + 0.5f;
+        V edgeRow[3];
+        for (int e = 0; e < 3; e++) edgeRow[e] = L::set(t.edge[e][1] * py + t.edge[e][2]);
+        V depthRow = L::set(t.depth[2] * py + t.depth[0]);
+        float* depth = &frame->depth[(size_t)y * frame->stride];
+        unsigned* color = &frame->color[(size_t)y * frame->stride];
+
+        for (int x = x0; x < x1; x += L::width) {
+            V px = L::add(L::set((float)x), offsets);
+            M inside = L::both(L::both(L::less(bias[0], L::add(L::mul(edgeX[0], px), edgeRow[0])),
+                                       L::less(bias[1], L::add(L::mul(edgeX[1], px), edgeRow[1]))),
+                               L::less(bias[2], L::add(L::mul(edgeX[2], px), edgeRow[2])));
+            if (!L::any(inside)) continue;
+            V z = L::add(L::mul(depthX, px), depthRow);
+            V old = L::load(depth + x);
+            M pass = L::both(inside, L::less(z, old));
+            if (!L::any(pass)) continue;
+            L::store(depth + x, L::select(pass, z, old));
+
+            V w = L::div(one, L::add(L::mul(invWX, px), L::set(t.invW[2] * py + t.invW[0])));
+            L::store(red, L::mul(L::add(L::mul(colorX[0], px), L::set(t.color[0][2] * py + t.color[0][0])), w));
+            L::store(green, L::mul(L::add(L::mul(colorX[1], px), L::set(t.color[1][2] * py + t.color[1][0])), w));
+            L::store(blue, L::mul(L::add(L::mul(colorX[2], px), L::set(t.color[2][2] * py + t.color[2][0])), w));
+            L::store(written, L::select(pass, one, zero));
+            for (int k = 0; k < L::width; k++) {
+                if (written[k] == 0.0f) continue;
+                // Interpolation can overshoot the vertex colors slightly at the edges
+                float r = red[k] < 0.0f ? 0.0f : (red[k] > 1.0f ? 1.0f : red[k]);
+                float g = green[k] < 0.0f ? 0.0f : (green[k] > 1.0f ? 1.0f : green[k]);
+                float b = blue[k] < 0.0f ? 0.0f : (blue[k] > 1.0f ? 1.0f : blue[k]);
+                color[x + k] = packColor(r, g, b);
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+static unsigned long fillSpan(const SoftTriangle& t, int x0, int y0, int x1, int y1) {
+    switch (fillKernel) {
+#ifdef __AVX__
+        case LANE_KERNEL_AVX: return fillTriangle<AvxLanes>(t, x0 - x0 % AvxLanes::width, y0, x1, y1);
+#endif
+        case LANE_KERNEL_SSE: return fillTriangle<SseLanes>(t, x0 - x0 % SseLanes::width, y0, x1, y1);
+        default: return fillTriangle<ScalarLanes>(t, x0, y0, x1, y1);
+    }
+}
+
+static void rasterStage(int) {
+    size_t tileCount = (size_t)tilesX * tilesY;
+    unsigned long written = 0;
+    for (size_t tile = nextItem++; tile < tileCount; tile = nextItem++) {
+        int left = (int)(tile % tilesX) * SOFT_TILE_SIZE;
+        int bottom = (int)(tile / tilesX) * SOFT_TILE_SIZE;
+        for (int y = bottom; y < bottom + SOFT_TILE_SIZE; y++) {
+            size_t row = (size_t)y * frame->stride + left;
+            std::fill(frame->color.begin() + row, frame->color.begin() + row + SOFT_TILE_SIZE, clearPixel);
+            std::fill(frame->depth.begin() + row, frame->depth.begin() + row + SOFT_TILE_SIZE, 1.0f);
+        }
+        for (size_t c = 0; c < chunkCount; c++) {
+            const std::vector<unsigned>& entries = chunks[c].tiles[tile];
+            for (size_t i = 0; i < entries.size(); i++) {
+                const SoftTriangle& t = chunks[c].triangles[entries[i]];
+                written += fillSpan(t, std::max(t.minX, left), std::max(t.minY, bottom),
+                                    std::min(t.maxX, left + SOFT_TILE_SIZE), std::min(t.maxY, bottom + SOFT_TILE_SIZE));
+            }
+        }
+    }
+    pixelsWritten += written;
+}
+
+void softBegin(SoftFramebuffer* target, int width, int height, const float clearColor[4], const Camera* camera) {
+    frame = target;
+    frame->width = width;
+    frame->height = height;
+    tilesX = (width + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    tilesY = (height + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    frame->stride = tilesX * SOFT_TILE_SIZE;
+    frame->color.resize((size_t)frame->stride * tilesY * SOFT_TILE_SIZE);
+    frame->depth.resize(frame->color.size());
+    clearPixel = packColor(clearColor[0], clearColor[1], clearColor[2]);
+    cameraViewMatrix(camera, viewMatrix);
+    cameraProjectionMatrix(camera, projectionMatrix);
+    draws.clear();
+}
+
+void softDrawMesh(const Mesh* mesh, const float model[16]) {
+    SoftDraw draw;
+    draw.mesh = mesh;
+    memcpy(draw.model, model, sizeof(draw.model));
+    draws.push_back(draw);
+}
+
+void softEnd() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Split the draws into contiguous chunks, more than there are threads so fast ones can take extra
+    chunkCount = std::min(draws.size(), (size_t)softThreads() * SOFT_CHUNKS_PER_THREAD);
+    if (chunks.size() < chunkCount) chunks.resize(chunkCount);
+    for (size_t c = 0; c < chunkCount; c++) {
+        chunks[c].firstDraw = draws.size() * c / chunkCount;
+        chunks[c].lastDraw = draws.size() * (c + 1) / chunkCount;
+    }
+    runJob(vertexStage);
+    std::chrono::steady_clock::time_point binned = std::chrono::steady_clock::now();
+
+    pixelsWritten = 0;
+    runJob(rasterStage);
+
+    memset(&stats, 0, sizeof(stats));
+    stats.draws = draws.size();
+    for (size_t c = 0; c < chunkCount; c++) {
+        stats.triangles += chunks[c].triangleCount;
+        stats.trianglesCulled += chunks[c].culled;
+        stats.trianglesClipped += chunks[c].clipped;
+        stats.tileEntries += chunks[c].entries;
+    }
+    stats.pixelsWritten = pixelsWritten;
+    stats.vertexMs = std::chrono::duration<double, std::milli>(binned - start).count();
+    stats.rasterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - binned).count();
+    stats.threads = softThreads();
+    stats.kernel = fillKernel;
+    draws.clear();
+}
+
+const SoftStats* softStats() {
+    return &stats;
+}
+
+void softReadPixels(const SoftFramebuffer* target, std::vector<unsigned char>* rgb) {
+    rgb->resize((size_t)target->width * target->height * 3);
+    for (int y = 0; y < target->height; y++) {
+        const unsigned* row = &target->color[(size_t)(target->height - 1 - y) * target->stride];
+        unsigned char* out = &(*rgb)[(size_t)y * target->width * 3];
+        for (int x = 0; x < target->width; x++) {
+            out[x * 3] = (unsigned char)row[x];
+            out[x * 3 + 1] = (unsigned char)(row[x] >> 8);
+            out[x * 3 + 2] = (unsigned char)(row[x] >> 16);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef SOFTRASTER_H
+#define SOFTRASTER_H
+
+#include "camera.h"
+#include "mesh.h"
+#include <vector>
+
+// CPU rasterizer for recorded meshes, for machines without a usable GL driver.
+// Vertices are lit per vertex with the fixed-function model (Gouraud, like the
+// GL paths), clipped against the near plane and binned into screen tiles;
+// tiles are then filled in parallel with SIMD edge functions and a depth
+// buffer. GL_LINES batches are skipped. Nothing here calls OpenGL.
+#define SOFT_TILE_SIZE         64 // Pixels along a tile side, a multiple of every lane width
+#define SOFT_MAX_LIGHTS        2
+#define SOFT_CHUNKS_PER_THREAD 4  // Draw ranges per thread in the vertex stage, for balance
+
+// Eye-space light, as glLightfv would hold it after being set under an identity modelview
+struct SoftLight {
+    float ambient[4];
+    float diffuse[4];
+    float specular[4];
+    float position[4]; // w = 0 for a directional light
+};
+
+struct SoftFramebuffer {
+    int width, height;
+    int stride;                  // Pixels per row, padded to whole tiles
+    std::vector<unsigned> color; // RGBA8 in memory order, bottom row first like glReadPixels
+    std::vector<float> depth;    // Window depth, 0 near to 1 far
+};
+
+struct SoftStats {
+    unsigned long draws;
+    unsigned long triangles;        // Submitted
+    unsigned long trianglesCulled;  // Outside the view volume or degenerate
+    unsigned long trianglesClipped; // Cut by the near plane
+    unsigned long tileEntries;      // Triangle-tile pairs after binning
+    unsigned long pixelsWritten;    // Passed the depth test
+    double vertexMs, rasterMs;      // Transform, light and bin; then fill the tiles
+    int threads;
+    int kernel;                     // LaneKernel of the fill loop
+};
+
+// Starts threads - 1 helper threads (0 = one per core, counting the caller)
+void softInit(int threads);
+void softRelease();
+int softThreads();
+// Fill loop kernel (LaneKernel); defaults to the best this build supports
+void softSetKernel(int kernel);
+int softKernel();
+void softSetLights(const SoftLight* lights, int count, const float sceneAmbient[4]);
+
+// Collect draws for one frame into target, seen through camera. Meshes are
+// read in softEnd(), so they must outlive it.
+void softBegin(SoftFramebuffer* target, int width, int height, const float clearColor[4], const Camera* camera);
+void softDrawMesh(const Mesh* mesh, const float model[16]); // model: rigid, column-major
+void softEnd();
+
+const SoftStats* softStats();
+// Top-down RGB rows, as headlessReadPixels returns them
+void softReadPixels(const SoftFramebuffer* target, std::vector<unsigned char>* rgb);
+
+#endif
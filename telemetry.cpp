@@ -0,0 +1,473 @@
+#include "telemetry.h"
+#include "fleet.h"
+#include "workers.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#define TELEMETRY_BATCH 32 // Datagrams per receive or send call
+
+struct TelemetrySlot {
+    std::atomic<size_t> sequence; // position + 1 once written, position + TELEMETRY_QUEUE_SIZE once read
+    TelemetryUpdate update;
+};
+
+// The ring: producers reserve runs of positions with a compare-and-swap on tail,
+// the frame loop reads from head. Slots are freed in order, so a run fits when its last slot is free.
+static TelemetrySlot* ring = NULL;
+static std::atomic<size_t> tail(0);
+static size_t head = 0;
+
+struct TelemetryReceiver {
+    int socket;
+    std::string path; // Unix socket file to remove when stopping
+    std::thread thread;
+};
+static TelemetryReceiver receivers[TELEMETRY_RECEIVERS_MAX];
+static int receiverCount = 0;
+static std::atomic<bool> receiving(false);
+
+// Counters the receiver threads update
+static std::atomic<unsigned long> datagramCount(0), receivedCount(0), malformedCount(0), droppedCount(0);
+
+static TelemetryStats stats;
+static std::vector<unsigned char> faults; // TelemetryFault bits per bin
+
+static bool popUpdate(TelemetryUpdate* update) {
+    TelemetrySlot& slot = ring[head & (TELEMETRY_QUEUE_SIZE - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != head + 1) return false;
+    *update = slot.update;
+    slot.sequence.store(head + TELEMETRY_QUEUE_SIZE, std::memory_order_release);
+    head++;
+    return true;
+}
+
+#ifndef _WIN32
+static void pushUpdates(const TelemetryUpdate* updates, size_t count) {
+    size_t pushed = 0;
+    while (pushed < count) {
+        size_t n = count - pushed;
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t last = pos + n - 1;
+            size_t sequence = ring[last & (TELEMETRY_QUEUE_SIZE - 1)].sequence.load(std::memory_order_acquire);
+            if (sequence == last) {
+                if (tail.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) break;
+            } else if ((ptrdiff_t)(sequence - last) > 0) {
+                pos = tail.load(std::memory_order_relaxed); // Another producer took these positions
+            } else {
+                size_t now = tail.load(std::memory_order_relaxed);
+                if (now != pos) {
+                    pos = now;
+                    continue;
+                }
+                // Not read yet: try to fit a shorter run
+                n /= 2;
+                if (n == 0) {
+                    droppedCount += count - pushed;
+                    return;
+                }
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            TelemetrySlot& slot = ring[(pos + i) & (TELEMETRY_QUEUE_SIZE - 1)];
+            slot.update = updates[pushed + i];
+            slot.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        pushed += n;
+    }
+}
+
+// Check a datagram's header and length, then queue its records in one go
+static void decodeDatagram(const unsigned char* data, size_t size) {
+    TelemetryHeader header;
+    if (size < sizeof(header)) {
+        malformedCount++;
+        return;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != TELEMETRY_MAGIC || header.version != TELEMETRY_VERSION ||
+        size != sizeof(header) + header.count * sizeof(TelemetryUpdate)) {
+        malformedCount++;
+        return;
+    }
+    datagramCount++;
+    receivedCount += header.count;
+    pushUpdates((const TelemetryUpdate*)(data + sizeof(header)), header.count);
+}
+
+// Fills address from "udp:PORT" or "unix:PATH"; returns the socket family, or -1
+static int parseAddress(const char* text, sockaddr_storage* address, socklen_t* length) {
+    memset(address, 0, sizeof(*address));
+    if (strncmp(text, "udp:", 4) == 0) {
+        sockaddr_in* in = (sockaddr_in*)address;
+        in->sin_family = AF_INET;
+        in->sin_port = htons((uint16_t)atoi(text + 4));
+        in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        *length = sizeof(sockaddr_in);
+        return AF_INET;
+    }
+    if (strncmp(text, "unix:", 5) == 0 && strlen(text + 5) < sizeof(((sockaddr_un*)0)->sun_path)) {
+        sockaddr_un* un = (sockaddr_un*)address;
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, text + 5);
+        *length = sizeof(sockaddr_un);
+        return AF_UNIX;
+    }
+    printf("Bad telemetry address \"%s\", expected udp:PORT or unix:PATH\n", text);
+    return -1;
+}
+
+static void receiveLoop(int socket) {
+    // Aligned for the header and records decoded in place
+    static const size_t stride = (TELEMETRY_MAX_DATAGRAM + 15) / 16 * 16;
+    std::vector<uint32_t> storage(TELEMETRY_BATCH * stride / sizeof(uint32_t));
+    unsigned char* buffers = (unsigned char*)&storage[0];
+    while (receiving) {
+#ifdef __linux__
+        mmsghdr messages[TELEMETRY_BATCH];
+        iovec vectors[TELEMETRY_BATCH];
+        memset(messages, 0, sizeof(messages));
+        for (int i = 0; i < TELEMETRY_BATCH; i++) {
+            vectors[i].iov_base = buffers + i * stride;
+            vectors[i].iov_len = TELEMETRY_MAX_DATAGRAM;
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        int count = recvmmsg(socket, messages, TELEMETRY_BATCH, MSG_WAITFORONE, NULL);
+        for (int i = 0; i < count; i++) decodeDatagram(buffers + i * stride, messages[i].msg_len);
+#else
+        ssize_t size = recv(socket, buffers, TELEMETRY_MAX_DATAGRAM, 0);
+        if (size >= 0) decodeDatagram(buffers, (size_t)size);
+#endif
+    }
+}
+
+bool telemetryListen(const char* text) {
+    if (receiverCount == TELEMETRY_RECEIVERS_MAX) {
+        printf("At most %d telemetry sockets\n", TELEMETRY_RECEIVERS_MAX);
+        return false;
+    }
+    sockaddr_storage address;
+    socklen_t length;
+    int family = parseAddress(text, &address, &length);
+    if (family < 0) return false;
+    if (family == AF_UNIX) unlink(((sockaddr_un*)&address)->sun_path); // Left behind by an earlier run
+    int fd = socket(family, SOCK_DGRAM, 0);
+    if (fd < 0 || bind(fd, (sockaddr*)&address, length) != 0) {
+        printf("Cannot listen for telemetry on %s: %s\n", text, strerror(errno));
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    // Room for bursts while the receiver is descheduled, and a timeout so it notices telemetryStop()
+    int bufferSize = 8 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    timeval timeout = {0, 100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (!ring) {
+        ring = new TelemetrySlot[TELEMETRY_QUEUE_SIZE];
+        for (size_t i = 0; i < TELEMETRY_QUEUE_SIZE; i++) ring[i].sequence.store(i, std::memory_order_relaxed);
+        tail = 0;
+        head = 0;
+        releaseAtExit(telemetryStop);
+    }
+    TelemetryReceiver& receiver = receivers[receiverCount++];
+    receiver.socket = fd;
+    receiver.path = family == AF_UNIX ? ((sockaddr_un*)&address)->sun_path : "";
+    receiving = true;
+    receiver.thread = std::thread(receiveLoop, fd);
+    printf("Telemetry: listening on %s\n", text);
+    return true;
+}
+
+void telemetryStop() {
+    receiving = false;
+    for (int i = 0; i < receiverCount; i++) {
+        receivers[i].thread.join();
+        close(receivers[i].socket);
+        if (!receivers[i].path.empty()) unlink(receivers[i].path.c_str());
+    }
+    receiverCount = 0;
+}
+#else
+bool telemetryListen(const char* address) {
+    printf("Telemetry sockets are not available on Windows (%s)\n", address);
+    return false;
+}
+
+void telemetryStop() {}
+#endif
+
+bool telemetryActive() {
+    return receiverCount > 0;
+}
+
+static void applyUpdate(const TelemetryUpdate& update, const std::vector<BinInstance>& bins) {
+    if (update.bin >= bins.size() || (update.kind != TELEMETRY_FAULT && update.compartment >= BIN_COMPARTMENT_COUNT)) {
+        stats.unknownBins++;
+        return;
+    }
+    switch (update.kind) {
+        case TELEMETRY_FILL: {
+            GLfloat fill[BIN_COMPARTMENT_COUNT];
+            memcpy(fill, bins[update.bin].fill, sizeof(fill));
+            fill[update.compartment] = update.value / 65535.0f;
+            fleetSetFill(update.bin, fill);
+            break;
+        }
+        case TELEMETRY_LID:
+            if (update.value > 0) {
+                fleetOpenLid(update.bin, update.compartment, update.value / 1000.0f);
+            } else {
+                fleetCloseLid(update.bin, update.compartment);
+            }
+            break;
+        case TELEMETRY_FAULT:
+            stats.faultyBins += (update.value != 0) - (faults[update.bin] != 0);
+            faults[update.bin] = (unsigned char)update.value;
+            break;
+        default:
+            stats.unknownBins++;
+            return;
+    }
+    stats.applied++;
+}
+
+void telemetryDrain(unsigned maxUpdates) {
+    if (!ring) return;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::vector<BinInstance>& bins = fleetInstances();
+    if (faults.size() != bins.size()) {
+        faults.assign(bins.size(), 0);
+        stats.faultyBins = 0;
+    }
+    TelemetryUpdate update;
+    unsigned drained = 0;
+    while (drained < maxUpdates && popUpdate(&update)) {
+        applyUpdate(update, bins);
+        drained++;
+    }
+    stats.lastDrained = drained;
+    stats.queued = tail.load(std::memory_order_relaxed) - head;
+    stats.lastDrainUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    if (stats.lastDrainUs > stats.maxDrainUs) stats.maxDrainUs = stats.lastDrainUs;
+}
+
+unsigned telemetryFaults(unsigned bin) {
+    return bin < faults.size() ? faults[bin] : 0;
+}
+
+const TelemetryStats* telemetryStats() {
+    stats.datagrams = datagramCount;
+    stats.received = receivedCount;
+    stats.malformed = malformedCount;
+    stats.dropped = droppedCount;
+    return &stats;
+}
+
+void printTelemetryStats() {
+    const TelemetryStats* s = telemetryStats();
+    printf("Telemetry: %lu updates in %lu datagrams, %lu malformed datagrams, %lu dropped with the queue full\n",
+           s->received, s->datagrams, s->malformed, s->dropped);
+    printf("  Applied %lu (%lu for unknown bins), %lu bins with faults\n", s->applied, s->unknownBins, s->faultyBins);
+    printf("  Last drain: %u updates in %.1f us (max %.1f us), %lu still queued\n", s->lastDrained, s->lastDrainUs,
+           s->maxDrainUs, (unsigned long)s->queued);
+}
+
+#ifndef _WIN32
+static unsigned nextRandom(unsigned* state) {
+    // xorshift32, as in the simulation
+    unsigned v = *state;
+    v ^= v << 13;
+    v ^= v >> 17;
+    v ^= v << 5;
+    *state = v;
+    return v;
+}
+
+// Synthetic status: mostly fill readings, now and then a deposit opening a lid or a fault report
+static void generateUpdate(unsigned bins, unsigned* seed, TelemetryUpdate* update) {
+    unsigned r = nextRandom(seed);
+    update->bin = nextRandom(seed) % bins;
+    update->compartment = (uint8_t)(r % BIN_COMPARTMENT_COUNT);
+    if ((r >> 4) % 1024 == 0) {
+        update->kind = TELEMETRY_FAULT;
+        update->value = (r >> 14) % 4 == 0 ? (uint16_t)(1 << ((r >> 16) % 4)) : 0; // Mostly clearing
+    } else if ((r >> 4) % 64 == 0) {
+        update->kind = TELEMETRY_LID;
+        update->value = 500;
+    } else {
+        update->kind = TELEMETRY_FILL;
+        update->value = (uint16_t)(r >> 16);
+    }
+}
+
+struct GeneratorResult {
+    unsigned long sent, datagrams, errors;
+};
+
+// Send at rate until seconds have passed (0: until stop is set), in bursts of up to TELEMETRY_BATCH datagrams
+static void generate(int socket, int rate, float seconds, unsigned bins, const std::atomic<bool>* stop, bool verbose,
+                     GeneratorResult* result) {
+    static const size_t stride = (TELEMETRY_MAX_DATAGRAM + 15) / 16 * 16;
+    std::vector<uint32_t> storage(TELEMETRY_BATCH * stride / sizeof(uint32_t));
+    unsigned char* buffers = (unsigned char*)&storage[0];
+    unsigned seed = 2024u;
+    memset(result, 0, sizeof(*result));
+    unsigned long reported = 0, reportedDatagrams = 0;
+    int reportSecond = 1;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (;;) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if ((seconds > 0.0f && elapsed >= seconds) || (stop && *stop)) break;
+        if (verbose && elapsed >= reportSecond) {
+            printf("  %lu updates/s in %lu datagrams, %lu send errors so far\n", result->sent - reported,
+                   result->datagrams - reportedDatagrams, result->errors);
+            fflush(stdout);
+            reported = result->sent;
+            reportedDatagrams = result->datagrams;
+            reportSecond++;
+        }
+        double due = rate * elapsed - (double)result->sent;
+        if (due < (double)TELEMETRY_MAX_RECORDS) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+
+        int datagrams = (int)std::min((double)TELEMETRY_BATCH, due / TELEMETRY_MAX_RECORDS);
+        for (int i = 0; i < datagrams; i++) {
+            TelemetryHeader header = {TELEMETRY_MAGIC, TELEMETRY_VERSION, (uint16_t)TELEMETRY_MAX_RECORDS};
+            unsigned char* buffer = buffers + i * stride;
+            memcpy(buffer, &header, sizeof(header));
+            TelemetryUpdate* updates = (TelemetryUpdate*)(buffer + sizeof(header));
+            for (size_t k = 0; k < TELEMETRY_MAX_RECORDS; k++) generateUpdate(bins, &seed, &updates[k]);
+        }
+        size_t size = sizeof(TelemetryHeader) + TELEMETRY_MAX_RECORDS * sizeof(TelemetryUpdate);
+#ifdef __linux__
+        mmsghdr messages[TELEMETRY_BATCH];
+        iovec vectors[TELEMETRY_BATCH];
+        memset(messages, 0, sizeof(messages));
+        for (int i = 0; i < datagrams; i++) {
+            vectors[i].iov_base = buffers + i * stride;
+            vectors[i].iov_len = size;
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        int sent = sendmmsg(socket, messages, datagrams, 0);
+#else
+        int sent = 0;
+        while (sent < datagrams && send(socket, buffers + sent * stride, size, 0) == (ssize_t)size) sent++;
+#endif
+        if (sent < datagrams) result->errors++;
+        if (sent > 0) {
+            result->datagrams += sent;
+            result->sent += sent * TELEMETRY_MAX_RECORDS;
+        }
+    }
+}
+
+static int connectGenerator(const char* text) {
+    sockaddr_storage address;
+    socklen_t length;
+    int family = parseAddress(text, &address, &length);
+    if (family < 0) return -1;
+    int fd = socket(family, SOCK_DGRAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&address, length) != 0) {
+        printf("Cannot send telemetry to %s: %s\n", text, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    int bufferSize = 8 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+    return fd;
+}
+
+int runTelemetryGenerator(const char* address, int rate, float seconds, unsigned bins) {
+    int fd = connectGenerator(address);
+    if (fd < 0) return 1;
+    if (seconds > 0.0f) {
+        printf("Telemetry load: %d updates/s to %s for %g s, %u bins\n", rate, address, seconds, bins);
+    } else {
+        printf("Telemetry load: %d updates/s to %s, %u bins\n", rate, address, bins);
+    }
+    GeneratorResult result;
+    generate(fd, rate, seconds, bins > 0 ? bins : 1, NULL, true, &result);
+    printf("Sent %lu updates in %lu datagrams, %lu send errors\n", result.sent, result.datagrams, result.errors);
+    close(fd);
+    return 0;
+}
+
+void benchmarkTelemetry(int rate, float seconds) {
+    unsigned bins = (unsigned)fleetInstances().size();
+    char path[64];
+    snprintf(path, sizeof(path), "unix:/tmp/bins-telemetry-%d.sock", (int)getpid());
+    char port[32];
+    snprintf(port, sizeof(port), "udp:%d", TELEMETRY_DEFAULT_PORT);
+    const char* addresses[2] = {path, port};
+    printf("Telemetry benchmark: %d updates/s for %g s into %u bins, drained at 60 Hz, at most %d per frame\n", rate,
+           seconds, bins, TELEMETRY_DRAIN_MAX);
+
+    for (int a = 0; a < 2; a++) {
+        telemetryStop();
+        memset(&stats, 0, sizeof(stats));
+        datagramCount = receivedCount = malformedCount = droppedCount = 0;
+        if (!telemetryListen(addresses[a])) continue;
+        int fd = connectGenerator(addresses[a]);
+        if (fd < 0) continue;
+
+        GeneratorResult sent;
+        std::thread generator(generate, fd, rate, seconds, bins, (const std::atomic<bool>*)NULL, false, &sent);
+        std::vector<double> drainUs;
+        unsigned maxDrained = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point nextFrame = start;
+        // Frames keep draining a little after the generator stops, for datagrams still in flight
+        while (std::chrono::steady_clock::now() - start < std::chrono::duration<double>(seconds + 0.25)) {
+            nextFrame += std::chrono::microseconds(16667);
+            std::this_thread::sleep_until(nextFrame);
+            telemetryDrain(TELEMETRY_DRAIN_MAX);
+            drainUs.push_back(stats.lastDrainUs);
+            maxDrained = std::max(maxDrained, stats.lastDrained);
+        }
+        generator.join();
+        close(fd);
+        telemetryDrain(TELEMETRY_QUEUE_SIZE); // Whatever the budget left behind
+
+        std::sort(drainUs.begin(), drainUs.end());
+        const TelemetryStats* s = telemetryStats();
+        printf("  %-5s sent %.2f M/s, received %lu (%.2f%% lost in the socket), %lu dropped at the queue, "
+               "%lu applied\n",
+               addresses[a][0] == 'u' && addresses[a][1] == 'n' ? "unix" : "udp", sent.sent / seconds / 1e6,
+               s->received, sent.sent > 0 ? 100.0 * (sent.sent - s->received) / sent.sent : 0.0, s->dropped,
+               s->applied);
+        printf("        drain per frame: p50 %.1f us, p99 %.1f us, max %.1f us, up to %u updates\n",
+               drainUs[drainUs.size() / 2], drainUs[drainUs.size() * 99 / 100], drainUs.back(), maxDrained);
+    }
+    telemetryStop();
+}
+#else
+int runTelemetryGenerator(const char* address, int rate, float seconds, unsigned bins) {
+    printf("Telemetry sockets are not available on Windows (%s)\n", address);
+    return 1;
+}
+
+void benchmarkTelemetry(int rate, float seconds) {
+    printf("Telemetry sockets are not available on Windows\n");
+}
+#endif
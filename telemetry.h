@@ -0,0 +1,81 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Live bin status over a local datagram socket. A receiver thread per socket
+// decodes each datagram's records and pushes them in one reservation onto a
+// bounded lock-free multi-producer, single-consumer ring; the frame loop
+// drains at most a fixed number per frame and applies them to the fleet.
+// Not available on Windows.
+#define TELEMETRY_MAGIC         0x544e4942u // "BINT" in little-endian byte order
+#define TELEMETRY_VERSION       1
+#define TELEMETRY_MAX_DATAGRAM  8192
+#define TELEMETRY_MAX_RECORDS   ((TELEMETRY_MAX_DATAGRAM - sizeof(TelemetryHeader)) / sizeof(TelemetryUpdate))
+#define TELEMETRY_QUEUE_SIZE    (1 << 20) // Updates the ring holds; a power of two
+#define TELEMETRY_DRAIN_MAX     65536     // Updates applied per frame at most; the rest wait
+#define TELEMETRY_DEFAULT_PORT  47820
+#define TELEMETRY_DEFAULT_RATE  1000000   // Updates per second from the load generator
+#define TELEMETRY_RECEIVERS_MAX 4
+
+enum TelemetryKind {
+    TELEMETRY_FILL,  // value: fill level, 0..65535 for empty..full
+    TELEMETRY_LID,   // value: milliseconds to hold the lid open, 0 to shut it
+    TELEMETRY_FAULT  // value: TelemetryFault bits, replacing the bin's previous set
+};
+
+enum TelemetryFault {
+    TELEMETRY_FAULT_SENSOR = 1,  // Fill sensor not responding
+    TELEMETRY_FAULT_JAMMED = 2,  // Lid did not close
+    TELEMETRY_FAULT_BATTERY = 4, // Low battery
+    TELEMETRY_FAULT_TILT = 8     // Bin knocked over
+};
+
+// Wire format, host byte order (both ends are on this machine): a header, then count records
+struct TelemetryHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+};
+
+struct TelemetryUpdate {
+    uint32_t bin;
+    uint8_t kind;        // TelemetryKind
+    uint8_t compartment; // BinCompartment for fill and lid updates
+    uint16_t value;
+};
+
+struct TelemetryStats {
+    unsigned long datagrams;
+    unsigned long received;    // Records decoded from valid datagrams
+    unsigned long malformed;   // Datagrams with a bad header or length
+    unsigned long dropped;     // Records that found the queue full
+    unsigned long applied;
+    unsigned long unknownBins; // Records for bins outside the current fleet
+    unsigned long faultyBins;  // Bins with any fault bit set
+    unsigned lastDrained;      // Updates applied by the last drain
+    size_t queued;             // Waiting in the queue after the last drain
+    double lastDrainUs, maxDrainUs;
+};
+
+// "udp:PORT" on 127.0.0.1, or "unix:PATH" for a datagram socket at PATH
+bool telemetryListen(const char* address);
+void telemetryStop();
+bool telemetryActive();
+
+// Apply up to maxUpdates queued updates to the fleet, without waiting for more
+void telemetryDrain(unsigned maxUpdates);
+// TelemetryFault bits last reported for a bin
+unsigned telemetryFaults(unsigned bin);
+
+const TelemetryStats* telemetryStats();
+void printTelemetryStats();
+
+// Send rate updates per second for seconds (forever if 0) to address, spread over bins
+int runTelemetryGenerator(const char* address, int rate, float seconds, unsigned bins);
+// Generator and receiver over a local socket, drained once per 60 Hz frame for
+// seconds; the fleet must already be set
+void benchmarkTelemetry(int rate, float seconds);
+
+#endif
@@ -0,0 +1,291 @@
+#include "viewwall.h"
+#include "profiler.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define WALL_CLOSEUP_HEIGHT   14.0f // Close-up eye above and in front of its bin, short of the next row
+#define WALL_CLOSEUP_DISTANCE 7.0f
+#define WALL_LONE_HEIGHT      9.0f  // Views circling the single bin
+#define WALL_LONE_DISTANCE    20.0f
+#define WALL_MARGIN           1.2f  // Districts and the overview frame their area with this much to spare
+
+static std::vector<WallView> views;
+static int viewCount = 0;
+static int wallHeight = 0; // Window height of the last layout, to flip GLUT's y
+
+void wallSetViewCount(int count) {
+    if (count < 0) count = 0;
+    if (count > WALL_MAX_VIEWS) count = WALL_MAX_VIEWS;
+    viewCount = count;
+}
+
+int wallViewCount() {
+    return viewCount;
+}
+
+bool wallActive() {
+    return viewCount > 0;
+}
+
+static void lookAt(Camera* camera, float eyeX, float eyeY, float eyeZ, float targetX, float targetY, float targetZ) {
+    camera->eye[0] = eyeX;
+    camera->eye[1] = eyeY;
+    camera->eye[2] = eyeZ;
+    camera->target[0] = targetX;
+    camera->target[1] = targetY;
+    camera->target[2] = targetZ;
+    camera->up[0] = 0.0f;
+    camera->up[1] = 1.0f;
+    camera->up[2] = 0.0f;
+}
+
+// Eye looking down at an area of ground along direction (y, z), far enough back to fit it
+static void aimArea(Camera* camera, float minX, float maxX, float minZ, float maxZ, float upY, float backZ) {
+    float centerX = (minX + maxX) * 0.5f;
+    float centerZ = (minZ + maxZ) * 0.5f;
+    float tanHalf = tanf(camera->fovY * 0.5f * (float)M_PI / 180.0f);
+    float width = (maxX - minX) / camera->aspect;
+    float depth = maxZ - minZ;
+    float distance = 0.5f * (width > depth ? width : depth) * WALL_MARGIN / tanHalf + BIN_HEIGHT;
+    lookAt(camera, centerX, distance * upY, centerZ + distance * backZ, centerX, 0.0f, centerZ);
+}
+
+// Eye in front of a bin, turned with it (same rotation as the fleet shader)
+static void aimCloseup(Camera* camera, const float position[3], float yaw) {
+    float s = sinf(yaw * (float)M_PI / 180.0f);
+    float c = cosf(yaw * (float)M_PI / 180.0f);
+    lookAt(camera, position[0] + s * WALL_CLOSEUP_DISTANCE, position[1] + WALL_CLOSEUP_HEIGHT,
+           position[2] + c * WALL_CLOSEUP_DISTANCE, position[0], position[1] + 2.0f, position[2]);
+}
+
+void wallLayout(int windowWidth, int windowHeight, const Camera* lens, const std::vector<BinInstance>& bins) {
+    for (size_t i = viewCount; i < views.size(); i++) {
+        if (views[i].texture) glDeleteTextures(1, &views[i].texture);
+    }
+    views.resize(viewCount);
+    wallHeight = windowHeight;
+    if (viewCount == 0) return;
+
+    // Grid as square as the count allows, views filled in from the top left
+    int columns = (int)ceilf(sqrtf((float)viewCount));
+    int rows = (viewCount + columns - 1) / columns;
+    int cellWidth = windowWidth / columns;
+    int cellHeight = windowHeight / rows;
+
+    // Area the bins cover, for the overview and districts
+    float minX = -BIN_TOTAL_WIDTH, maxX = BIN_TOTAL_WIDTH, minZ = -BIN_TOTAL_WIDTH, maxZ = BIN_TOTAL_WIDTH;
+    for (size_t i = 0; i < bins.size(); i++) {
+        const float* p = bins[i].position;
+        if (i == 0 || p[0] - BIN_TOTAL_WIDTH < minX) minX = p[0] - BIN_TOTAL_WIDTH;
+        if (i == 0 || p[0] + BIN_TOTAL_WIDTH > maxX) maxX = p[0] + BIN_TOTAL_WIDTH;
+        if (i == 0 || p[2] - BIN_TOTAL_WIDTH < minZ) minZ = p[2] - BIN_TOTAL_WIDTH;
+        if (i == 0 || p[2] + BIN_TOTAL_WIDTH > maxZ) maxZ = p[2] + BIN_TOTAL_WIDTH;
+    }
+
+    // After the orbit view and the overview, half districts and half close-ups (a lone bin has no districts)
+    int remaining = viewCount > 2 ? viewCount - 2 : 0;
+    int districts = bins.size() > 1 ? (remaining + 1) / 2 : 0;
+    int closeups = remaining - districts;
+    int districtColumns = (int)ceilf(sqrtf((float)districts));
+    int districtRows = districtColumns > 0 ? (districts + districtColumns - 1) / districtColumns : 0;
+
+    for (int i = 0; i < viewCount; i++) {
+        WallView& view = views[i];
+        int column = i % columns;
+        int row = i / columns;
+        view.x = column * cellWidth + WALL_BORDER / 2;
+        view.y = windowHeight - (row + 1) * cellHeight + WALL_BORDER / 2;
+        view.width = cellWidth - WALL_BORDER > 1 ? cellWidth - WALL_BORDER : 1;
+        view.height = cellHeight - WALL_BORDER > 1 ? cellHeight - WALL_BORDER : 1;
+
+        Camera& camera = view.camera;
+        camera.fovY = lens->fovY;
+        camera.aspect = (float)view.width / (float)view.height;
+        camera.zNear = lens->zNear;
+        camera.zFar = lens->zFar;
+
+        if (i == 0) {
+            view.kind = WALL_VIEW_ORBIT;
+            snprintf(view.name, sizeof(view.name), "Orbit");
+            memcpy(camera.eye, lens->eye, sizeof(camera.eye));
+            memcpy(camera.target, lens->target, sizeof(camera.target));
+            memcpy(camera.up, lens->up, sizeof(camera.up));
+        } else if (i == 1) {
+            view.kind = WALL_VIEW_OVERVIEW;
+            snprintf(view.name, sizeof(view.name), "Overview");
+            aimArea(&camera, minX, maxX, minZ, maxZ, 0.85f, 0.53f);
+        } else if (i - 2 < districts) {
+            // The bins' area split into a grid of districts, each seen from above at 45 degrees
+            int district = i - 2;
+            float sizeX = (maxX - minX) / districtColumns;
+            float sizeZ = (maxZ - minZ) / districtRows;
+            float x = minX + sizeX * (district % districtColumns);
+            float z = minZ + sizeZ * (district / districtColumns);
+            view.kind = WALL_VIEW_DISTRICT;
+            snprintf(view.name, sizeof(view.name), "District %d", district + 1);
+            aimArea(&camera, x, x + sizeX, z, z + sizeZ, 0.71f, 0.71f);
+        } else {
+            // Close-ups spread evenly through the bin list, or around the lone bin
+            int closeup = i - 2 - districts;
+            view.kind = WALL_VIEW_CLOSEUP;
+            if (bins.empty()) {
+                // No neighbors to clear, so stand back as far as the default orbit
+                float yaw = 360.0f * closeup / closeups;
+                float radians = yaw * (float)M_PI / 180.0f;
+                snprintf(view.name, sizeof(view.name), "Bin at %.0f deg", yaw);
+                lookAt(&camera, WALL_LONE_DISTANCE * sinf(radians), WALL_LONE_HEIGHT,
+                       WALL_LONE_DISTANCE * cosf(radians), 0.0f, 2.0f, 0.0f);
+            } else {
+                size_t index = (size_t)((2 * closeup + 1) * (double)bins.size() / (2 * closeups));
+                snprintf(view.name, sizeof(view.name), "Bin %lu", (unsigned long)index);
+                aimCloseup(&camera, bins[index].position, bins[index].yaw);
+            }
+        }
+    }
+}
+
+void wallSetOrbitCamera(const Camera* camera) {
+    for (size_t i = 0; i < views.size(); i++) {
+        if (views[i].kind != WALL_VIEW_ORBIT) continue;
+        memcpy(views[i].camera.eye, camera->eye, sizeof(camera->eye));
+        memcpy(views[i].camera.target, camera->target, sizeof(camera->target));
+        memcpy(views[i].camera.up, camera->up, sizeof(camera->up));
+    }
+}
+
+// Keep the view's pixels in a texture; power-of-two sizes work without NPOT support
+static void keepImage(WallView* view) {
+    if (!view->texture) glGenTextures(1, &view->texture);
+    glBindTexture(GL_TEXTURE_2D, view->texture);
+    if (view->textureWidth < view->width || view->textureHeight < view->height) {
+        int width = 1, height = 1;
+        while (width < view->width) width *= 2;
+        while (height < view->height) height *= 2;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+        view->textureWidth = width;
+        view->textureHeight = height;
+    }
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, view->x, view->y, view->width, view->height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Cover the view's viewport with its kept image, pixel for pixel
+static void showImage(const WallView* view) {
+    float s = (float)view->width / view->textureWidth;
+    float t = (float)view->height / view->textureHeight;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, view->texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f);
+    glVertex2f(-1.0f, -1.0f);
+    glTexCoord2f(s, 0.0f);
+    glVertex2f(1.0f, -1.0f);
+    glTexCoord2f(s, t);
+    glVertex2f(1.0f, 1.0f);
+    glTexCoord2f(0.0f, t);
+    glVertex2f(-1.0f, 1.0f);
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPopAttrib();
+}
+
+void wallRender(WallDrawFunc draw, uint64_t scene) {
+    GLint window[4];
+    glGetIntegerv(GL_VIEWPORT, window);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glEnable(GL_SCISSOR_TEST);
+
+    for (size_t i = 0; i < views.size(); i++) {
+        WallView& view = views[i];
+        int rect[4] = {view.x, view.y, view.width, view.height};
+        glViewport(view.x, view.y, view.width, view.height);
+        glScissor(view.x, view.y, view.width, view.height);
+
+        if (view.drawn && view.drawnScene == scene && memcmp(view.drawnRect, rect, sizeof(rect)) == 0 &&
+            memcmp(&view.drawnCamera, &view.camera, sizeof(Camera)) == 0) {
+            PROFILE_SCOPE("wallReuse");
+            showImage(&view);
+            view.reused++;
+            continue;
+        }
+
+        PROFILE_SCOPE("wallView");
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        float projection[16];
+        cameraProjectionMatrix(&view.camera, projection);
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(projection);
+        glMatrixMode(GL_MODELVIEW);
+        memset(&view.cull, 0, sizeof(view.cull));
+        draw(&view);
+        keepImage(&view);
+
+        view.drawn = true;
+        view.drawnCamera = view.camera;
+        memcpy(view.drawnRect, rect, sizeof(rect));
+        view.drawnScene = scene;
+        view.rendered++;
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        view.lastMs = elapsed.count();
+    }
+
+    glDisable(GL_SCISSOR_TEST);
+    glViewport(window[0], window[1], window[2], window[3]);
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+}
+
+WallView* wallViewAt(int x, int y, int* viewX, int* viewY) {
+    int fromBottom = wallHeight - 1 - y;
+    for (size_t i = 0; i < views.size(); i++) {
+        WallView& view = views[i];
+        if (x < view.x || x >= view.x + view.width || fromBottom < view.y || fromBottom >= view.y + view.height) {
+            continue;
+        }
+        *viewX = x - view.x;
+        *viewY = view.y + view.height - 1 - fromBottom;
+        return &view;
+    }
+    return NULL;
+}
+
+void wallRelease() {
+    for (size_t i = 0; i < views.size(); i++) {
+        if (views[i].texture) glDeleteTextures(1, &views[i].texture);
+    }
+    views.clear();
+}
+
+void printWallStats() {
+    if (views.empty()) {
+        printf("View wall: off\n");
+        return;
+    }
+    printf("View wall: %d views\n", (int)views.size());
+    for (size_t i = 0; i < views.size(); i++) {
+        const WallView& view = views[i];
+        printf("  %-16s %4dx%-4d drawn %lu, reused %lu, last draw %.2f ms, %lu bins (%lu nodes tested)\n", view.name,
+               view.width, view.height, view.rendered, view.reused, view.lastMs, view.cull.binsDrawn,
+               view.cull.nodesTested);
+    }
+}
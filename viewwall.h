@@ -0,0 +1,67 @@
+#ifndef VIEWWALL_H
+#define VIEWWALL_H
+
+#include "fleet.h"
+#include <stdint.h>
+#include <vector>
+
+// Monitoring wall: several camera views of one scene in a grid of viewports,
+// drawn from the same meshes and instance data. Each view culls and picks
+// detail for its own camera, and a view whose camera and scene have not
+// changed since it was drawn shows its last image instead of redrawing.
+#define WALL_MAX_VIEWS     16
+#define WALL_DEFAULT_VIEWS 9
+#define WALL_BORDER        2 // Pixels of background between views
+
+enum WallViewKind {
+    WALL_VIEW_ORBIT,    // Follows the mouse-driven orbit camera
+    WALL_VIEW_OVERVIEW, // The whole scene from above
+    WALL_VIEW_DISTRICT, // One cell of a grid over the ground
+    WALL_VIEW_CLOSEUP   // One bin from the front
+};
+
+struct WallView {
+    int kind;
+    char name[32];
+    Camera camera;
+    int x, y, width, height;         // Viewport, y up from the bottom of the window
+    std::vector<signed char> detail; // Level of each bin in this view's last draw
+
+    // Image of the last draw, copied out of the back buffer
+    GLuint texture;
+    int textureWidth, textureHeight;
+    bool drawn;
+    Camera drawnCamera;
+    int drawnRect[4];
+    uint64_t drawnScene;
+
+    // Counters
+    unsigned long rendered, reused; // Frames drawn and frames shown from the last image
+    double lastMs;                  // CPU time of the last draw
+    CullStats cull;                 // Last draw, fleet scenes only
+};
+
+// Draws the scene through the view's camera into the current viewport, using
+// view->detail for level-of-detail history and filling view->cull
+typedef void (*WallDrawFunc)(WallView* view);
+
+// 0 turns the wall off
+void wallSetViewCount(int count);
+int wallViewCount();
+bool wallActive();
+
+// Split the window into views and aim them over bins; with none, the views
+// circle a lone bin at the origin. lens supplies the field of view and clip planes.
+void wallLayout(int windowWidth, int windowHeight, const Camera* lens, const std::vector<BinInstance>& bins);
+// The orbit views take this camera's position each frame
+void wallSetOrbitCamera(const Camera* camera);
+
+// Draw every view; scene identifies everything besides the camera that the image depends on
+void wallRender(WallDrawFunc draw, uint64_t scene);
+// View under window pixel (x, y), y down as GLUT reports it, with the pixel in view coordinates
+WallView* wallViewAt(int x, int y, int* viewX, int* viewY);
+
+void wallRelease();
+void printWallStats();
+
+#endif
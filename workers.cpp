@@ -0,0 +1,66 @@
+#include "workers.h"
+#include <algorithm>
+#include <stdlib.h>
+
+// seen is the generation at the time the thread was started, so a job posted
+// before the thread first takes the lock is still run
+static void helperLoop(WorkerPool* pool, int worker, unsigned long seen) {
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    for (;;) {
+        pool->wake.wait(lock, [&] { return pool->stopping || pool->generation != seen; });
+        if (pool->stopping) return;
+        seen = pool->generation;
+        void (*job)(int) = pool->job;
+        lock.unlock();
+        job(worker);
+        lock.lock();
+        if (--pool->busy == 0) pool->done.notify_one();
+    }
+}
+
+void workersStart(WorkerPool* pool, int threads) {
+    workersStop(pool);
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    pool->stopping = false;
+    for (int i = 1; i < threads; i++) {
+        pool->helpers.push_back(std::thread(helperLoop, pool, i, pool->generation));
+    }
+}
+
+void workersStop(WorkerPool* pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->stopping = true;
+    }
+    pool->wake.notify_all();
+    for (size_t i = 0; i < pool->helpers.size(); i++) pool->helpers[i].join();
+    pool->helpers.clear();
+}
+
+int workersCount(const WorkerPool* pool) {
+    return (int)pool->helpers.size() + 1;
+}
+
+void workersRun(WorkerPool* pool, void (*job)(int worker), bool shared) {
+    shared = shared && !pool->helpers.empty();
+    if (shared) {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->job = job;
+        pool->busy = (int)pool->helpers.size();
+        pool->generation++;
+    }
+    if (shared) pool->wake.notify_all();
+    job(0);
+    if (shared) {
+        std::unique_lock<std::mutex> lock(pool->mutex);
+        pool->done.wait(lock, [&] { return pool->busy == 0; });
+    }
+}
+
+void releaseAtExit(void (*release)()) {
+    static std::vector<void (*)()> registered;
+    if (std::find(registered.begin(), registered.end(), release) != registered.end()) return;
+    registered.push_back(release);
+    atexit(release);
+}
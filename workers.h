@@ -0,0 +1,40 @@
+#ifndef WORKERS_H
+#define WORKERS_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Helper threads that sleep until the caller posts a job, run it alongside the
+// caller and report back; one job at a time. Modules keep a pool each, so
+// their thread counts can differ.
+struct WorkerPool {
+    std::vector<std::thread> helpers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned long generation; // Bumped for every job the helpers share
+    int busy;                 // Helpers still running the current job
+    bool stopping;
+    void (*job)(int worker);
+
+    WorkerPool() : generation(0), busy(0), stopping(false), job(NULL) {}
+};
+
+// Starts threads - 1 helper threads (0 = one per core, counting the caller),
+// stopping any the pool had
+void workersStart(WorkerPool* pool, int threads);
+void workersStop(WorkerPool* pool);
+int workersCount(const WorkerPool* pool); // Helpers and the caller
+
+// Runs job(worker) on the caller as worker 0 and, when shared, on every
+// helper as workers 1 and up; returns once all of them have finished
+void workersRun(WorkerPool* pool, void (*job)(int worker), bool shared);
+
+// Registers release to run at exit, once however often it is called. A
+// joinable std::thread left at exit terminates the process, so every module
+// that owns threads has them joined this way.
+void releaseAtExit(void (*release)());
+
+#endif